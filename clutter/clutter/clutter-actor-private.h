@@ -142,6 +142,8 @@ struct _AnchorCoord
 struct _SizeRequest
 {
   guint  age;
+  guint  layout_pass;
+  guint  generation;
   gfloat for_size;
   gfloat min_size;
   gfloat natural_size;
@@ -287,6 +289,10 @@ void                            _clutter_actor_queue_redraw_full
 
 void                            _clutter_actor_finish_queue_redraw                      (ClutterActor       *self,
                                                                                          ClutterPaintVolume *clip);
+void                            _clutter_actor_get_stage_paint_box_cached               (ClutterActor       *self,
+                                                                                         ClutterPaintVolume *pv,
+                                                                                         ClutterStage       *stage,
+                                                                                         ClutterActorBox    *box);
 
 gboolean                        _clutter_actor_set_default_paint_volume                 (ClutterActor       *self,
                                                                                          GType               check_gtype,
@@ -313,6 +319,9 @@ void                            _clutter_actor_detach_clone
 void                            _clutter_actor_queue_redraw_on_clones                   (ClutterActor *actor);
 void                            _clutter_actor_queue_relayout_on_clones                 (ClutterActor *actor);
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
+void                            _clutter_actor_allocate_relayout_root                   (ClutterActor *self);
+void                            _clutter_actor_begin_layout_pass                        (void);
+void                            _clutter_actor_log_memory_stats                         (void);
 void                            _clutter_actor_queue_update_resource_scale_recursive    (ClutterActor *actor);
 
 gboolean                        _clutter_actor_get_real_resource_scale                  (ClutterActor *actor,
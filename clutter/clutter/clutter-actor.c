@@ -654,6 +654,7 @@
 #include "clutter-stage-private.h"
 #include "clutter-timeline.h"
 #include "clutter-transition.h"
+#include "clutter-typed-transition.h"
 #include "clutter-units.h"
 
 #include "deprecated/clutter-actor.h"
@@ -677,9 +678,117 @@ typedef enum
                               */
 } MapStateChange;
 
-/* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
-#define N_CACHED_SIZE_REQUESTS 3
+/* Size requests are cached in a few slots inside the actor, which is
+ * enough for most layout managers; grid, flow and box layouts routinely
+ * ask for more than a handful of different sizes while allocating, so
+ * once the slots are full the requests spill into a hash table keyed on
+ * the for_size. The cache is bounded across layout passes, but the
+ * requests made during the current layout pass are never evicted, so
+ * that a single allocation never needs to ask an actor the same question
+ * twice. */
+#define N_INLINE_SIZE_REQUESTS 3
+#define MAX_CACHED_SIZE_REQUESTS 16
+
+typedef struct _SizeRequestCache
+{
+  SizeRequest inline_requests[N_INLINE_SIZE_REQUESTS];
+
+  /* allocated once all the inline slots are in use */
+  GHashTable *spilled_requests;
+
+  /* LRU counter; an age of 0 means the entry is not set */
+  guint age;
+
+  /* bumped to invalidate all the entries at once; entries from an older
+   * generation are kept around to be recycled */
+  guint generation;
+
+  guint n_hits;
+  guint n_misses;
+} SizeRequestCache;
+
+/* bumped at the beginning of each stage relayout */
+static guint size_request_layout_pass = 1;
+
+/* Rarely used state lives in side structures, which are allocated on
+ * demand and attached to the actor like ClutterTransformInfo and
+ * ClutterLayoutInfo, so that leaf actors do not pay for them.
+ */
+typedef struct _ClutterClipInfo
+{
+  /* clip, in actor coordinates */
+  graphene_rect_t clip;
+} ClutterClipInfo;
+
+typedef struct _ClutterOffscreenInfo
+{
+  ClutterOffscreenRedirect offscreen_redirect;
+
+  /* This is an internal effect used to implement the
+     offscreen-redirect property */
+  ClutterEffect *flatten_effect;
+} ClutterOffscreenInfo;
+
+typedef struct _ClutterEffectsInfo
+{
+  /* used when painting, to update the paint volume */
+  ClutterEffect *current_effect;
+
+  /* This is used to store an effect which needs to be redrawn. A
+     redraw can be queued to start from a particular effect. This is
+     used by parametrised effects that can cache an image of the
+     actor. If a parameter of the effect changes then it only needs to
+     redraw the cached image, not the actual actor. The pointer is
+     only valid if is_dirty == TRUE. If the pointer is NULL then the
+     whole actor is dirty. */
+  ClutterEffect *effect_to_redraw;
+
+  /* This is used when painting effects to implement the
+     clutter_actor_continue_paint() function. It points to the node in
+     the list of effects that is next in the chain */
+  const GList *next_effect_to_paint;
+} ClutterEffectsInfo;
+
+/* Memory accounting, reported with CLUTTER_DEBUG=memory. GHashTable is
+ * opaque, so a spilled size request table is approximated by its header
+ * and its smallest bucket arrays (8 keys, values and hashes), and every
+ * spilled entry by the request and one more bucket.
+ */
+#define SIZE_REQUEST_TABLE_SIZE \
+  (12 * sizeof (gpointer) + 8 * (2 * sizeof (gpointer) + sizeof (guint)))
+#define SIZE_REQUEST_ENTRY_SIZE \
+  (sizeof (SizeRequest) + 2 * sizeof (gpointer) + sizeof (guint))
+
+typedef enum
+{
+  ACTOR_INFO_LAYOUT,
+  ACTOR_INFO_TRANSFORM,
+  ACTOR_INFO_ANIMATION,
+  ACTOR_INFO_CLIP,
+  ACTOR_INFO_OFFSCREEN,
+  ACTOR_INFO_EFFECTS,
+  ACTOR_INFO_SIZE_REQUEST_TABLE,
+  ACTOR_INFO_SPILLED_SIZE_REQUEST,
+
+  N_ACTOR_INFOS
+} ActorInfoType;
+
+static const struct {
+  const char *name;
+  gsize size;
+} actor_info_types[N_ACTOR_INFOS] = {
+  [ACTOR_INFO_LAYOUT] = { "layout info", sizeof (ClutterLayoutInfo) },
+  [ACTOR_INFO_TRANSFORM] = { "transform info", sizeof (ClutterTransformInfo) },
+  [ACTOR_INFO_ANIMATION] = { "animation info", sizeof (ClutterAnimationInfo) },
+  [ACTOR_INFO_CLIP] = { "clip info", sizeof (ClutterClipInfo) },
+  [ACTOR_INFO_OFFSCREEN] = { "offscreen info", sizeof (ClutterOffscreenInfo) },
+  [ACTOR_INFO_EFFECTS] = { "effects info", sizeof (ClutterEffectsInfo) },
+  [ACTOR_INFO_SIZE_REQUEST_TABLE] = { "size request tables", SIZE_REQUEST_TABLE_SIZE },
+  [ACTOR_INFO_SPILLED_SIZE_REQUEST] = { "spilled size requests", SIZE_REQUEST_ENTRY_SIZE },
+};
+
+static guint n_live_actors = 0;
+static guint n_actor_infos[N_ACTOR_INFOS] = { 0, };
 
 struct _ClutterActorPrivate
 {
@@ -687,12 +796,8 @@ struct _ClutterActorPrivate
   ClutterRequestMode request_mode;
 
   /* our cached size requests for different width / height */
-  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
-  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
-
-  /* An age of 0 means the entry is not set */
-  guint cached_height_age;
-  guint cached_width_age;
+  SizeRequestCache width_requests;
+  SizeRequestCache height_requests;
 
   /* the bounding box of the actor, relative to the parent's
    * allocation
@@ -700,23 +805,25 @@ struct _ClutterActorPrivate
   ClutterActorBox allocation;
   ClutterAllocationFlags allocation_flags;
 
-  /* clip, in actor coordinates */
-  graphene_rect_t clip;
-
   /* the cached transformation matrix; see apply_transform() */
   CoglMatrix transform;
 
+  /* the cached transformation from the actor's coordinate space to the
+   * stage's coordinate space; it is valid as long as stage_transform_valid
+   * is set and stage_transform_parent_stamp matches the parent's
+   * stage_transform_stamp. The stamp changes every time the matrix does,
+   * so that children can validate their own cached matrix without
+   * recomputing the ancestor chain
+   */
+  CoglMatrix stage_transform;
+  guint stage_transform_stamp;
+  guint stage_transform_parent_stamp;
+
   float resource_scale;
 
   guint8 opacity;
   gint opacity_override;
 
-  ClutterOffscreenRedirect offscreen_redirect;
-
-  /* This is an internal effect used to implement the
-     offscreen-redirect property */
-  ClutterEffect *flatten_effect;
-
   /* scene graph */
   ClutterActor *parent;
   ClutterActor *prev_sibling;
@@ -763,23 +870,6 @@ struct _ClutterActorPrivate
   ClutterScalingFilter mag_filter;
   ClutterContentRepeat content_repeat;
 
-  /* used when painting, to update the paint volume */
-  ClutterEffect *current_effect;
-
-  /* This is used to store an effect which needs to be redrawn. A
-     redraw can be queued to start from a particular effect. This is
-     used by parametrised effects that can cache an image of the
-     actor. If a parameter of the effect changes then it only needs to
-     redraw the cached image, not the actual actor. The pointer is
-     only valid if is_dirty == TRUE. If the pointer is NULL then the
-     whole actor is dirty. */
-  ClutterEffect *effect_to_redraw;
-
-  /* This is used when painting effects to implement the
-     clutter_actor_continue_paint() function. It points to the node in
-     the list of effects that is next in the chain */
-  const GList *next_effect_to_paint;
-
   ClutterPaintVolume paint_volume;
 
   /* NB: This volume isn't relative to this actor, it is in eye
@@ -787,6 +877,16 @@ struct _ClutterActorPrivate
    */
   ClutterPaintVolume last_paint_volume;
 
+  /* the projection of paint_volume into stage coordinates, used to
+   * clip redraws; it is valid as long as the stamps of the
+   * transformations it was projected with match, see
+   * _clutter_actor_get_stage_paint_box_cached()
+   */
+  ClutterActorBox stage_paint_box;
+  guint stage_paint_box_transform_stamp;
+  guint stage_paint_box_stage_stamp;
+  guint stage_paint_box_view_stamp;
+
   ClutterStageQueueRedrawEntry *queue_redraw_entry;
 
   ClutterColor bg_color;
@@ -836,12 +936,14 @@ struct _ClutterActorPrivate
   guint propagated_one_redraw       : 1;
   guint paint_volume_valid          : 1;
   guint last_paint_volume_valid     : 1;
+  guint stage_paint_box_valid       : 1;
   guint in_clone_paint              : 1;
   guint transform_valid             : 1;
+  guint stage_transform_valid       : 1;
   /* This is TRUE if anything has queued a redraw since we were last
-     painted. In this case effect_to_redraw will point to an effect
-     the redraw was queued from or it will be NULL if the redraw was
-     queued without an effect. */
+     painted. In this case the effect_to_redraw of ClutterEffectsInfo
+     will point to an effect the redraw was queued from or it will be
+     NULL if the redraw was queued without an effect. */
   guint is_dirty                    : 1;
   guint bg_color_set                : 1;
   guint content_box_valid           : 1;
@@ -853,6 +955,8 @@ struct _ClutterActorPrivate
   guint needs_paint_volume_update   : 1;
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_compute_resource_scale : 1;
+  guint stop_relayout_propagation   : 1;
+  guint queued_as_relayout_root     : 1;
 };
 
 enum
@@ -1082,6 +1186,17 @@ static void _clutter_actor_get_relative_transformation_matrix (ClutterActor *sel
 
 static ClutterPaintVolume *_clutter_actor_get_paint_volume_mutable (ClutterActor *self);
 
+static void clutter_actor_real_apply_transform (ClutterActor  *self,
+                                                ClutterMatrix *matrix);
+static void clutter_actor_allocate_internal (ClutterActor           *self,
+                                             const ClutterActorBox  *allocation,
+                                             ClutterAllocationFlags  flags);
+
+static void size_request_cache_clear (SizeRequestCache *cache);
+static void size_request_cache_reset (ClutterActor     *self,
+                                      SizeRequestCache *cache,
+                                      const char       *direction);
+
 static guint8   clutter_actor_get_paint_opacity_internal        (ClutterActor *self);
 
 static inline void clutter_actor_set_background_color_internal (ClutterActor *self,
@@ -1123,6 +1238,9 @@ static void clutter_actor_pop_in_cloned_branch (ClutterActor *self,
 static GQuark quark_actor_layout_info = 0;
 static GQuark quark_actor_transform_info = 0;
 static GQuark quark_actor_animation_info = 0;
+static GQuark quark_actor_clip_info = 0;
+static GQuark quark_actor_offscreen_info = 0;
+static GQuark quark_actor_effects_info = 0;
 
 G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          clutter_actor,
@@ -1137,6 +1255,208 @@ G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          G_IMPLEMENT_INTERFACE (ATK_TYPE_IMPLEMENTOR,
                                                 atk_implementor_iface_init));
 
+static inline void
+clutter_actor_invalidate_transform (ClutterActor *self)
+{
+  self->priv->transform_valid = FALSE;
+  self->priv->stage_transform_valid = FALSE;
+}
+
+static const ClutterClipInfo default_clip_info = {
+  GRAPHENE_RECT_INIT_ZERO,      /* clip */
+};
+
+static void
+clutter_clip_info_free (gpointer data)
+{
+  g_slice_free (ClutterClipInfo, data);
+  n_actor_infos[ACTOR_INFO_CLIP] -= 1;
+}
+
+static const ClutterClipInfo *
+clutter_actor_get_clip_info_or_defaults (ClutterActor *self)
+{
+  ClutterClipInfo *info;
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_clip_info);
+  if (info != NULL)
+    return info;
+
+  return &default_clip_info;
+}
+
+static ClutterClipInfo *
+clutter_actor_get_clip_info (ClutterActor *self)
+{
+  ClutterClipInfo *info;
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_clip_info);
+  if (info == NULL)
+    {
+      info = g_slice_new (ClutterClipInfo);
+      *info = default_clip_info;
+      n_actor_infos[ACTOR_INFO_CLIP] += 1;
+
+      g_object_set_qdata_full (G_OBJECT (self), quark_actor_clip_info,
+                               info,
+                               clutter_clip_info_free);
+    }
+
+  return info;
+}
+
+static const ClutterOffscreenInfo default_offscreen_info = {
+  0,                            /* offscreen-redirect */
+  NULL,                         /* flatten-effect */
+};
+
+static void
+clutter_offscreen_info_free (gpointer data)
+{
+  ClutterOffscreenInfo *info = data;
+
+  g_clear_object (&info->flatten_effect);
+  g_slice_free (ClutterOffscreenInfo, info);
+  n_actor_infos[ACTOR_INFO_OFFSCREEN] -= 1;
+}
+
+static const ClutterOffscreenInfo *
+clutter_actor_get_offscreen_info_or_defaults (ClutterActor *self)
+{
+  ClutterOffscreenInfo *info;
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_offscreen_info);
+  if (info != NULL)
+    return info;
+
+  return &default_offscreen_info;
+}
+
+static ClutterOffscreenInfo *
+clutter_actor_get_offscreen_info (ClutterActor *self)
+{
+  ClutterOffscreenInfo *info;
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_offscreen_info);
+  if (info == NULL)
+    {
+      info = g_slice_new (ClutterOffscreenInfo);
+      *info = default_offscreen_info;
+      n_actor_infos[ACTOR_INFO_OFFSCREEN] += 1;
+
+      g_object_set_qdata_full (G_OBJECT (self), quark_actor_offscreen_info,
+                               info,
+                               clutter_offscreen_info_free);
+    }
+
+  return info;
+}
+
+static void
+clutter_effects_info_free (gpointer data)
+{
+  g_slice_free (ClutterEffectsInfo, data);
+  n_actor_infos[ACTOR_INFO_EFFECTS] -= 1;
+}
+
+/* returns %NULL if the actor never had any effect painted or queued */
+static inline ClutterEffectsInfo *
+clutter_actor_peek_effects_info (ClutterActor *self)
+{
+  return g_object_get_qdata (G_OBJECT (self), quark_actor_effects_info);
+}
+
+static ClutterEffectsInfo *
+clutter_actor_get_effects_info (ClutterActor *self)
+{
+  ClutterEffectsInfo *info;
+
+  info = clutter_actor_peek_effects_info (self);
+  if (info == NULL)
+    {
+      info = g_slice_new0 (ClutterEffectsInfo);
+      n_actor_infos[ACTOR_INFO_EFFECTS] += 1;
+
+      g_object_set_qdata_full (G_OBJECT (self), quark_actor_effects_info,
+                               info,
+                               clutter_effects_info_free);
+    }
+
+  return info;
+}
+
+static inline ClutterEffect *
+clutter_actor_get_current_effect (ClutterActor *self)
+{
+  ClutterEffectsInfo *info = clutter_actor_peek_effects_info (self);
+
+  return info != NULL ? info->current_effect : NULL;
+}
+
+static inline void
+clutter_actor_set_effect_to_redraw (ClutterActor  *self,
+                                    ClutterEffect *effect)
+{
+  ClutterEffectsInfo *info;
+
+  if (effect != NULL)
+    info = clutter_actor_get_effects_info (self);
+  else
+    info = clutter_actor_peek_effects_info (self);
+
+  if (info != NULL)
+    info->effect_to_redraw = effect;
+}
+
+/*< private >
+ * _clutter_actor_log_memory_stats:
+ *
+ * Logs the memory used by all the actors and their side structures,
+ * if the memory debugging notes are enabled; nothing is logged if the
+ * figures did not change since the last call.
+ */
+void
+_clutter_actor_log_memory_stats (void)
+{
+#ifdef CLUTTER_ENABLE_DEBUG
+  static gsize last_total_size = 0;
+  static guint last_n_actors = 0;
+  gsize actor_size, total_size;
+  int i;
+
+  if (!CLUTTER_HAS_DEBUG (MEMORY))
+    return;
+
+  actor_size = sizeof (ClutterActor) + sizeof (ClutterActorPrivate);
+
+  total_size = n_live_actors * actor_size;
+  for (i = 0; i < N_ACTOR_INFOS; i++)
+    total_size += n_actor_infos[i] * actor_info_types[i].size;
+
+  if (total_size == last_total_size && n_live_actors == last_n_actors)
+    return;
+
+  last_total_size = total_size;
+  last_n_actors = n_live_actors;
+
+  CLUTTER_NOTE (MEMORY, "%u actors using %" G_GSIZE_FORMAT " bytes "
+                "(%" G_GSIZE_FORMAT " bytes per actor, "
+                "%" G_GSIZE_FORMAT " bytes of instance data each)",
+                n_live_actors,
+                total_size,
+                n_live_actors > 0 ? total_size / n_live_actors : 0,
+                actor_size);
+
+  for (i = 0; i < N_ACTOR_INFOS; i++)
+    {
+      CLUTTER_NOTE (MEMORY, "  %s: %u (%" G_GSIZE_FORMAT " bytes)",
+                    actor_info_types[i].name,
+                    n_actor_infos[i],
+                    n_actor_infos[i] * actor_info_types[i].size);
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
+}
+
 /*< private >
  * clutter_actor_get_debug_name:
  * @actor: a #ClutterActor
@@ -1808,6 +2128,7 @@ clutter_actor_real_show (ClutterActor *self)
       priv->needs_width_request  = FALSE;
       priv->needs_height_request = FALSE;
       priv->needs_allocation     = FALSE;
+      priv->queued_as_relayout_root = FALSE;
 
       clutter_actor_queue_relayout (self);
     }
@@ -2592,6 +2913,7 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
   priv->needs_width_request = FALSE;
   priv->needs_height_request = FALSE;
   priv->needs_allocation = FALSE;
+  priv->queued_as_relayout_root = FALSE;
 
   if (x1_changed ||
       y1_changed ||
@@ -2601,7 +2923,7 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
       CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
                     _clutter_actor_get_debug_name (self));
 
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2800,8 +3122,12 @@ clutter_actor_real_queue_redraw (ClutterActor       *self,
      become dirty and any queued effect is no longer valid */
   if (self != origin)
     {
+      ClutterEffectsInfo *effects_info = clutter_actor_peek_effects_info (self);
+
       self->priv->is_dirty = TRUE;
-      self->priv->effect_to_redraw = NULL;
+
+      if (effects_info != NULL)
+        effects_info->effect_to_redraw = NULL;
     }
 
   /* If the actor isn't visible, we still had to emit the signal
@@ -2844,6 +3170,62 @@ clutter_actor_needs_relayout (ClutterActor *self)
           priv->needs_allocation);
 }
 
+/*
+ * clutter_actor_is_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Checks whether @self can act as the root of the layout of its sub-tree:
+ * an actor with a fixed preferred size, and with an expand state that does
+ * not depend on its children, is not affected by changes in the layout of
+ * its children, so its parent does not need to be allocated again when one
+ * of them queues a relayout.
+ *
+ * Constraints can override both the preferred size and the allocation of
+ * the actor, so actors with enabled constraints are never boundaries.
+ */
+static inline gboolean
+clutter_actor_is_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || priv->parent == NULL)
+    return FALSE;
+
+  if (!priv->min_width_set || !priv->natural_width_set ||
+      !priv->min_height_set || !priv->natural_height_set)
+    return FALSE;
+
+  if (priv->needs_compute_expand)
+    return FALSE;
+
+  if (priv->constraints != NULL)
+    {
+      const GList *l;
+
+      for (l = _clutter_meta_group_peek_metas (priv->constraints);
+           l != NULL;
+           l = l->next)
+        {
+          if (clutter_actor_meta_get_enabled (l->data))
+            return FALSE;
+        }
+    }
+
+  return _clutter_actor_get_stage_internal (self) != NULL;
+}
+
+static void
+clutter_actor_queue_relayout_from_child (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  priv->stop_relayout_propagation = clutter_actor_is_relayout_boundary (self);
+
+  _clutter_actor_queue_only_relayout (self);
+
+  priv->stop_relayout_propagation = FALSE;
+}
+
 static void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
@@ -2859,14 +3241,73 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   priv->needs_paint_volume_update = TRUE;
 
   /* reset the cached size requests */
-  memset (priv->width_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
-  memset (priv->height_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+  size_request_cache_reset (self, &priv->width_requests, "width");
+  size_request_cache_reset (self, &priv->height_requests, "height");
+
+  /* A relayout boundary only needs its own sub-tree to be allocated
+   * again when the relayout comes from one of its children
+   */
+  if (priv->stop_relayout_propagation)
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      priv->stop_relayout_propagation = FALSE;
+      priv->queued_as_relayout_root = TRUE;
+
+      CLUTTER_NOTE (LAYOUT, "Relayout stopped at boundary '%s'",
+                    _clutter_actor_get_debug_name (self));
+
+      clutter_stage_queue_actor_relayout (CLUTTER_STAGE (stage), self);
+      return;
+    }
+
+  priv->queued_as_relayout_root = FALSE;
 
   /* We need to go all the way up the hierarchy */
   if (priv->parent != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent);
+    clutter_actor_queue_relayout_from_child (priv->parent);
+}
+
+/*
+ * _clutter_actor_allocate_relayout_root:
+ * @self: a #ClutterActor queued as a relayout boundary
+ *
+ * Allocates the sub-tree of @self again, using its current allocation,
+ * without allocating its ancestors.
+ */
+void
+_clutter_actor_allocate_relayout_root (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *iter;
+
+  /* the actor may have been allocated by its parent in the meantime */
+  if (!priv->needs_allocation)
+    return;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  /* hidden sub-trees are not allocated by their parents either */
+  for (iter = self; iter != NULL; iter = iter->priv->parent)
+    {
+      if (!clutter_actor_is_visible (iter))
+        return;
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Allocating sub-tree of relayout boundary '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  if (CLUTTER_ACTOR_IS_MAPPED (self))
+    priv->needs_paint_volume_update = TRUE;
+
+  /* keep the flags the parent allocated the actor with; the origin did
+   * not change since then
+   */
+  clutter_actor_allocate_internal (self,
+                                   &priv->allocation,
+                                   priv->allocation_flags &
+                                   ~CLUTTER_ABSOLUTE_ORIGIN_CHANGED);
 }
 
 /**
@@ -3010,8 +3451,6 @@ clutter_actor_apply_transform_to_point (ClutterActor             *self,
  * instead.
  *
  */
-/* XXX: We should consider caching the stage relative modelview along with
- * the actor itself */
 static void
 _clutter_actor_get_relative_transformation_matrix (ClutterActor *self,
                                                    ClutterActor *ancestor,
@@ -3340,6 +3779,75 @@ _clutter_actor_apply_modelview_transform (ClutterActor  *self,
   CLUTTER_ACTOR_GET_CLASS (self)->apply_transform (self, matrix);
 }
 
+static guint
+next_stage_transform_stamp (void)
+{
+  static guint stage_transform_stamp = 0;
+
+  /* 0 is never a valid stamp */
+  if (G_UNLIKELY (++stage_transform_stamp == 0))
+    stage_transform_stamp = 1;
+
+  return stage_transform_stamp;
+}
+
+/*
+ * clutter_actor_ensure_stage_transform:
+ * @self: a #ClutterActor inside a #ClutterStage
+ *
+ * Ensures that the cached transformation from the coordinate space of
+ * @self to the coordinate space of its stage is up to date.
+ *
+ * Each ancestor is validated by comparing stamps, so the matrix products
+ * are only computed for the actors that changed since the last call, or
+ * whose parent (or parent's transformation) changed.
+ */
+static void
+clutter_actor_ensure_stage_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *parent = priv->parent;
+  CoglMatrix transform;
+  guint parent_stamp;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || parent == NULL)
+    {
+      if (!priv->stage_transform_valid)
+        {
+          cogl_matrix_init_identity (&priv->stage_transform);
+          priv->stage_transform_stamp = next_stage_transform_stamp ();
+          priv->stage_transform_parent_stamp = 0;
+          priv->stage_transform_valid = TRUE;
+        }
+
+      return;
+    }
+
+  clutter_actor_ensure_stage_transform (parent);
+  parent_stamp = parent->priv->stage_transform_stamp;
+
+  /* we cannot track the state used by overridden apply_transform()
+   * implementations, so we always recompute those
+   */
+  if (priv->stage_transform_valid &&
+      priv->stage_transform_parent_stamp == parent_stamp &&
+      CLUTTER_ACTOR_GET_CLASS (self)->apply_transform == clutter_actor_real_apply_transform)
+    return;
+
+  transform = parent->priv->stage_transform;
+  _clutter_actor_apply_modelview_transform (self, &transform);
+
+  if (!priv->stage_transform_valid ||
+      !cogl_matrix_equal (&transform, &priv->stage_transform))
+    {
+      priv->stage_transform = transform;
+      priv->stage_transform_stamp = next_stage_transform_stamp ();
+    }
+
+  priv->stage_transform_parent_stamp = parent_stamp;
+  priv->stage_transform_valid = TRUE;
+}
+
 /*
  * clutter_actor_apply_relative_transformation_matrix:
  * @self: The actor whose coordinate space you want to transform from.
@@ -3373,6 +3881,7 @@ _clutter_actor_apply_relative_transformation_matrix (ClutterActor *self,
                                                      CoglMatrix *matrix)
 {
   ClutterActor *parent;
+  ClutterActor *stage;
 
   /* Note we terminate before ever calling stage->apply_transform()
    * since that would conceptually be relative to the underlying
@@ -3381,6 +3890,21 @@ _clutter_actor_apply_relative_transformation_matrix (ClutterActor *self,
   if (self == ancestor)
     return;
 
+  /* transformations to the stage, or to eye coordinates through the
+   * stage, are served from the cached stage-relative matrix
+   */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL && (ancestor == NULL || ancestor == stage))
+    {
+      clutter_actor_ensure_stage_transform (self);
+
+      if (ancestor == NULL)
+        _clutter_actor_apply_modelview_transform (stage, matrix);
+
+      cogl_matrix_multiply (matrix, matrix, &self->priv->stage_transform);
+      return;
+    }
+
   parent = clutter_actor_get_parent (self);
 
   if (parent != NULL)
@@ -3709,15 +4233,17 @@ _clutter_actor_remove_effect_internal (ClutterActor  *self,
 static gboolean
 needs_flatten_effect (ClutterActor *self)
 {
-  ClutterActorPrivate *priv = self->priv;
+  const ClutterOffscreenInfo *info;
 
   if (G_UNLIKELY (clutter_paint_debug_flags &
                   CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT))
     return FALSE;
 
-  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS)
+  info = clutter_actor_get_offscreen_info_or_defaults (self);
+
+  if (info->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS)
     return TRUE;
-  else if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY)
+  else if (info->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY)
     {
       if (clutter_actor_get_paint_opacity (self) < 255 &&
           clutter_actor_has_overlaps (self))
@@ -3730,41 +4256,45 @@ needs_flatten_effect (ClutterActor *self)
 static void
 add_or_remove_flatten_effect (ClutterActor *self)
 {
-  ClutterActorPrivate *priv = self->priv;
+  ClutterOffscreenInfo *info;
 
   /* Add or remove the flatten effect depending on the
      offscreen-redirect property. */
   if (needs_flatten_effect (self))
     {
-      if (priv->flatten_effect == NULL)
+      info = clutter_actor_get_offscreen_info (self);
+
+      if (info->flatten_effect == NULL)
         {
           ClutterActorMeta *actor_meta;
           gint priority;
 
-          priv->flatten_effect = _clutter_flatten_effect_new ();
+          info->flatten_effect = _clutter_flatten_effect_new ();
           /* Keep a reference to the effect so that we can queue
              redraws from it */
-          g_object_ref_sink (priv->flatten_effect);
+          g_object_ref_sink (info->flatten_effect);
 
           /* Set the priority of the effect to high so that it will
              always be applied to the actor first. It uses an internal
              priority so that it won't be visible to applications */
-          actor_meta = CLUTTER_ACTOR_META (priv->flatten_effect);
+          actor_meta = CLUTTER_ACTOR_META (info->flatten_effect);
           priority = CLUTTER_ACTOR_META_PRIORITY_INTERNAL_HIGH;
           _clutter_actor_meta_set_priority (actor_meta, priority);
 
           /* This will add the effect without queueing a redraw */
-          _clutter_actor_add_effect_internal (self, priv->flatten_effect);
+          _clutter_actor_add_effect_internal (self, info->flatten_effect);
         }
     }
   else
     {
-      if (priv->flatten_effect != NULL)
+      if (clutter_actor_get_offscreen_info_or_defaults (self)->flatten_effect != NULL)
         {
+          info = clutter_actor_get_offscreen_info (self);
+
           /* Destroy the effect so that it will lose its fbo cache of
              the actor */
-          _clutter_actor_remove_effect_internal (self, priv->flatten_effect);
-          g_clear_object (&priv->flatten_effect);
+          _clutter_actor_remove_effect_internal (self, info->flatten_effect);
+          g_clear_object (&info->flatten_effect);
         }
     }
 }
@@ -3935,10 +4465,13 @@ clutter_actor_paint (ClutterActor        *self,
 
   if (priv->has_clip)
     {
-      clip.x1 = priv->clip.origin.x;
-      clip.y1 = priv->clip.origin.y;
-      clip.x2 = priv->clip.origin.x + priv->clip.size.width;
-      clip.y2 = priv->clip.origin.y + priv->clip.size.height;
+      const graphene_rect_t *clip_rect =
+        &clutter_actor_get_clip_info_or_defaults (self)->clip;
+
+      clip.x1 = clip_rect->origin.x;
+      clip.y1 = clip_rect->origin.y;
+      clip.x2 = clip_rect->origin.x + clip_rect->size.width;
+      clip.y2 = clip_rect->origin.y + clip_rect->size.height;
       clip_set = TRUE;
     }
   else if (priv->clip_to_allocation)
@@ -4070,11 +4603,20 @@ clutter_actor_paint (ClutterActor        *self,
         return;
     }
 
-  if (priv->effects == NULL)
-    priv->next_effect_to_paint = NULL;
+  if (priv->effects != NULL)
+    {
+      ClutterEffectsInfo *effects_info = clutter_actor_get_effects_info (self);
+
+      effects_info->next_effect_to_paint =
+        _clutter_meta_group_peek_metas (priv->effects);
+    }
   else
-    priv->next_effect_to_paint =
-      _clutter_meta_group_peek_metas (priv->effects);
+    {
+      ClutterEffectsInfo *effects_info = clutter_actor_peek_effects_info (self);
+
+      if (effects_info != NULL)
+        effects_info->next_effect_to_paint = NULL;
+    }
 
   if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES))
     _clutter_actor_draw_paint_volume (self, actor_node);
@@ -4103,6 +4645,7 @@ clutter_actor_continue_paint (ClutterActor        *self,
                               ClutterPaintContext *paint_context)
 {
   ClutterActorPrivate *priv;
+  ClutterEffectsInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   /* This should only be called from with in the ‘run’ implementation
@@ -4110,15 +4653,17 @@ clutter_actor_continue_paint (ClutterActor        *self,
   g_return_if_fail (CLUTTER_ACTOR_IN_PAINT (self));
 
   priv = self->priv;
+  info = clutter_actor_peek_effects_info (self);
 
   /* Skip any effects that are disabled */
-  while (priv->next_effect_to_paint &&
-         !clutter_actor_meta_get_enabled (priv->next_effect_to_paint->data))
-    priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+  while (info != NULL &&
+         info->next_effect_to_paint &&
+         !clutter_actor_meta_get_enabled (info->next_effect_to_paint->data))
+    info->next_effect_to_paint = info->next_effect_to_paint->next;
 
   /* If this has come from the last effect then we'll just paint the
      actual actor */
-  if (priv->next_effect_to_paint == NULL)
+  if (info == NULL || info->next_effect_to_paint == NULL)
     {
       CoglFramebuffer *framebuffer;
       ClutterPaintNode *dummy;
@@ -4152,10 +4697,10 @@ clutter_actor_continue_paint (ClutterActor        *self,
 
       /* Cache the current effect so that we can put it back before
          returning */
-      old_current_effect = priv->current_effect;
+      old_current_effect = info->current_effect;
 
-      priv->current_effect = priv->next_effect_to_paint->data;
-      priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+      info->current_effect = info->next_effect_to_paint->data;
+      info->next_effect_to_paint = info->next_effect_to_paint->next;
 
       if (priv->is_dirty)
         {
@@ -4165,14 +4710,14 @@ clutter_actor_continue_paint (ClutterActor        *self,
            * image and not call clutter_actor_continue_paint again
            * (although it should work ok if it does)
            */
-          if (priv->effect_to_redraw == NULL ||
-              priv->current_effect != priv->effect_to_redraw)
+          if (info->effect_to_redraw == NULL ||
+              info->current_effect != info->effect_to_redraw)
             run_flags |= CLUTTER_EFFECT_PAINT_ACTOR_DIRTY;
         }
 
-      _clutter_effect_paint (priv->current_effect, paint_context, run_flags);
+      _clutter_effect_paint (info->current_effect, paint_context, run_flags);
 
-      priv->current_effect = old_current_effect;
+      info->current_effect = old_current_effect;
     }
 }
 
@@ -4221,10 +4766,13 @@ clutter_actor_pick (ClutterActor       *actor,
 
   if (priv->has_clip)
     {
-      clip.x1 = priv->clip.origin.x;
-      clip.y1 = priv->clip.origin.y;
-      clip.x2 = priv->clip.origin.x + priv->clip.size.width;
-      clip.y2 = priv->clip.origin.y + priv->clip.size.height;
+      const graphene_rect_t *clip_rect =
+        &clutter_actor_get_clip_info_or_defaults (actor)->clip;
+
+      clip.x1 = clip_rect->origin.x;
+      clip.y1 = clip_rect->origin.y;
+      clip.x2 = clip_rect->origin.x + clip_rect->size.width;
+      clip.y2 = clip_rect->origin.y + clip_rect->size.height;
       clip_set = TRUE;
     }
   else if (priv->clip_to_allocation)
@@ -4239,12 +4787,20 @@ clutter_actor_pick (ClutterActor       *actor,
   if (clip_set)
     clip_set = _clutter_actor_push_pick_clip (actor, pick_context, &clip);
 
-  priv->next_effect_to_paint = NULL;
   if (priv->effects)
     {
-      priv->next_effect_to_paint =
+      ClutterEffectsInfo *effects_info = clutter_actor_get_effects_info (actor);
+
+      effects_info->next_effect_to_paint =
         _clutter_meta_group_peek_metas (priv->effects);
     }
+  else
+    {
+      ClutterEffectsInfo *effects_info = clutter_actor_peek_effects_info (actor);
+
+      if (effects_info != NULL)
+        effects_info->next_effect_to_paint = NULL;
+    }
 
   clutter_actor_continue_pick (actor, pick_context);
 
@@ -4271,23 +4827,24 @@ void
 clutter_actor_continue_pick (ClutterActor       *actor,
                              ClutterPickContext *pick_context)
 {
-  ClutterActorPrivate *priv;
+  ClutterEffectsInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (actor));
 
   g_return_if_fail (CLUTTER_ACTOR_IN_PICK (actor));
 
-  priv = actor->priv;
+  info = clutter_actor_peek_effects_info (actor);
 
   /* Skip any effects that are disabled */
-  while (priv->next_effect_to_paint &&
-         !clutter_actor_meta_get_enabled (priv->next_effect_to_paint->data))
-    priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+  while (info != NULL &&
+         info->next_effect_to_paint &&
+         !clutter_actor_meta_get_enabled (info->next_effect_to_paint->data))
+    info->next_effect_to_paint = info->next_effect_to_paint->next;
 
   /* If this has come from the last effect then we'll just pick the
    * actual actor.
    */
-  if (priv->next_effect_to_paint == NULL)
+  if (info == NULL || info->next_effect_to_paint == NULL)
     {
       /* The actor will log a silhouette of itself to the stage pick log.
        *
@@ -4306,14 +4863,14 @@ clutter_actor_continue_pick (ClutterActor       *actor,
       /* Cache the current effect so that we can put it back before
        * returning.
        */
-      old_current_effect = priv->current_effect;
+      old_current_effect = info->current_effect;
 
-      priv->current_effect = priv->next_effect_to_paint->data;
-      priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+      info->current_effect = info->next_effect_to_paint->data;
+      info->next_effect_to_paint = info->next_effect_to_paint->next;
 
-      _clutter_effect_pick (priv->current_effect, pick_context);
+      _clutter_effect_pick (info->current_effect, pick_context);
 
-      priv->current_effect = old_current_effect;
+      info->current_effect = old_current_effect;
     }
 }
 
@@ -4608,7 +5165,10 @@ static void
 clutter_transform_info_free (gpointer data)
 {
   if (data != NULL)
-    g_slice_free (ClutterTransformInfo, data);
+    {
+      g_slice_free (ClutterTransformInfo, data);
+      n_actor_infos[ACTOR_INFO_TRANSFORM] -= 1;
+    }
 }
 
 /*< private >
@@ -4639,6 +5199,7 @@ _clutter_actor_get_transform_info (ClutterActor *self)
       info = g_slice_new (ClutterTransformInfo);
 
       *info = default_transform_info;
+      n_actor_infos[ACTOR_INFO_TRANSFORM] += 1;
 
       g_object_set_qdata_full (G_OBJECT (self), quark_actor_transform_info,
                                info,
@@ -4657,7 +5218,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor           *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot = *pivot;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
@@ -4673,7 +5234,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot_z = pivot_z;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
@@ -4707,7 +5268,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -4839,7 +5400,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -4995,7 +5556,7 @@ clutter_actor_set_rotation_center_internal (ClutterActor             *self,
       break;
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_thaw_notify (obj);
 
@@ -5021,7 +5582,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -5103,7 +5664,7 @@ clutter_actor_set_scale_center (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -5125,7 +5686,7 @@ clutter_actor_set_scale_gravity (ClutterActor   *self,
   else
     clutter_anchor_coord_set_gravity (&info->scale_center, gravity);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_X]);
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_Y]);
@@ -5178,7 +5739,7 @@ clutter_actor_set_anchor_coord (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -5194,7 +5755,7 @@ clutter_actor_set_clip_rect (ClutterActor          *self,
 
   if (clip != NULL)
     {
-      priv->clip = *clip;
+      clutter_actor_get_clip_info (self)->clip = *clip;
       priv->has_clip = TRUE;
     }
   else
@@ -5704,7 +6265,8 @@ clutter_actor_get_property (GObject    *object,
       break;
 
     case PROP_OFFSCREEN_REDIRECT:
-      g_value_set_flags (value, priv->offscreen_redirect);
+      g_value_set_flags (value,
+                         clutter_actor_get_offscreen_info_or_defaults (actor)->offscreen_redirect);
       break;
 
     case PROP_NAME:
@@ -5728,7 +6290,8 @@ clutter_actor_get_property (GObject    *object,
       break;
 
     case PROP_CLIP_RECT:
-      g_value_set_boxed (value, &priv->clip);
+      g_value_set_boxed (value,
+                         &clutter_actor_get_clip_info_or_defaults (actor)->clip);
       break;
 
     case PROP_CLIP_TO_ALLOCATION:
@@ -6165,7 +6728,9 @@ clutter_actor_dispose (GObject *object)
   g_clear_object (&priv->actions);
   g_clear_object (&priv->constraints);
   g_clear_object (&priv->effects);
-  g_clear_object (&priv->flatten_effect);
+
+  if (clutter_actor_get_offscreen_info_or_defaults (self)->flatten_effect != NULL)
+    g_clear_object (&clutter_actor_get_offscreen_info (self)->flatten_effect);
 
   if (priv->child_model != NULL)
     {
@@ -6211,6 +6776,11 @@ clutter_actor_finalize (GObject *object)
 
   g_free (priv->name);
 
+  size_request_cache_clear (&priv->width_requests);
+  size_request_cache_clear (&priv->height_requests);
+
+  n_live_actors -= 1;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   g_free (priv->debug_name);
 #endif
@@ -6302,21 +6872,23 @@ clutter_actor_update_default_paint_volume (ClutterActor       *self,
     }
   else
     {
+      const graphene_rect_t *clip =
+        &clutter_actor_get_clip_info_or_defaults (self)->clip;
       ClutterActor *child;
 
       if (priv->has_clip &&
-          priv->clip.size.width >= 0 &&
-          priv->clip.size.height >= 0)
+          clip->size.width >= 0 &&
+          clip->size.height >= 0)
         {
           graphene_point3d_t origin;
 
-          origin.x = priv->clip.origin.x;
-          origin.y = priv->clip.origin.y;
+          origin.x = clip->origin.x;
+          origin.y = clip->origin.y;
           origin.z = 0;
 
           clutter_paint_volume_set_origin (volume, &origin);
-          clutter_paint_volume_set_width (volume, priv->clip.size.width);
-          clutter_paint_volume_set_height (volume, priv->clip.size.height);
+          clutter_paint_volume_set_width (volume, clip->size.width);
+          clutter_paint_volume_set_height (volume, clip->size.height);
 
           res = TRUE;
         }
@@ -6502,6 +7074,9 @@ clutter_actor_class_init (ClutterActorClass *klass)
   quark_actor_layout_info = g_quark_from_static_string ("-clutter-actor-layout-info");
   quark_actor_transform_info = g_quark_from_static_string ("-clutter-actor-transform-info");
   quark_actor_animation_info = g_quark_from_static_string ("-clutter-actor-animation-info");
+  quark_actor_clip_info = g_quark_from_static_string ("-clutter-actor-clip-info");
+  quark_actor_offscreen_info = g_quark_from_static_string ("-clutter-actor-offscreen-info");
+  quark_actor_effects_info = g_quark_from_static_string ("-clutter-actor-effects-info");
 
   object_class->constructor = clutter_actor_constructor;
   object_class->set_property = clutter_actor_set_property;
@@ -8757,6 +9332,8 @@ clutter_actor_init (ClutterActor *self)
 
   self->priv = priv = clutter_actor_get_instance_private (self);
 
+  n_live_actors += 1;
+
   priv->opacity = 0xff;
   priv->show_on_set_parent = TRUE;
   priv->resource_scale = -1.0f;
@@ -8767,9 +9344,6 @@ clutter_actor_init (ClutterActor *self)
   priv->needs_paint_volume_update = TRUE;
   priv->needs_compute_resource_scale = TRUE;
 
-  priv->cached_width_age = 1;
-  priv->cached_height_age = 1;
-
   priv->opacity_override = -1;
   priv->enable_model_view_transform = TRUE;
 
@@ -8901,7 +9475,69 @@ _clutter_actor_finish_queue_redraw (ClutterActor *self,
         }
     }
 
-  _clutter_actor_propagate_queue_redraw (self, self, pv);
+  _clutter_actor_propagate_queue_redraw (self, self, pv);
+}
+
+/*< private >
+ * _clutter_actor_get_stage_paint_box_cached:
+ * @self: (nullable): the #ClutterActor that queued the redraw
+ * @pv: the redraw clip
+ * @stage: the #ClutterStage of @self
+ * @box: (out): return location for the bounding box of @pv, in
+ *   stage coordinates
+ *
+ * Projects @pv into an axis aligned bounding box in stage coordinates,
+ * like _clutter_paint_volume_get_stage_paint_box() does.
+ *
+ * If @pv is the current paint volume of @self, the result is cached
+ * together with the stamps of the transformations it was projected with,
+ * so that actors queueing redraws without moving do not need to have
+ * their paint volumes projected every time.
+ */
+void
+_clutter_actor_get_stage_paint_box_cached (ClutterActor       *self,
+                                           ClutterPaintVolume *pv,
+                                           ClutterStage       *stage,
+                                           ClutterActorBox    *box)
+{
+  ClutterActorPrivate *priv;
+  ClutterActorPrivate *stage_priv;
+  guint view_stamp;
+
+  if (self == NULL || self == CLUTTER_ACTOR (stage))
+    {
+      _clutter_paint_volume_get_stage_paint_box (pv, stage, box);
+      return;
+    }
+
+  priv = self->priv;
+  stage_priv = CLUTTER_ACTOR (stage)->priv;
+  view_stamp = _clutter_stage_get_view_stamp (stage);
+
+  if (pv != &priv->paint_volume ||
+      !priv->paint_volume_valid ||
+      _clutter_actor_get_stage_internal (self) != CLUTTER_ACTOR (stage))
+    {
+      _clutter_paint_volume_get_stage_paint_box (pv, stage, box);
+      return;
+    }
+
+  clutter_actor_ensure_stage_transform (self);
+
+  if (!priv->stage_paint_box_valid ||
+      priv->stage_paint_box_transform_stamp != priv->stage_transform_stamp ||
+      priv->stage_paint_box_stage_stamp != stage_priv->stage_transform_stamp ||
+      priv->stage_paint_box_view_stamp != view_stamp)
+    {
+      _clutter_paint_volume_get_stage_paint_box (pv, stage,
+                                                 &priv->stage_paint_box);
+      priv->stage_paint_box_transform_stamp = priv->stage_transform_stamp;
+      priv->stage_paint_box_stage_stamp = stage_priv->stage_transform_stamp;
+      priv->stage_paint_box_view_stamp = view_stamp;
+      priv->stage_paint_box_valid = TRUE;
+    }
+
+  *box = priv->stage_paint_box;
 }
 
 static void
@@ -9093,15 +9729,17 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   /* If this is the first redraw queued then we can directly use the
      effect parameter */
   if (!priv->is_dirty)
-    priv->effect_to_redraw = effect;
+    clutter_actor_set_effect_to_redraw (self, effect);
   /* Otherwise we need to merge it with the existing effect parameter */
   else if (effect != NULL)
     {
+      ClutterEffectsInfo *effects_info = clutter_actor_peek_effects_info (self);
+
       /* If there's already an effect then we need to use whichever is
          later in the chain of actors. Otherwise a full redraw has
          already been queued on the actor so we need to ignore the
          effect parameter */
-      if (priv->effect_to_redraw != NULL)
+      if (effects_info != NULL && effects_info->effect_to_redraw != NULL)
         {
           if (priv->effects == NULL)
             g_warning ("Redraw queued with an effect that is "
@@ -9114,9 +9752,9 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
                    l != NULL;
                    l = l->next)
                 {
-                  if (l->data == priv->effect_to_redraw ||
+                  if (l->data == effects_info->effect_to_redraw ||
                       l->data == effect)
-                    priv->effect_to_redraw = l->data;
+                    effects_info->effect_to_redraw = l->data;
                 }
             }
         }
@@ -9125,7 +9763,7 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
     {
       /* If no effect is specified then we need to redraw the whole
          actor */
-      priv->effect_to_redraw = NULL;
+      clutter_actor_set_effect_to_redraw (self, NULL);
     }
 
   priv->is_dirty = TRUE;
@@ -9219,9 +9857,13 @@ _clutter_actor_queue_only_relayout (ClutterActor *self)
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
 
+  /* the parent has not been flagged if the pending relayout of this
+   * actor stopped at it as a relayout boundary
+   */
   if (priv->needs_width_request &&
       priv->needs_height_request &&
-      priv->needs_allocation)
+      priv->needs_allocation &&
+      !priv->queued_as_relayout_root)
     return; /* save some cpu cycles */
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -9598,39 +10240,237 @@ clutter_actor_adjust_height (ClutterActor *self,
 
 }
 
-/* looks for a cached size request for this for_size. If not
- * found, returns the oldest entry so it can be overwritten */
-static gboolean
-_clutter_actor_get_cached_size_request (gfloat         for_size,
-                                        SizeRequest   *cached_size_requests,
-                                        SizeRequest  **result)
+static inline gpointer
+size_request_key (gfloat for_size)
 {
-  guint i;
+  union {
+    gfloat f;
+    guint32 u;
+  } key;
+
+  /* make sure that -0 and +0 end up in the same slot */
+  key.f = for_size == 0.f ? 0.f : for_size;
+
+  return GUINT_TO_POINTER (key.u);
+}
+
+static void
+size_request_free (gpointer data)
+{
+  g_free (data);
+  n_actor_infos[ACTOR_INFO_SPILLED_SIZE_REQUEST] -= 1;
+}
+
+/* finds the entry for this for_size, stale or not; a for_size is stored
+ * at most once, either in an inline slot or in the spilled table */
+static SizeRequest *
+size_request_cache_find (SizeRequestCache *cache,
+                         gfloat            for_size)
+{
+  int i;
+
+  for (i = 0; i < N_INLINE_SIZE_REQUESTS; i++)
+    {
+      SizeRequest *sr = &cache->inline_requests[i];
+
+      if (sr->age > 0 && sr->for_size == for_size)
+        return sr;
+    }
+
+  if (cache->spilled_requests != NULL)
+    return g_hash_table_lookup (cache->spilled_requests,
+                                size_request_key (for_size));
+
+  return NULL;
+}
+
+static guint
+size_request_cache_get_n_entries (SizeRequestCache *cache)
+{
+  guint n_entries = 0;
+  int i;
+
+  for (i = 0; i < N_INLINE_SIZE_REQUESTS; i++)
+    {
+      if (cache->inline_requests[i].age > 0)
+        n_entries += 1;
+    }
+
+  if (cache->spilled_requests != NULL)
+    n_entries += g_hash_table_size (cache->spilled_requests);
+
+  return n_entries;
+}
+
+/* looks for a cached size request for this for_size, and marks it as
+ * used by the current layout pass */
+static SizeRequest *
+size_request_cache_lookup (SizeRequestCache *cache,
+                           gfloat            for_size)
+{
+  SizeRequest *sr;
+
+  sr = size_request_cache_find (cache, for_size);
+
+  if (sr == NULL || sr->generation != cache->generation)
+    {
+      CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+      cache->n_misses += 1;
+      return NULL;
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
+  cache->n_hits += 1;
+
+  sr->age = ++cache->age;
+  sr->layout_pass = size_request_layout_pass;
+
+  return sr;
+}
+
+/* picks the slot for a for_size not in the cache yet: a free or stale
+ * inline slot, else a stale spilled entry or a new one while the spilled
+ * table has room; if the cache is full, the least recently used entry not
+ * belonging to the current layout pass is recycled, otherwise the spilled
+ * table is allowed to grow */
+static SizeRequest *
+size_request_cache_pick_slot (SizeRequestCache *cache,
+                              gfloat            for_size)
+{
+  SizeRequest *sr = NULL;
+  SizeRequest *oldest = NULL;
+  gboolean oldest_is_spilled = FALSE;
+  gpointer oldest_key = NULL;
+  int i;
+
+  for (i = 0; i < N_INLINE_SIZE_REQUESTS; i++)
+    {
+      SizeRequest *candidate = &cache->inline_requests[i];
+
+      if (candidate->age == 0 || candidate->generation != cache->generation)
+        return candidate;
+
+      if (candidate->layout_pass == size_request_layout_pass)
+        continue;
 
-  *result = &cached_size_requests[0];
+      if (oldest == NULL || candidate->age < oldest->age)
+        oldest = candidate;
+    }
 
-  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+  if (cache->spilled_requests == NULL)
     {
-      SizeRequest *sr;
+      cache->spilled_requests = g_hash_table_new_full (NULL, NULL, NULL,
+                                                       size_request_free);
+      n_actor_infos[ACTOR_INFO_SIZE_REQUEST_TABLE] += 1;
+    }
 
-      sr = &cached_size_requests[i];
+  if (g_hash_table_size (cache->spilled_requests) >=
+      MAX_CACHED_SIZE_REQUESTS - N_INLINE_SIZE_REQUESTS)
+    {
+      GHashTableIter iter;
+      gpointer key, value;
 
-      if (sr->age > 0 &&
-          sr->for_size == for_size)
+      g_hash_table_iter_init (&iter, cache->spilled_requests);
+      while (g_hash_table_iter_next (&iter, &key, &value))
         {
-          CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
-          *result = sr;
-          return TRUE;
+          SizeRequest *candidate = value;
+
+          if (candidate->generation != cache->generation)
+            {
+              oldest = candidate;
+              oldest_is_spilled = TRUE;
+              oldest_key = key;
+              break;
+            }
+
+          if (candidate->layout_pass == size_request_layout_pass)
+            continue;
+
+          if (oldest == NULL || candidate->age < oldest->age)
+            {
+              oldest = candidate;
+              oldest_is_spilled = TRUE;
+              oldest_key = key;
+            }
         }
-      else if (sr->age < (*result)->age)
+
+      /* recycled inline slots stay where they are */
+      if (oldest != NULL && !oldest_is_spilled)
+        return oldest;
+
+      if (oldest != NULL)
         {
-          *result = sr;
+          g_hash_table_steal (cache->spilled_requests, oldest_key);
+          sr = oldest;
         }
     }
 
-  CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+  if (sr == NULL)
+    {
+      sr = g_new0 (SizeRequest, 1);
+      n_actor_infos[ACTOR_INFO_SPILLED_SIZE_REQUEST] += 1;
+    }
+
+  g_hash_table_insert (cache->spilled_requests, size_request_key (for_size), sr);
 
-  return FALSE;
+  return sr;
+}
+
+/* returns a slot for this for_size; a stale entry for the same for_size
+ * is reused in place */
+static SizeRequest *
+size_request_cache_insert (SizeRequestCache *cache,
+                           gfloat            for_size)
+{
+  SizeRequest *sr;
+
+  sr = size_request_cache_find (cache, for_size);
+  if (sr == NULL)
+    sr = size_request_cache_pick_slot (cache, for_size);
+
+  sr->for_size = for_size;
+  sr->age = ++cache->age;
+  sr->layout_pass = size_request_layout_pass;
+  sr->generation = cache->generation;
+
+  return sr;
+}
+
+static void
+size_request_cache_clear (SizeRequestCache *cache)
+{
+  if (cache->spilled_requests == NULL)
+    return;
+
+  g_clear_pointer (&cache->spilled_requests, g_hash_table_unref);
+  n_actor_infos[ACTOR_INFO_SIZE_REQUEST_TABLE] -= 1;
+}
+
+static void
+size_request_cache_reset (ClutterActor     *self,
+                          SizeRequestCache *cache,
+                          const char       *direction)
+{
+  /* nothing was ever cached */
+  if (cache->age == 0)
+    return;
+
+  CLUTTER_NOTE (LAYOUT, "Resetting %s request cache of '%s' "
+                "(%u entries, %u hits, %u misses)",
+                direction,
+                _clutter_actor_get_debug_name (self),
+                size_request_cache_get_n_entries (cache),
+                cache->n_hits,
+                cache->n_misses);
+
+  /* the entries are left in place, to be recycled by the next inserts */
+  cache->generation += 1;
+}
+
+void
+_clutter_actor_begin_layout_pass (void)
+{
+  size_request_layout_pass += 1;
 }
 
 static void
@@ -9705,7 +10545,6 @@ clutter_actor_get_preferred_width (ClutterActor *self,
   SizeRequest *cached_size_request;
   const ClutterLayoutInfo *info;
   ClutterActorPrivate *priv;
-  gboolean found_in_cache;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -9737,22 +10576,15 @@ clutter_actor_get_preferred_width (ClutterActor *self,
    * the *_set flags.
    */
 
-  if (!priv->needs_width_request)
-    {
-      found_in_cache =
-        _clutter_actor_get_cached_size_request (for_height,
-                                                priv->width_requests,
-                                                &cached_size_request);
-    }
-  else
-    {
-      /* if the actor needs a width request we use the first slot */
-      found_in_cache = FALSE;
-      cached_size_request = &priv->width_requests[0];
-    }
+  if (priv->needs_width_request)
+    size_request_cache_reset (self, &priv->width_requests, "width");
 
-  if (!found_in_cache)
+  cached_size_request = size_request_cache_lookup (&priv->width_requests,
+                                                   for_height);
+
+  if (cached_size_request == NULL)
     {
+      gfloat request_for_height = for_height;
       gfloat minimum_width, natural_width;
       ClutterActorClass *klass;
 
@@ -9790,12 +10622,12 @@ clutter_actor_get_preferred_width (ClutterActor *self,
       if (natural_width < minimum_width)
 	natural_width = minimum_width;
 
+      cached_size_request =
+        size_request_cache_insert (&priv->width_requests,
+                                   request_for_height);
       cached_size_request->min_size = minimum_width;
       cached_size_request->natural_size = natural_width;
-      cached_size_request->for_size = for_height;
-      cached_size_request->age = priv->cached_width_age;
 
-      priv->cached_width_age += 1;
       priv->needs_width_request = FALSE;
     }
 
@@ -9853,7 +10685,6 @@ clutter_actor_get_preferred_height (ClutterActor *self,
   SizeRequest *cached_size_request;
   const ClutterLayoutInfo *info;
   ClutterActorPrivate *priv;
-  gboolean found_in_cache;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -9885,21 +10716,15 @@ clutter_actor_get_preferred_height (ClutterActor *self,
    * the *_set flags.
    */
 
-  if (!priv->needs_height_request)
-    {
-      found_in_cache =
-        _clutter_actor_get_cached_size_request (for_width,
-                                                priv->height_requests,
-                                                &cached_size_request);
-    }
-  else
-    {
-      found_in_cache = FALSE;
-      cached_size_request = &priv->height_requests[0];
-    }
+  if (priv->needs_height_request)
+    size_request_cache_reset (self, &priv->height_requests, "height");
 
-  if (!found_in_cache)
+  cached_size_request = size_request_cache_lookup (&priv->height_requests,
+                                                   for_width);
+
+  if (cached_size_request == NULL)
     {
+      gfloat request_for_width = for_width;
       gfloat minimum_height, natural_height;
       ClutterActorClass *klass;
 
@@ -9937,12 +10762,12 @@ clutter_actor_get_preferred_height (ClutterActor *self,
       if (natural_height < minimum_height)
 	natural_height = minimum_height;
 
+      cached_size_request =
+        size_request_cache_insert (&priv->height_requests,
+                                   request_for_width);
       cached_size_request->min_size = minimum_height;
       cached_size_request->natural_size = natural_height;
-      cached_size_request->for_size = for_width;
-      cached_size_request->age = priv->cached_height_age;
 
-      priv->cached_height_age += 1;
       priv->needs_height_request = FALSE;
     }
 
@@ -11843,7 +12668,7 @@ clutter_actor_set_opacity_internal (ClutterActor *self,
       _clutter_actor_queue_redraw_full (self,
                                         0, /* flags */
                                         NULL, /* clip */
-                                        priv->flatten_effect);
+                                        clutter_actor_get_offscreen_info_or_defaults (self)->flatten_effect);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
     }
@@ -12024,29 +12849,28 @@ void
 clutter_actor_set_offscreen_redirect (ClutterActor *self,
                                       ClutterOffscreenRedirect redirect)
 {
-  ClutterActorPrivate *priv;
+  ClutterOffscreenInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  if (clutter_actor_get_offscreen_redirect (self) == redirect)
+    return;
 
-  if (priv->offscreen_redirect != redirect)
-    {
-      priv->offscreen_redirect = redirect;
+  info = clutter_actor_get_offscreen_info (self);
+  info->offscreen_redirect = redirect;
 
-      /* Queue a redraw from the effect so that it can use its cached
-         image if available instead of having to redraw the actual
-         actor. If it doesn't end up using the FBO then the effect is
-         still able to continue the paint anyway. If there is no
-         effect then this is equivalent to queuing a full redraw */
-      _clutter_actor_queue_redraw_full (self,
-                                        0, /* flags */
-                                        NULL, /* clip */
-                                        priv->flatten_effect);
+  /* Queue a redraw from the effect so that it can use its cached
+     image if available instead of having to redraw the actual
+     actor. If it doesn't end up using the FBO then the effect is
+     still able to continue the paint anyway. If there is no
+     effect then this is equivalent to queuing a full redraw */
+  _clutter_actor_queue_redraw_full (self,
+                                    0, /* flags */
+                                    NULL, /* clip */
+                                    info->flatten_effect);
 
-      g_object_notify_by_pspec (G_OBJECT (self),
-                                obj_props[PROP_OFFSCREEN_REDIRECT]);
-    }
+  g_object_notify_by_pspec (G_OBJECT (self),
+                            obj_props[PROP_OFFSCREEN_REDIRECT]);
 }
 
 /**
@@ -12065,7 +12889,7 @@ clutter_actor_get_offscreen_redirect (ClutterActor *self)
 {
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  return self->priv->offscreen_redirect;
+  return clutter_actor_get_offscreen_info_or_defaults (self)->offscreen_redirect;
 }
 
 /**
@@ -12118,7 +12942,7 @@ clutter_actor_set_depth_internal (ClutterActor *self,
       /* Sets Z value - XXX 2.0: should we invert? */
       info->z_position = depth;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       /* FIXME - remove this crap; sadly, there are still containers
        * in Clutter that depend on this utter brain damage
@@ -12143,7 +12967,7 @@ clutter_actor_set_z_position_internal (ClutterActor *self,
     {
       info->z_position = z_position;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -12549,25 +13373,29 @@ clutter_actor_set_clip (ClutterActor *self,
                         gfloat        height)
 {
   ClutterActorPrivate *priv;
+  const ClutterClipInfo *current_info;
+  ClutterClipInfo *info;
   GObject *obj;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
   priv = self->priv;
+  current_info = clutter_actor_get_clip_info_or_defaults (self);
 
   if (priv->has_clip &&
-      priv->clip.origin.x == xoff &&
-      priv->clip.origin.y == yoff &&
-      priv->clip.size.width == width &&
-      priv->clip.size.height == height)
+      current_info->clip.origin.x == xoff &&
+      current_info->clip.origin.y == yoff &&
+      current_info->clip.size.width == width &&
+      current_info->clip.size.height == height)
     return;
 
   obj = G_OBJECT (self);
+  info = clutter_actor_get_clip_info (self);
 
-  priv->clip.origin.x = xoff;
-  priv->clip.origin.y = yoff;
-  priv->clip.size.width = width;
-  priv->clip.size.height = height;
+  info->clip.origin.x = xoff;
+  info->clip.origin.y = yoff;
+  info->clip.size.width = width;
+  info->clip.size.height = height;
 
   priv->has_clip = TRUE;
 
@@ -12639,26 +13467,26 @@ clutter_actor_get_clip (ClutterActor *self,
                         gfloat       *width,
                         gfloat       *height)
 {
-  ClutterActorPrivate *priv;
+  const ClutterClipInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
-  if (!priv->has_clip)
+  if (!self->priv->has_clip)
     return;
 
+  info = clutter_actor_get_clip_info_or_defaults (self);
+
   if (xoff != NULL)
-    *xoff = priv->clip.origin.x;
+    *xoff = info->clip.origin.x;
 
   if (yoff != NULL)
-    *yoff = priv->clip.origin.y;
+    *yoff = info->clip.origin.y;
 
   if (width != NULL)
-    *width = priv->clip.size.width;
+    *width = info->clip.size.width;
 
   if (height != NULL)
-    *height = priv->clip.size.height;
+    *height = info->clip.size.height;
 }
 
 /**
@@ -13979,7 +14807,7 @@ clutter_actor_set_anchor_point (ClutterActor *self,
 
   if (changed)
     {
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
       clutter_actor_queue_redraw (self);
     }
 
@@ -14149,7 +14977,7 @@ clutter_actor_set_anchor_point_from_gravity (ClutterActor   *self,
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_X]);
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_Y]);
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -14955,6 +15783,170 @@ clutter_actor_set_animatable_property (ClutterActor *actor,
   g_object_thaw_notify (obj);
 }
 
+/*
+ * clutter_actor_has_typed_animatable_property:
+ * @pspec: the paramspec of an animatable property
+ *
+ * Checks whether @pspec can be animated through
+ * clutter_actor_set_typed_animatable_property().
+ */
+static gboolean
+clutter_actor_has_typed_animatable_property (GParamSpec *pspec)
+{
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR)
+    return FALSE;
+
+  if (!clutter_typed_transition_supports_type (G_PARAM_SPEC_VALUE_TYPE (pspec)))
+    return FALSE;
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+    case PROP_Y:
+    case PROP_POSITION:
+    case PROP_WIDTH:
+    case PROP_HEIGHT:
+    case PROP_SIZE:
+    case PROP_DEPTH:
+    case PROP_Z_POSITION:
+    case PROP_OPACITY:
+    case PROP_BACKGROUND_COLOR:
+    case PROP_PIVOT_POINT:
+    case PROP_PIVOT_POINT_Z:
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+    case PROP_TRANSFORM:
+    case PROP_CHILD_TRANSFORM:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/*
+ * clutter_actor_set_typed_animatable_property:
+ * @animatable: a #ClutterActor
+ * @pspec: the paramspec
+ * @value: the value to set
+ *
+ * Typed variant of clutter_actor_set_animatable_property(), used by
+ * the transitions created for the properties accepted by
+ * clutter_actor_has_typed_animatable_property(), so that animating
+ * them does not require boxing each frame into a #GValue.
+ */
+static void
+clutter_actor_set_typed_animatable_property (ClutterAnimatable       *animatable,
+                                             GParamSpec              *pspec,
+                                             const ClutterTypedValue *value)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (animatable);
+  GObject *obj = G_OBJECT (actor);
+
+  g_object_freeze_notify (obj);
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x_internal (actor, value->v_float);
+      break;
+
+    case PROP_Y:
+      clutter_actor_set_y_internal (actor, value->v_float);
+      break;
+
+    case PROP_POSITION:
+      clutter_actor_set_position_internal (actor, &value->v_point);
+      break;
+
+    case PROP_WIDTH:
+      clutter_actor_set_width_internal (actor, value->v_float);
+      break;
+
+    case PROP_HEIGHT:
+      clutter_actor_set_height_internal (actor, value->v_float);
+      break;
+
+    case PROP_SIZE:
+      clutter_actor_set_size_internal (actor, &value->v_size);
+      break;
+
+    case PROP_DEPTH:
+      clutter_actor_set_depth_internal (actor, value->v_float);
+      break;
+
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position_internal (actor, value->v_float);
+      break;
+
+    case PROP_OPACITY:
+      clutter_actor_set_opacity_internal (actor, value->v_uint);
+      break;
+
+    case PROP_BACKGROUND_COLOR:
+      clutter_actor_set_background_color_internal (actor, &value->v_color);
+      break;
+
+    case PROP_PIVOT_POINT:
+      clutter_actor_set_pivot_point_internal (actor, &value->v_point);
+      break;
+
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z_internal (actor, value->v_float);
+      break;
+
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_internal (actor, value->v_float, pspec);
+      break;
+
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+      clutter_actor_set_scale_factor_internal (actor, value->v_double, pspec);
+      break;
+
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      clutter_actor_set_rotation_angle_internal (actor, value->v_double, pspec);
+      break;
+
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+      clutter_actor_set_margin_internal (actor, value->v_float, pspec);
+      break;
+
+    case PROP_TRANSFORM:
+      clutter_actor_set_transform_internal (actor, &value->v_matrix);
+      break;
+
+    case PROP_CHILD_TRANSFORM:
+      clutter_actor_set_child_transform_internal (actor, &value->v_matrix);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  g_object_thaw_notify (obj);
+}
+
 static void
 clutter_actor_set_final_state (ClutterAnimatable *animatable,
                                const gchar       *property_name,
@@ -16197,7 +17189,7 @@ clutter_actor_set_transform_internal (ClutterActor        *self,
   info->transform = *transform;
   info->transform_set = !cogl_matrix_is_identity (&info->transform);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -17241,7 +18233,9 @@ _clutter_actor_get_paint_volume_real (ClutterActor *self,
    */
   if (priv->effects != NULL)
     {
-      if (priv->current_effect != NULL)
+      ClutterEffect *current_effect = clutter_actor_get_current_effect (self);
+
+      if (current_effect != NULL)
         {
           const GList *effects, *l;
 
@@ -17250,7 +18244,7 @@ _clutter_actor_get_paint_volume_real (ClutterActor *self,
            */
           effects = _clutter_meta_group_peek_metas (priv->effects);
           for (l = effects;
-               l != NULL && l->data != priv->current_effect;
+               l != NULL && l->data != current_effect;
                l = l->next)
             {
               if (!_clutter_effect_modify_paint_volume (l->data, pv))
@@ -17340,14 +18334,15 @@ _clutter_actor_get_paint_volume_mutable (ClutterActor *self)
        * from having effects to not having effects on the last
        * paint volume update. */
       if (!priv->needs_paint_volume_update &&
-          priv->current_effect == NULL &&
           !has_paint_volume_override_effects &&
-          !priv->had_effects_on_last_paint_volume_update)
+          !priv->had_effects_on_last_paint_volume_update &&
+          clutter_actor_get_current_effect (self) == NULL)
         return &priv->paint_volume;
       clutter_paint_volume_free (&priv->paint_volume);
     }
 
   priv->had_effects_on_last_paint_volume_update = has_paint_volume_override_effects;
+  priv->stage_paint_box_valid = FALSE;
 
   if (_clutter_actor_get_paint_volume_real (self, &priv->paint_volume))
     {
@@ -18082,7 +19077,10 @@ static void
 layout_info_free (gpointer data)
 {
   if (G_LIKELY (data != NULL))
-    g_slice_free (ClutterLayoutInfo, data);
+    {
+      g_slice_free (ClutterLayoutInfo, data);
+      n_actor_infos[ACTOR_INFO_LAYOUT] -= 1;
+    }
 }
 
 /*< private >
@@ -18128,6 +19126,7 @@ _clutter_actor_get_layout_info (ClutterActor *self)
       retval = g_slice_new (ClutterLayoutInfo);
 
       *retval = default_layout_info;
+      n_actor_infos[ACTOR_INFO_LAYOUT] += 1;
 
       g_object_set_qdata_full (G_OBJECT (self), quark_actor_layout_info,
                                retval,
@@ -18970,6 +19969,7 @@ clutter_animation_info_free (gpointer data)
         g_array_unref (info->states);
 
       g_slice_free (ClutterAnimationInfo, info);
+      n_actor_infos[ACTOR_INFO_ANIMATION] -= 1;
     }
 }
 
@@ -18998,6 +19998,7 @@ _clutter_actor_get_animation_info (ClutterActor *self)
       res = g_slice_new (ClutterAnimationInfo);
 
       *res = default_animation_info;
+      n_actor_infos[ACTOR_INFO_ANIMATION] += 1;
 
       g_object_set_qdata_full (obj, quark_actor_animation_info,
                                res,
@@ -19284,7 +20285,11 @@ _clutter_actor_create_transition (ClutterActor *actor,
   clos = g_hash_table_lookup (info->transitions, pspec->name);
   if (clos == NULL)
     {
-      res = clutter_property_transition_new (pspec->name);
+      if (clutter_actor_has_typed_animatable_property (pspec))
+        res = clutter_typed_transition_new (pspec,
+                                            clutter_actor_set_typed_animatable_property);
+      else
+        res = clutter_property_transition_new (pspec->name);
 
       clutter_transition_set_remove_on_complete (res, TRUE);
 
@@ -20608,7 +21613,7 @@ clutter_actor_set_child_transform_internal (ClutterActor        *self,
   /* we need to reset the transform_valid flag on each child */
   clutter_actor_iter_init (&iter, self);
   while (clutter_actor_iter_next (&iter, &child))
-    child->priv->transform_valid = FALSE;
+    clutter_actor_invalidate_transform (child);
 
   clutter_actor_queue_redraw (self);
 
@@ -36,6 +36,14 @@
  * that can be used to draw. #ClutterCanvas will emit the #ClutterCanvas::draw
  * signal when invalidated using clutter_content_invalidate().
  *
+ * If only part of the contents changed, clutter_canvas_invalidate_rect()
+ * can be used instead; the #cairo_t context will be clipped to the
+ * invalidated area, and only that area will be uploaded to the GPU.
+ *
+ * Drawing can also be moved off the main thread using
+ * clutter_canvas_set_threaded_draw(); while a worker thread draws the
+ * new contents, the previous ones keep being painted.
+ *
  * See [canvas.c](https://git.gnome.org/browse/clutter/tree/examples/canvas.c?h=clutter-1.18)
  * for an example of how to use #ClutterCanvas.
  *
@@ -66,8 +74,6 @@
 
 struct _ClutterCanvasPrivate
 {
-  cairo_t *cr;
-
   int width;
   int height;
   float scale_factor;
@@ -76,8 +82,32 @@ struct _ClutterCanvasPrivate
   gboolean dirty;
 
   CoglBitmap *buffer;
+
+  /* the area of the buffer, in device pixels, that needs to be uploaded
+   * to the texture, or NULL if the whole buffer needs to be uploaded
+   */
+  cairo_region_t *upload_region;
+
+  /* threaded drawing */
+  gboolean threaded_draw;
+  gboolean draw_in_progress;
+  cairo_surface_t *thread_surface;
+  gboolean thread_needs_draw;
+  /* the area to redraw on the next threaded draw, or NULL if the whole
+   * surface needs to be drawn
+   */
+  cairo_region_t *thread_draw_region;
 };
 
+typedef struct
+{
+  cairo_surface_t *surface;
+  cairo_region_t *region;
+  int width;
+  int height;
+  float scale_factor;
+} CanvasDrawData;
+
 enum
 {
   PROP_0,
@@ -141,6 +171,9 @@ clutter_canvas_finalize (GObject *gobject)
     }
 
   g_clear_pointer (&priv->texture, cogl_object_unref);
+  g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+  g_clear_pointer (&priv->thread_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->thread_draw_region, cairo_region_destroy);
 
   G_OBJECT_CLASS (clutter_canvas_parent_class)->finalize (gobject);
 }
@@ -337,13 +370,37 @@ clutter_canvas_paint_content (ClutterContent      *content,
   ClutterCanvasPrivate *priv = self->priv;
   ClutterPaintNode *node;
 
-  if (priv->buffer == NULL)
-    return;
-
-  if (priv->dirty)
-    g_clear_pointer (&priv->texture, cogl_object_unref);
+  if (priv->buffer != NULL && priv->dirty)
+    {
+      if (priv->texture != NULL &&
+          priv->upload_region != NULL &&
+          cogl_texture_get_width (priv->texture) == cogl_bitmap_get_width (priv->buffer) &&
+          cogl_texture_get_height (priv->texture) == cogl_bitmap_get_height (priv->buffer))
+        {
+          int i, n_rects;
+
+          n_rects = cairo_region_num_rectangles (priv->upload_region);
+          for (i = 0; i < n_rects; i++)
+            {
+              cairo_rectangle_int_t rect;
+
+              cairo_region_get_rectangle (priv->upload_region, i, &rect);
+              cogl_texture_set_region_from_bitmap (priv->texture,
+                                                   rect.x, rect.y,
+                                                   rect.x, rect.y,
+                                                   rect.width, rect.height,
+                                                   priv->buffer);
+            }
+        }
+      else
+        {
+          g_clear_pointer (&priv->texture, cogl_object_unref);
+        }
+
+      g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+    }
 
-  if (priv->texture == NULL)
+  if (priv->texture == NULL && priv->buffer != NULL)
     priv->texture = cogl_texture_new_from_bitmap (priv->buffer,
                                                   COGL_TEXTURE_NO_SLICING,
                                                   CLUTTER_CAIRO_FORMAT_ARGB32);
@@ -360,7 +417,76 @@ clutter_canvas_paint_content (ClutterContent      *content,
 }
 
 static void
-clutter_canvas_emit_draw (ClutterCanvas *self)
+clip_to_region (cairo_t              *cr,
+                const cairo_region_t *region,
+                float                 scale_factor)
+{
+  int i, n_rects;
+
+  n_rects = cairo_region_num_rectangles (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+      cairo_rectangle (cr,
+                       rect.x / scale_factor,
+                       rect.y / scale_factor,
+                       rect.width / scale_factor,
+                       rect.height / scale_factor);
+    }
+
+  cairo_clip (cr);
+
+  /* the rest of the surface retains its contents, so we need to clear
+   * the area that is going to be drawn again
+   */
+  cairo_save (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_restore (cr);
+}
+
+static void
+emit_draw_on_surface (ClutterCanvas        *self,
+                      cairo_surface_t      *surface,
+                      const cairo_region_t *region,
+                      int                   width,
+                      int                   height,
+                      float                 scale_factor)
+{
+  gboolean res;
+  cairo_t *cr;
+
+  cairo_surface_set_device_scale (surface, scale_factor, scale_factor);
+
+  cr = cairo_create (surface);
+
+  if (region != NULL)
+    clip_to_region (cr, region, scale_factor);
+
+  g_signal_emit (self, canvas_signals[DRAW], 0,
+                 cr, width, height,
+                 &res);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (_clutter_diagnostic_enabled () && cairo_status (cr))
+    {
+      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
+                 self,
+                 cairo_status_to_string (cairo_status (cr)));
+    }
+#endif
+
+  cairo_destroy (cr);
+}
+
+/* @region is the area to redraw, in device pixels, or %NULL to redraw
+ * the whole canvas; partial redraws need an existing buffer
+ */
+static void
+clutter_canvas_emit_draw (ClutterCanvas        *self,
+                          const cairo_region_t *region)
 {
   ClutterCanvasPrivate *priv = self->priv;
   int real_width, real_height;
@@ -368,12 +494,9 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
   gboolean mapped_buffer;
   unsigned char *data;
   CoglBuffer *buffer;
-  gboolean res;
-  cairo_t *cr;
 
   g_assert (priv->height > 0 && priv->width > 0);
-
-  priv->dirty = TRUE;
+  g_assert (region == NULL || priv->buffer != NULL);
 
   real_width = ceilf (priv->width * priv->scale_factor);
   real_height = ceilf (priv->height * priv->scale_factor);
@@ -398,9 +521,10 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
 
+  /* partial redraws need to preserve the rest of the buffer */
   data = cogl_buffer_map (buffer,
                           COGL_BUFFER_ACCESS_READ_WRITE,
-                          COGL_BUFFER_MAP_HINT_DISCARD);
+                          region == NULL ? COGL_BUFFER_MAP_HINT_DISCARD : 0);
 
   if (data != NULL)
     {
@@ -420,29 +544,26 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
                                             real_height);
 
       mapped_buffer = FALSE;
-    }
-
-  cairo_surface_set_device_scale (surface,
-                                  priv->scale_factor,
-                                  priv->scale_factor);
 
-  self->priv->cr = cr = cairo_create (surface);
+      /* the previous contents are not available */
+      region = NULL;
+    }
 
-  g_signal_emit (self, canvas_signals[DRAW], 0,
-                 cr, priv->width, priv->height,
-                 &res);
+  /* keep track of what needs to be uploaded; a pending full upload
+   * covers any partial one
+   */
+  if (region == NULL)
+    g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+  else if (!priv->dirty)
+    priv->upload_region = cairo_region_copy (region);
+  else if (priv->upload_region != NULL)
+    cairo_region_union (priv->upload_region, region);
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (_clutter_diagnostic_enabled () && cairo_status (cr))
-    {
-      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
-                 self,
-                 cairo_status_to_string (cairo_status (cr)));
-    }
-#endif
+  priv->dirty = TRUE;
 
-  self->priv->cr = NULL;
-  cairo_destroy (cr);
+  emit_draw_on_surface (self, surface, region,
+                        priv->width, priv->height,
+                        priv->scale_factor);
 
   if (mapped_buffer)
     cogl_buffer_unmap (buffer);
@@ -458,12 +579,212 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
   cairo_surface_destroy (surface);
 }
 
+static void
+canvas_draw_data_free (CanvasDrawData *data)
+{
+  cairo_surface_destroy (data->surface);
+  g_clear_pointer (&data->region, cairo_region_destroy);
+  g_free (data);
+}
+
+static void
+draw_thread_func (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  ClutterCanvas *self = source_object;
+  CanvasDrawData *data = task_data;
+
+  emit_draw_on_surface (self, data->surface, data->region,
+                        data->width, data->height,
+                        data->scale_factor);
+
+  cairo_surface_flush (data->surface);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void clutter_canvas_start_threaded_draw (ClutterCanvas *self);
+
+static void
+upload_thread_surface (ClutterCanvas  *self,
+                       CanvasDrawData *data)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  int width = cairo_image_surface_get_width (data->surface);
+  int height = cairo_image_surface_get_height (data->surface);
+  int stride = cairo_image_surface_get_stride (data->surface);
+  const uint8_t *pixels = cairo_image_surface_get_data (data->surface);
+
+  if (priv->texture != NULL &&
+      data->region != NULL &&
+      cogl_texture_get_width (priv->texture) == width &&
+      cogl_texture_get_height (priv->texture) == height)
+    {
+      int i, n_rects;
+
+      n_rects = cairo_region_num_rectangles (data->region);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (data->region, i, &rect);
+          cogl_texture_set_region (priv->texture,
+                                   rect.x, rect.y,
+                                   rect.x, rect.y,
+                                   rect.width, rect.height,
+                                   width, height,
+                                   CLUTTER_CAIRO_FORMAT_ARGB32,
+                                   stride,
+                                   pixels);
+        }
+    }
+  else
+    {
+      g_autoptr (GError) error = NULL;
+      CoglContext *ctx;
+      CoglTexture *texture;
+
+      ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+      texture = COGL_TEXTURE (cogl_texture_2d_new_from_data (ctx,
+                                                             width, height,
+                                                             CLUTTER_CAIRO_FORMAT_ARGB32,
+                                                             stride,
+                                                             pixels,
+                                                             &error));
+      if (texture == NULL)
+        {
+          g_warning ("Failed to upload the contents of <ClutterCanvas>[%p]: %s",
+                     self, error->message);
+          return;
+        }
+
+      g_clear_pointer (&priv->texture, cogl_object_unref);
+      priv->texture = texture;
+    }
+}
+
+static void
+threaded_draw_done (GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  ClutterCanvas *self = CLUTTER_CANVAS (source_object);
+  ClutterCanvasPrivate *priv = self->priv;
+  CanvasDrawData *data = g_task_get_task_data (G_TASK (result));
+
+  g_task_propagate_boolean (G_TASK (result), NULL);
+
+  priv->draw_in_progress = FALSE;
+
+  /* the size changed while drawing, the contents are stale */
+  if (data->width == priv->width &&
+      data->height == priv->height &&
+      data->scale_factor == priv->scale_factor)
+    {
+      /* if threaded drawing was turned off in the meantime, the contents
+       * drawn synchronously since then are newer
+       */
+      if (priv->threaded_draw)
+        {
+          g_clear_pointer (&priv->buffer, cogl_object_unref);
+          g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+          priv->dirty = FALSE;
+
+          upload_thread_surface (self, data);
+          _clutter_content_queue_redraw (CLUTTER_CONTENT (self));
+        }
+    }
+
+  if (priv->threaded_draw && priv->thread_needs_draw)
+    clutter_canvas_start_threaded_draw (self);
+}
+
+static void
+clutter_canvas_start_threaded_draw (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  g_autoptr (GTask) task = NULL;
+  int real_width, real_height;
+  CanvasDrawData *data;
+
+  if (priv->draw_in_progress)
+    return;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  real_width = ceilf (priv->width * priv->scale_factor);
+  real_height = ceilf (priv->height * priv->scale_factor);
+
+  /* the surface is only touched by the worker thread while a draw is
+   * in progress, so this is the only place where it can be replaced
+   */
+  if (priv->thread_surface == NULL ||
+      cairo_image_surface_get_width (priv->thread_surface) != real_width ||
+      cairo_image_surface_get_height (priv->thread_surface) != real_height)
+    {
+      g_clear_pointer (&priv->thread_surface, cairo_surface_destroy);
+      priv->thread_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                         real_width,
+                                                         real_height);
+      g_clear_pointer (&priv->thread_draw_region, cairo_region_destroy);
+    }
+
+  data = g_new0 (CanvasDrawData, 1);
+  data->surface = cairo_surface_reference (priv->thread_surface);
+  data->region = g_steal_pointer (&priv->thread_draw_region);
+  data->width = priv->width;
+  data->height = priv->height;
+  data->scale_factor = priv->scale_factor;
+
+  priv->thread_needs_draw = FALSE;
+  priv->draw_in_progress = TRUE;
+
+  task = g_task_new (self, NULL, threaded_draw_done, NULL);
+  g_task_set_source_tag (task, clutter_canvas_start_threaded_draw);
+  g_task_set_task_data (task, data, (GDestroyNotify) canvas_draw_data_free);
+  g_task_run_in_thread (task, draw_thread_func);
+}
+
+/* @region is in device pixels, or %NULL for the whole canvas */
+static void
+clutter_canvas_queue_threaded_draw (ClutterCanvas        *self,
+                                    const cairo_region_t *region)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+
+  if (region == NULL)
+    {
+      g_clear_pointer (&priv->thread_draw_region, cairo_region_destroy);
+    }
+  else if (!priv->thread_needs_draw)
+    {
+      priv->thread_draw_region = cairo_region_copy (region);
+    }
+  else if (priv->thread_draw_region != NULL)
+    {
+      cairo_region_union (priv->thread_draw_region, region);
+    }
+
+  priv->thread_needs_draw = TRUE;
+
+  clutter_canvas_start_threaded_draw (self);
+}
+
 static void
 clutter_canvas_invalidate (ClutterContent *content)
 {
   ClutterCanvas *self = CLUTTER_CANVAS (content);
   ClutterCanvasPrivate *priv = self->priv;
 
+  if (priv->threaded_draw)
+    {
+      clutter_canvas_queue_threaded_draw (self, NULL);
+      return;
+    }
+
   if (priv->buffer != NULL)
     {
       cogl_object_unref (priv->buffer);
@@ -473,7 +794,7 @@ clutter_canvas_invalidate (ClutterContent *content)
   if (priv->width <= 0 || priv->height <= 0)
     return;
 
-  clutter_canvas_emit_draw (self);
+  clutter_canvas_emit_draw (self, NULL);
 }
 
 static gboolean
@@ -644,3 +965,128 @@ clutter_canvas_get_scale_factor (ClutterCanvas *canvas)
 
   return canvas->priv->scale_factor;
 }
+
+/**
+ * clutter_canvas_invalidate_rect:
+ * @canvas: a #ClutterCanvas
+ * @rect: the area to invalidate, in canvas coordinates
+ *
+ * Invalidates the contents of @canvas inside @rect.
+ *
+ * The #ClutterCanvas::draw signal is emitted with a #cairo_t clipped to
+ * @rect, and with the area cleared; only that area of the contents is
+ * uploaded again. If the contents of @canvas have not been drawn yet,
+ * this function is equivalent to clutter_content_invalidate().
+ */
+void
+clutter_canvas_invalidate_rect (ClutterCanvas               *canvas,
+                                const cairo_rectangle_int_t *rect)
+{
+  ClutterCanvasPrivate *priv;
+  cairo_rectangle_int_t device_rect;
+  cairo_region_t *region;
+  int real_width, real_height;
+  int x1, y1, x2, y2;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+  g_return_if_fail (rect != NULL);
+
+  priv = canvas->priv;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  if (!priv->threaded_draw && priv->buffer == NULL)
+    {
+      clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+      return;
+    }
+
+  real_width = ceilf (priv->width * priv->scale_factor);
+  real_height = ceilf (priv->height * priv->scale_factor);
+
+  /* round the area out to whole device pixels */
+  x1 = CLAMP (floorf (rect->x * priv->scale_factor), 0, real_width);
+  y1 = CLAMP (floorf (rect->y * priv->scale_factor), 0, real_height);
+  x2 = CLAMP (ceilf ((rect->x + rect->width) * priv->scale_factor), 0, real_width);
+  y2 = CLAMP (ceilf ((rect->y + rect->height) * priv->scale_factor), 0, real_height);
+
+  if (x2 <= x1 || y2 <= y1)
+    return;
+
+  device_rect = (cairo_rectangle_int_t) {
+    .x = x1,
+    .y = y1,
+    .width = x2 - x1,
+    .height = y2 - y1,
+  };
+  region = cairo_region_create_rectangle (&device_rect);
+
+  if (priv->threaded_draw)
+    {
+      clutter_canvas_queue_threaded_draw (canvas, region);
+    }
+  else
+    {
+      clutter_canvas_emit_draw (canvas, region);
+      _clutter_content_queue_redraw (CLUTTER_CONTENT (canvas));
+    }
+
+  cairo_region_destroy (region);
+}
+
+/**
+ * clutter_canvas_set_threaded_draw:
+ * @canvas: a #ClutterCanvas
+ * @threaded_draw: whether to draw on a worker thread
+ *
+ * Sets whether the #ClutterCanvas::draw signal should be emitted on a
+ * worker thread. While the new contents are being drawn, the previous
+ * contents of @canvas keep being painted; once drawing is done, the new
+ * contents are uploaded and the actors using @canvas are redrawn.
+ *
+ * The handlers of the #ClutterCanvas::draw signal must only use the
+ * #cairo_t context and data that is safe to access from another thread;
+ * in particular, they must not call any Clutter API.
+ */
+void
+clutter_canvas_set_threaded_draw (ClutterCanvas *canvas,
+                                  gboolean       threaded_draw)
+{
+  ClutterCanvasPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+
+  priv = canvas->priv;
+
+  threaded_draw = !!threaded_draw;
+  if (priv->threaded_draw == threaded_draw)
+    return;
+
+  priv->threaded_draw = threaded_draw;
+
+  if (!threaded_draw)
+    {
+      priv->thread_needs_draw = FALSE;
+      g_clear_pointer (&priv->thread_draw_region, cairo_region_destroy);
+
+      if (!priv->draw_in_progress)
+        g_clear_pointer (&priv->thread_surface, cairo_surface_destroy);
+    }
+}
+
+/**
+ * clutter_canvas_get_threaded_draw:
+ * @canvas: a #ClutterCanvas
+ *
+ * Retrieves whether @canvas is drawn on a worker thread.
+ *
+ * Return value: %TRUE if @canvas is drawn on a worker thread
+ */
+gboolean
+clutter_canvas_get_threaded_draw (ClutterCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_CANVAS (canvas), FALSE);
+
+  return canvas->priv->threaded_draw;
+}
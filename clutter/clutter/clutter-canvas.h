@@ -101,6 +101,16 @@ void                    clutter_canvas_set_scale_factor         (ClutterCanvas *
 CLUTTER_EXPORT
 float                   clutter_canvas_get_scale_factor         (ClutterCanvas *canvas);
 
+CLUTTER_EXPORT
+void                    clutter_canvas_invalidate_rect          (ClutterCanvas               *canvas,
+                                                                 const cairo_rectangle_int_t *rect);
+
+CLUTTER_EXPORT
+void                    clutter_canvas_set_threaded_draw        (ClutterCanvas *canvas,
+                                                                 gboolean       threaded_draw);
+CLUTTER_EXPORT
+gboolean                clutter_canvas_get_threaded_draw        (ClutterCanvas *canvas);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_CANVAS_H__ */
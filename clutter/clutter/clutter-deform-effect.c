@@ -49,6 +49,28 @@
  * Each passed vertex is an in-out parameter that initially contains the
  * position of the vertex and should be modified according to a specific
  * deformation algorithm.
+ *
+ * ## Deforming on the GPU
+ *
+ * Calling #ClutterDeformEffectClass.deform_vertex() for every vertex, and
+ * uploading the results, every time the effect is invalidated can become
+ * expensive with many tiles. Sub-classes can instead override the
+ * #ClutterDeformEffectClass.get_deform_source() virtual function to return
+ * GLSL source code defining the function:
+ *
+ * |[<!-- language="GLSL" -->
+ *   vec4 clutter_deform_vertex (vec4 position);
+ * ]|
+ *
+ * which is called for each vertex in the vertex shader. The vertex grid is
+ * then only uploaded when the size of the actor changes; the deformation
+ * can be animated by setting uniforms on the pipeline passed to the
+ * #ClutterDeformEffectClass.update_uniforms() virtual function, which is
+ * called each time the effect is painted. The size of the deformed area
+ * is available in the `clutter_deform_size` uniform, as a `vec2`.
+ *
+ * If GLSL is not supported, the #ClutterDeformEffectClass.deform_vertex()
+ * virtual function will be used instead, so it should still be implemented.
  */
 
 #include "clutter-build-config.h"
@@ -60,6 +82,7 @@
 
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
+#include "clutter-feature.h"
 #include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
@@ -82,7 +105,16 @@ struct _ClutterDeformEffectPrivate
 
   gulong allocation_id;
 
+  /* GPU deformation */
+  CoglSnippet *deform_snippet;
+  CoglPipeline *snippet_target;
+  gfloat grid_width;
+  gfloat grid_height;
+  guint grid_opacity;
+
   guint is_dirty : 1;
+  guint snippet_checked : 1;
+  guint grid_valid : 1;
 };
 
 enum
@@ -127,6 +159,63 @@ clutter_deform_effect_deform_vertex (ClutterDeformEffect *effect,
                                                            vertex);
 }
 
+static CoglSnippet *
+clutter_deform_effect_get_deform_snippet (ClutterDeformEffect *self)
+{
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  ClutterDeformEffectPrivate *priv = self->priv;
+  g_autofree char *source = NULL;
+  g_autofree char *declarations = NULL;
+
+  if (priv->snippet_checked)
+    return priv->deform_snippet;
+
+  priv->snippet_checked = TRUE;
+
+  if (klass->get_deform_source == NULL)
+    return NULL;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return NULL;
+
+  source = klass->get_deform_source (self);
+  if (source == NULL)
+    return NULL;
+
+  declarations = g_strconcat ("uniform vec2 clutter_deform_size;\n",
+                              source,
+                              NULL);
+
+  priv->deform_snippet =
+    cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX_TRANSFORM,
+                      declarations,
+                      NULL);
+  cogl_snippet_set_replace (priv->deform_snippet,
+                            "cogl_position_out =\n"
+                            "  cogl_modelview_projection_matrix *\n"
+                            "  clutter_deform_vertex (cogl_position_in);\n");
+
+  return priv->deform_snippet;
+}
+
+static void
+clutter_deform_effect_update_uniforms (ClutterDeformEffect *self,
+                                       CoglPipeline        *pipeline,
+                                       gfloat               width,
+                                       gfloat               height)
+{
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  float size[2] = { width, height };
+  int location;
+
+  location = cogl_pipeline_get_uniform_location (pipeline,
+                                                 "clutter_deform_size");
+  cogl_pipeline_set_uniform_float (pipeline, location, 2, 1, size);
+
+  if (klass->update_uniforms != NULL)
+    klass->update_uniforms (self, pipeline, width, height);
+}
+
 static void
 vbo_invalidate (ClutterActor           *actor,
                 const ClutterActorBox  *allocation,
@@ -171,36 +260,54 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect,
 {
   ClutterDeformEffect *self= CLUTTER_DEFORM_EFFECT (effect);
   ClutterDeformEffectPrivate *priv = self->priv;
+  graphene_rect_t rect;
+  ClutterActor *actor;
+  gfloat width, height;
+  CoglSnippet *snippet;
   CoglHandle material;
   CoglPipeline *pipeline;
   CoglDepthState depth_state;
   CoglFramebuffer *fb =
     clutter_paint_context_get_framebuffer (paint_context);
 
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+
+  /* if we don't have a target size, fall back to the actor's
+   * allocation, though wrong it might be
+   */
+  if (clutter_offscreen_effect_get_target_rect (effect, &rect))
+    {
+      width = graphene_rect_get_width (&rect);
+      height = graphene_rect_get_height (&rect);
+    }
+  else
+    clutter_actor_get_size (actor, &width, &height);
+
+  snippet = clutter_deform_effect_get_deform_snippet (self);
+
+  /* when deforming on the GPU, the grid only depends on the size and
+   * opacity, so invalidating the effect does not need a new upload
+   */
+  if (priv->is_dirty && snippet != NULL)
+    {
+      guint opacity = clutter_actor_get_paint_opacity (actor);
+
+      if (priv->grid_valid &&
+          priv->grid_width == width &&
+          priv->grid_height == height &&
+          priv->grid_opacity == opacity)
+        priv->is_dirty = FALSE;
+    }
+
   if (priv->is_dirty)
     {
-      graphene_rect_t rect;
       gboolean mapped_buffer;
       CoglVertexP3T2C4 *verts;
-      ClutterActor *actor;
-      gfloat width, height;
       guint opacity;
       gint i, j;
 
-      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
       opacity = clutter_actor_get_paint_opacity (actor);
 
-      /* if we don't have a target size, fall back to the actor's
-       * allocation, though wrong it might be
-       */
-      if (clutter_offscreen_effect_get_target_rect (effect, &rect))
-        {
-          width = graphene_rect_get_width (&rect);
-          height = graphene_rect_get_height (&rect);
-        }
-      else
-        clutter_actor_get_size (actor, &width, &height);
-
       /* XXX ideally, the sub-classes should tell us what they
        * changed in the texture vertices; we then would be able to
        * avoid resubmitting the same data, if it did not change. for
@@ -246,9 +353,10 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect,
 
               cogl_color_init_from_4ub (&vertex.color, 255, 255, 255, opacity);
 
-              clutter_deform_effect_deform_vertex (self,
-                                                   width, height,
-                                                   &vertex);
+              if (snippet == NULL)
+                clutter_deform_effect_deform_vertex (self,
+                                                     width, height,
+                                                     &vertex);
 
               vertex_out = verts + i * (priv->x_tiles + 1) + j;
 
@@ -275,12 +383,32 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect,
           g_free (verts);
         }
 
+      priv->grid_width = width;
+      priv->grid_height = height;
+      priv->grid_opacity = opacity;
+      priv->grid_valid = snippet != NULL;
+
       priv->is_dirty = FALSE;
     }
 
   material = clutter_offscreen_effect_get_target (effect);
   pipeline = COGL_PIPELINE (material);
 
+  if (snippet != NULL && pipeline != NULL)
+    {
+      /* the target pipeline is reused across frames, so only add the
+       * snippet when the offscreen effect replaces it
+       */
+      if (priv->snippet_target != pipeline)
+        {
+          cogl_pipeline_add_snippet (pipeline, snippet);
+          g_clear_pointer (&priv->snippet_target, cogl_object_unref);
+          priv->snippet_target = cogl_object_ref (pipeline);
+        }
+
+      clutter_deform_effect_update_uniforms (self, pipeline, width, height);
+    }
+
   /* enable depth testing */
   cogl_depth_state_init (&depth_state);
   cogl_depth_state_set_test_enabled (&depth_state, TRUE);
@@ -308,6 +436,13 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect,
       cogl_pipeline_set_cull_face_mode (back_pipeline,
                                         COGL_PIPELINE_CULL_FACE_MODE_FRONT);
 
+      if (snippet != NULL)
+        {
+          cogl_pipeline_add_snippet (back_pipeline, snippet);
+          clutter_deform_effect_update_uniforms (self, back_pipeline,
+                                                 width, height);
+        }
+
       cogl_framebuffer_draw_primitive (fb, back_pipeline, priv->primitive);
 
       cogl_object_unref (back_pipeline);
@@ -319,6 +454,14 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect,
         clutter_backend_get_cogl_context (clutter_get_default_backend ());
       CoglPipeline *lines_pipeline = cogl_pipeline_new (ctx);
       cogl_pipeline_set_color4f (lines_pipeline, 1.0, 0, 0, 1.0);
+
+      if (snippet != NULL)
+        {
+          cogl_pipeline_add_snippet (lines_pipeline, snippet);
+          clutter_deform_effect_update_uniforms (self, lines_pipeline,
+                                                 width, height);
+        }
+
       cogl_framebuffer_draw_primitive (fb, lines_pipeline,
                                        priv->lines_primitive);
       cogl_object_unref (lines_pipeline);
@@ -487,6 +630,7 @@ clutter_deform_effect_init_arrays (ClutterDeformEffect *self)
     cogl_object_unref (attributes[i]);
 
   priv->is_dirty = TRUE;
+  priv->grid_valid = FALSE;
 }
 
 static inline void
@@ -509,6 +653,9 @@ clutter_deform_effect_finalize (GObject *gobject)
   clutter_deform_effect_free_arrays (self);
   clutter_deform_effect_free_back_pipeline (self);
 
+  g_clear_pointer (&self->priv->deform_snippet, cogl_object_unref);
+  g_clear_pointer (&self->priv->snippet_target, cogl_object_unref);
+
   G_OBJECT_CLASS (clutter_deform_effect_parent_class)->finalize (gobject);
 }
 
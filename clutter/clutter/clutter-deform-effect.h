@@ -65,6 +65,12 @@ struct _ClutterDeformEffect
  * ClutterDeformEffectClass:
  * @deform_vertex: virtual function; sub-classes should override this
  *   function to compute the deformation of each vertex
+ * @get_deform_source: virtual function; sub-classes can override this
+ *   function to return the GLSL source used to deform each vertex on
+ *   the GPU, as a newly allocated string
+ * @update_uniforms: virtual function; called each time the effect is
+ *   painted when deforming on the GPU, to update the uniforms used by
+ *   the GLSL source
  *
  * The #ClutterDeformEffectClass structure contains
  * only private data
@@ -82,9 +88,14 @@ struct _ClutterDeformEffectClass
                           gfloat               height,
                           CoglTextureVertex   *vertex);
 
+  gchar * (* get_deform_source) (ClutterDeformEffect *effect);
+
+  void (* update_uniforms) (ClutterDeformEffect *effect,
+                            CoglPipeline        *pipeline,
+                            gfloat               width,
+                            gfloat               height);
+
   /*< private >*/
-  void (*_clutter_deform1) (void);
-  void (*_clutter_deform2) (void);
   void (*_clutter_deform3) (void);
   void (*_clutter_deform4) (void);
   void (*_clutter_deform5) (void);
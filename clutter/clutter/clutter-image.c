@@ -33,6 +33,12 @@
  * See [image.c](https://git.gnome.org/browse/clutter/tree/examples/image-content.c?h=clutter-1.18)
  * for an example of how to use #ClutterImage.
  *
+ * Image data can also be loaded asynchronously using
+ * clutter_image_load_bytes_async(): when possible, the pixel data is
+ * copied into a pixel buffer on a worker thread, and the texture is
+ * updated from it once it is ready; until then, the previous contents
+ * are painted.
+ *
  * #ClutterImage is available since Clutter 1.10.
  */
 
@@ -42,7 +48,10 @@
 
 #include "clutter-image.h"
 
+#include <string.h>
+
 #include "clutter-actor-private.h"
+#include "clutter-backend.h"
 #include "clutter-color.h"
 #include "clutter-content-private.h"
 #include "clutter-debug.h"
@@ -55,8 +64,27 @@ struct _ClutterImagePrivate
   CoglTexture *texture;
   gint width;
   gint height;
+
+  /* bumped every time the contents are replaced, so that pending
+   * asynchronous loads can tell they have been superseded
+   */
+  guint contents_serial;
 };
 
+typedef struct
+{
+  GBytes *bytes;
+  CoglPixelBuffer *pixel_buffer;
+  uint8_t *map;
+  CoglPixelFormat pixel_format;
+  guint width;
+  guint height;
+  guint row_stride;
+  guint contents_serial;
+} LoadData;
+
+static CoglUserDataKey bytes_key;
+
 static void clutter_content_iface_init (ClutterContentInterface *iface);
 
 G_DEFINE_TYPE_WITH_CODE (ClutterImage, clutter_image, G_TYPE_OBJECT,
@@ -91,6 +119,19 @@ update_image_size (ClutterImage *self)
   clutter_content_invalidate_size (CLUTTER_CONTENT (self));
 }
 
+static void
+set_texture (ClutterImage *image,
+             CoglTexture  *texture)
+{
+  ClutterImagePrivate *priv = image->priv;
+
+  if (priv->texture != NULL)
+    cogl_object_unref (priv->texture);
+
+  priv->texture = texture;
+  priv->contents_serial += 1;
+}
+
 static void
 clutter_image_finalize (GObject *gobject)
 {
@@ -240,19 +281,16 @@ clutter_image_set_data (ClutterImage     *image,
 
   priv = image->priv;
 
-  if (priv->texture != NULL)
-    cogl_object_unref (priv->texture);
-
   flags = COGL_TEXTURE_NONE;
   if (width >= 512 && height >= 512)
     flags |= COGL_TEXTURE_NO_ATLAS;
 
-  priv->texture = cogl_texture_new_from_data (width, height,
-                                              flags,
-                                              pixel_format,
-                                              COGL_PIXEL_FORMAT_ANY,
-                                              row_stride,
-                                              data);
+  set_texture (image, cogl_texture_new_from_data (width, height,
+                                                  flags,
+                                                  pixel_format,
+                                                  COGL_PIXEL_FORMAT_ANY,
+                                                  row_stride,
+                                                  data));
   if (priv->texture == NULL)
     {
       g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
@@ -309,19 +347,16 @@ clutter_image_set_bytes (ClutterImage     *image,
 
   priv = image->priv;
 
-  if (priv->texture != NULL)
-    cogl_object_unref (priv->texture);
-
   flags = COGL_TEXTURE_NONE;
   if (width >= 512 && height >= 512)
     flags |= COGL_TEXTURE_NO_ATLAS;
 
-  priv->texture = cogl_texture_new_from_data (width, height,
-                                              flags,
-                                              pixel_format,
-                                              COGL_PIXEL_FORMAT_ANY,
-                                              row_stride,
-                                              g_bytes_get_data (data, NULL));
+  set_texture (image, cogl_texture_new_from_data (width, height,
+                                                  flags,
+                                                  pixel_format,
+                                                  COGL_PIXEL_FORMAT_ANY,
+                                                  row_stride,
+                                                  g_bytes_get_data (data, NULL)));
   if (priv->texture == NULL)
     {
       g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
@@ -380,6 +415,7 @@ clutter_image_set_area (ClutterImage                 *image,
   g_return_val_if_fail (area != NULL, FALSE);
 
   priv = image->priv;
+  priv->contents_serial += 1;
 
   if (priv->texture == NULL)
     {
@@ -452,3 +488,292 @@ clutter_image_get_texture (ClutterImage *image)
 
   return image->priv->texture;
 }
+
+/**
+ * clutter_image_set_texture:
+ * @image: a #ClutterImage
+ * @texture: (nullable): a #CoglTexture, or %NULL
+ *
+ * Sets @texture as the contents of @image, without copying it.
+ *
+ * This can be used to display textures that are not backed by
+ * system memory, for instance dmabufs imported as an EGLImage with
+ * cogl_egl_texture_2d_new_from_image().
+ *
+ * The @image will be invalidated, and it will acquire a reference
+ * on @texture.
+ */
+void
+clutter_image_set_texture (ClutterImage *image,
+                           CoglTexture  *texture)
+{
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+  g_return_if_fail (texture == NULL || cogl_is_texture (texture));
+
+  if (texture != NULL)
+    cogl_object_ref (texture);
+
+  set_texture (image, texture);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (image));
+  update_image_size (image);
+}
+
+static void
+load_data_free (LoadData *data)
+{
+  if (data->map != NULL)
+    cogl_buffer_unmap (COGL_BUFFER (data->pixel_buffer));
+
+  g_clear_pointer (&data->pixel_buffer, cogl_object_unref);
+  g_bytes_unref (data->bytes);
+  g_free (data);
+}
+
+static void
+load_bytes_thread_func (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  LoadData *data = task_data;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  memcpy (data->map,
+          g_bytes_get_data (data->bytes, NULL),
+          (gsize) data->row_stride * data->height);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static CoglTexture *
+create_texture_from_load_data (LoadData  *data,
+                               GError   **error)
+{
+  CoglBitmap *bitmap;
+  CoglTexture *texture;
+
+  if (data->pixel_buffer != NULL)
+    {
+      cogl_buffer_unmap (COGL_BUFFER (data->pixel_buffer));
+      data->map = NULL;
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (data->pixel_buffer),
+                                            data->pixel_format,
+                                            data->width,
+                                            data->height,
+                                            data->row_stride,
+                                            0);
+    }
+  else
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+      /* the bitmap wraps the data without copying it; keep the bytes
+       * alive until the texture has been uploaded and drops the bitmap
+       */
+      bitmap = cogl_bitmap_new_for_data (ctx,
+                                         data->width,
+                                         data->height,
+                                         data->pixel_format,
+                                         data->row_stride,
+                                         (uint8_t *) g_bytes_get_data (data->bytes,
+                                                                       NULL));
+      cogl_object_set_user_data (COGL_OBJECT (bitmap), &bytes_key,
+                                 g_bytes_ref (data->bytes),
+                                 (CoglUserDataDestroyCallback) g_bytes_unref);
+    }
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_from_bitmap (bitmap));
+  cogl_object_unref (bitmap);
+
+  if (!cogl_texture_allocate (texture, error))
+    {
+      cogl_object_unref (texture);
+      return NULL;
+    }
+
+  return texture;
+}
+
+static void
+load_bytes_done (GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  ClutterImage *image = CLUTTER_IMAGE (source_object);
+  GTask *task = user_data;
+  LoadData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  CoglTexture *texture;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      g_task_return_error (task, error);
+      goto out;
+    }
+
+  if (data->contents_serial != image->priv->contents_serial)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                               "The image contents were replaced");
+      goto out;
+    }
+
+  texture = create_texture_from_load_data (data, &error);
+  if (texture == NULL)
+    {
+      g_task_return_new_error (task, CLUTTER_IMAGE_ERROR,
+                               CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                               "Unable to load image data: %s",
+                               error->message);
+      g_error_free (error);
+      goto out;
+    }
+
+  set_texture (image, texture);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (image));
+  update_image_size (image);
+
+  g_task_return_boolean (task, TRUE);
+
+out:
+  g_object_unref (task);
+}
+
+/**
+ * clutter_image_load_bytes_async:
+ * @image: a #ClutterImage
+ * @data: the image data, as a #GBytes
+ * @pixel_format: the Cogl pixel format of the image data
+ * @width: the width of the image data
+ * @height: the height of the image data
+ * @row_stride: the length of each row inside @data
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *   image data has been loaded
+ * @user_data: (closure): data to pass to @callback
+ *
+ * Asynchronously sets the image data stored inside a #GBytes to be
+ * displayed by @image.
+ *
+ * A reference is acquired on @data until the load is complete. If a
+ * pixel buffer can be mapped, the image data is copied into it on a
+ * worker thread, and the texture is then created from the pixel buffer;
+ * otherwise, the texture is created from @data directly, and the image
+ * data is uploaded on the main thread once the load completes, like
+ * clutter_image_set_bytes() does. Mapping a file with
+ * g_mapped_file_get_bytes() can be used to load image data without
+ * reading it into memory first.
+ *
+ * The current contents of @image keep being painted until the new image
+ * data is loaded, at which point @image will be invalidated.
+ *
+ * If the contents of @image are replaced before the load is complete,
+ * the load will fail with %G_IO_ERROR_CANCELLED.
+ */
+void
+clutter_image_load_bytes_async (ClutterImage        *image,
+                                GBytes              *data,
+                                CoglPixelFormat      pixel_format,
+                                guint                width,
+                                guint                height,
+                                guint                row_stride,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  GTask *task;
+  GTask *load_task;
+  LoadData *load_data;
+  CoglContext *ctx;
+  gsize size;
+
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+  g_return_if_fail (data != NULL);
+
+  task = g_task_new (image, cancellable, callback, user_data);
+  g_task_set_source_tag (task, clutter_image_load_bytes_async);
+
+  size = (gsize) row_stride * height;
+  if (width == 0 || height == 0 ||
+      cogl_pixel_format_get_n_planes (pixel_format) != 1 ||
+      row_stride < (gsize) width * cogl_pixel_format_get_bytes_per_pixel (pixel_format, 0) ||
+      g_bytes_get_size (data) < size)
+    {
+      g_task_return_new_error (task, CLUTTER_IMAGE_ERROR,
+                               CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                               "Unable to load image data");
+      g_object_unref (task);
+      return;
+    }
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  load_data = g_new0 (LoadData, 1);
+  load_data->bytes = g_bytes_ref (data);
+  load_data->pixel_format = pixel_format;
+  load_data->width = width;
+  load_data->height = height;
+  load_data->row_stride = row_stride;
+  load_data->contents_serial = image->priv->contents_serial;
+
+  /* the buffer can only be mapped from the main thread; the worker
+   * thread only writes to the mapped memory
+   */
+  load_data->pixel_buffer = cogl_pixel_buffer_new (ctx, size, NULL);
+  if (load_data->pixel_buffer != NULL)
+    {
+      load_data->map = cogl_buffer_map (COGL_BUFFER (load_data->pixel_buffer),
+                                        COGL_BUFFER_ACCESS_WRITE,
+                                        COGL_BUFFER_MAP_HINT_DISCARD);
+      if (load_data->map == NULL)
+        g_clear_pointer (&load_data->pixel_buffer, cogl_object_unref);
+    }
+
+  g_task_set_task_data (task, load_data, (GDestroyNotify) load_data_free);
+
+  load_task = g_task_new (image, cancellable, load_bytes_done, task);
+  g_task_set_source_tag (load_task, clutter_image_load_bytes_async);
+
+  if (load_data->pixel_buffer != NULL)
+    {
+      g_task_run_in_thread (load_task, load_bytes_thread_func);
+    }
+  else
+    {
+      /* without a pixel buffer, the texture wraps the bytes directly */
+      g_task_return_boolean (load_task, TRUE);
+    }
+
+  g_object_unref (load_task);
+}
+
+/**
+ * clutter_image_load_bytes_finish:
+ * @image: a #ClutterImage
+ * @result: a #GAsyncResult
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous load started with
+ * clutter_image_load_bytes_async().
+ *
+ * Return value: %TRUE if the image data was successfully loaded,
+ *   and %FALSE otherwise.
+ */
+gboolean
+clutter_image_load_bytes_finish (ClutterImage  *image,
+                                 GAsyncResult  *result,
+                                 GError       **error)
+{
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, image), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                        clutter_image_load_bytes_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -29,6 +29,7 @@
 #error "Only <clutter/clutter.h> can be included directly."
 #endif
 
+#include <gio/gio.h>
 #include <cogl/cogl.h>
 #include <clutter/clutter-types.h>
 
@@ -131,6 +132,24 @@ gboolean                clutter_image_set_bytes         (ClutterImage
                                                          guint                         height,
                                                          guint                         row_stride,
                                                          GError                      **error);
+CLUTTER_EXPORT
+void                    clutter_image_load_bytes_async  (ClutterImage                 *image,
+                                                         GBytes                       *data,
+                                                         CoglPixelFormat               pixel_format,
+                                                         guint                         width,
+                                                         guint                         height,
+                                                         guint                         row_stride,
+                                                         GCancellable                 *cancellable,
+                                                         GAsyncReadyCallback           callback,
+                                                         gpointer                      user_data);
+CLUTTER_EXPORT
+gboolean                clutter_image_load_bytes_finish (ClutterImage                 *image,
+                                                         GAsyncResult                 *result,
+                                                         GError                      **error);
+
+CLUTTER_EXPORT
+void                    clutter_image_set_texture       (ClutterImage                 *image,
+                                                         CoglTexture                  *texture);
 
 CLUTTER_EXPORT
 CoglTexture *           clutter_image_get_texture       (ClutterImage                 *image);
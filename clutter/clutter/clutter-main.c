@@ -125,6 +125,7 @@ static const GDebugKey clutter_debug_keys[] = {
   { "layout", CLUTTER_DEBUG_LAYOUT },
   { "clipping", CLUTTER_DEBUG_CLIPPING },
   { "oob-transforms", CLUTTER_DEBUG_OOB_TRANSFORMS },
+  { "memory", CLUTTER_DEBUG_MEMORY },
 };
 #endif /* CLUTTER_ENABLE_DEBUG */
 
@@ -61,6 +61,11 @@ struct _ClutterMasterClockDefault
   /* the list of timelines handled by the clock */
   GSList *timelines;
 
+  /* the timelines being advanced by the current frame; the array is
+   * kept around between frames to avoid allocating it every time
+   */
+  GPtrArray *advancing_timelines;
+
   /* the current state of the clock, in usecs */
   gint64 cur_tick;
 
@@ -306,7 +311,10 @@ master_clock_process_events (ClutterMasterClockDefault *master_clock,
 static void
 master_clock_advance_timelines (ClutterMasterClockDefault *master_clock)
 {
-  GSList *timelines, *l;
+  GPtrArray *timelines = master_clock->advancing_timelines;
+  gint64 tick_time = master_clock->cur_tick / 1000;
+  GSList *l;
+  guint i;
 #ifdef CLUTTER_ENABLE_DEBUG
   gint64 start = g_get_monotonic_time ();
 #endif
@@ -330,14 +338,19 @@ master_clock_advance_timelines (ClutterMasterClockDefault *master_clock)
    * a timeline might be removed as the direct result of do_tick()
    * and remove_timeline() would not find the timeline, failing
    * and leaving a dangling pointer behind.
+   *
+   * the copy is a contiguous array that is reused across frames, so
+   * that advancing many timelines does not allocate a list node for
+   * each one of them every frame.
    */
-  timelines = g_slist_copy (master_clock->timelines);
-  g_slist_foreach (timelines, (GFunc) g_object_ref, NULL);
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    g_ptr_array_add (timelines, g_object_ref (l->data));
 
-  for (l = timelines; l != NULL; l = l->next)
-    _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
+  for (i = 0; i < timelines->len; i++)
+    _clutter_timeline_do_tick (g_ptr_array_index (timelines, i), tick_time);
 
-  g_slist_free_full (timelines, g_object_unref);
+  /* this releases the references as well */
+  g_ptr_array_set_size (timelines, 0);
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (_clutter_diagnostic_enabled ())
@@ -503,6 +516,7 @@ clutter_master_clock_default_finalize (GObject *gobject)
   ClutterMasterClockDefault *master_clock = CLUTTER_MASTER_CLOCK_DEFAULT (gobject);
 
   g_slist_free (master_clock->timelines);
+  g_ptr_array_free (master_clock->advancing_timelines, TRUE);
 
   G_OBJECT_CLASS (clutter_master_clock_default_parent_class)->finalize (gobject);
 }
@@ -523,6 +537,8 @@ clutter_master_clock_default_init (ClutterMasterClockDefault *self)
   source = clutter_clock_source_new (self);
   self->source = source;
 
+  self->advancing_timelines = g_ptr_array_new_with_free_func (g_object_unref);
+
   self->ensure_next_iteration = FALSE;
   self->paused = FALSE;
 
@@ -286,6 +286,22 @@ gboolean        _clutter_util_matrix_decompose  (const ClutterMatrix *src,
                                                  graphene_point3d_t  *translate_p,
                                                  ClutterVertex4      *perspective_p);
 
+typedef struct _ClutterMatrixDecomposition
+{
+  graphene_point3d_t scale;
+  float shear[3];
+  graphene_point3d_t rotate;
+  graphene_point3d_t translate;
+  ClutterVertex4 perspective;
+} ClutterMatrixDecomposition;
+
+void    _clutter_util_matrix_decomposition_init         (ClutterMatrixDecomposition       *decomposition,
+                                                         const ClutterMatrix              *matrix);
+void    _clutter_util_matrix_decomposition_interpolate  (const ClutterMatrixDecomposition *a,
+                                                         const ClutterMatrixDecomposition *b,
+                                                         double                            progress,
+                                                         ClutterMatrix                    *res);
+
 CLUTTER_EXPORT
 PangoDirection _clutter_pango_unichar_direction (gunichar ch);
 
@@ -61,10 +61,13 @@ void                _clutter_stage_get_viewport          (ClutterStage
                                                           float                 *width,
                                                           float                 *height);
 void                _clutter_stage_dirty_viewport        (ClutterStage          *stage);
+guint               _clutter_stage_get_view_stamp        (ClutterStage          *stage);
 void                _clutter_stage_maybe_setup_viewport  (ClutterStage          *stage,
                                                           ClutterStageView      *view);
 void                _clutter_stage_maybe_relayout        (ClutterActor          *stage);
 gboolean            _clutter_stage_needs_update          (ClutterStage          *stage);
+void                clutter_stage_queue_actor_relayout   (ClutterStage          *stage,
+                                                          ClutterActor          *actor);
 gboolean            _clutter_stage_do_update             (ClutterStage          *stage);
 
 CLUTTER_EXPORT
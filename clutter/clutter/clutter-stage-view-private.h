@@ -33,6 +33,8 @@ gboolean clutter_stage_view_is_dirty_projection (ClutterStageView *view);
 void clutter_stage_view_set_dirty_projection (ClutterStageView *view,
                                               gboolean          dirty);
 
+CoglScanout * clutter_stage_view_take_scanout (ClutterStageView *view);
+
 void clutter_stage_view_add_redraw_clip (ClutterStageView      *view,
                                          cairo_rectangle_int_t *clip);
 
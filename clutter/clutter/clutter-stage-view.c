@@ -50,6 +50,8 @@ typedef struct _ClutterStageViewPrivate
   CoglOffscreen *shadowfb;
   CoglPipeline *shadowfb_pipeline;
 
+  CoglScanout *next_scanout;
+
   guint dirty_viewport   : 1;
   guint dirty_projection : 1;
 } ClutterStageViewPrivate;
@@ -327,6 +329,34 @@ clutter_stage_default_get_offscreen_transformation_matrix (ClutterStageView *vie
   cogl_matrix_init_identity (matrix);
 }
 
+/**
+ * clutter_stage_view_assign_next_scanout:
+ * @view: a #ClutterStageView
+ * @scanout: (transfer none): a #CoglScanout
+ *
+ * Makes the next frame of @stage_view present @scanout directly instead of
+ * painting the stage. If @scanout can not be presented, the stage is painted
+ * as usual. The assignment only applies to a single frame.
+ */
+void
+clutter_stage_view_assign_next_scanout (ClutterStageView *view,
+                                        CoglScanout      *scanout)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  g_set_object (&priv->next_scanout, scanout);
+}
+
+CoglScanout *
+clutter_stage_view_take_scanout (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  return g_steal_pointer (&priv->next_scanout);
+}
+
 static void
 clutter_stage_view_get_property (GObject    *object,
                                  guint       prop_id,
@@ -419,6 +449,7 @@ clutter_stage_view_dispose (GObject *object)
   g_clear_pointer (&priv->offscreen, cogl_object_unref);
   g_clear_pointer (&priv->offscreen_pipeline, cogl_object_unref);
   g_clear_pointer (&priv->shadowfb_pipeline, cogl_object_unref);
+  g_clear_object (&priv->next_scanout);
 
   G_OBJECT_CLASS (clutter_stage_view_parent_class)->dispose (object);
 }
@@ -68,4 +68,8 @@ CLUTTER_EXPORT
 void clutter_stage_view_get_offscreen_transformation_matrix (ClutterStageView *view,
                                                              CoglMatrix       *matrix);
 
+CLUTTER_EXPORT
+void clutter_stage_view_assign_next_scanout (ClutterStageView *view,
+                                             CoglScanout      *scanout);
+
 #endif /* __CLUTTER_STAGE_VIEW_H__ */
@@ -111,6 +111,9 @@ struct _ClutterStagePrivate
   CoglMatrix view;
   float viewport[4];
 
+  /* changes every time the projection, view, viewport or stage views do */
+  guint view_stamp;
+
   gchar *title;
   ClutterActor *key_focused_actor;
 
@@ -122,6 +125,9 @@ struct _ClutterStagePrivate
 
   GList *pending_queue_redraws;
 
+  /* relayout boundaries that need their sub-tree allocated again */
+  GHashTable *pending_relayouts;
+
   gint sync_delay;
 
   GTimer *fps_timer;
@@ -199,6 +205,7 @@ static void capture_view_into (ClutterStage          *stage,
                                uint8_t               *data,
                                int                    stride);
 static void clutter_stage_update_view_perspective (ClutterStage *stage);
+static void clutter_stage_bump_view_stamp (ClutterStage *stage);
 
 static void clutter_container_iface_init (ClutterContainerIface *iface);
 
@@ -1289,7 +1296,31 @@ _clutter_stage_needs_update (ClutterStage *stage)
 
   priv = stage->priv;
 
-  return priv->relayout_pending || priv->redraw_pending;
+  return (priv->relayout_pending ||
+          priv->pending_relayouts != NULL ||
+          priv->redraw_pending);
+}
+
+void
+clutter_stage_queue_actor_relayout (ClutterStage *stage,
+                                    ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->pending_relayouts == NULL)
+    {
+      if (!priv->relayout_pending)
+        _clutter_stage_schedule_update (stage);
+
+      priv->pending_relayouts =
+        g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+    }
+  else if (g_hash_table_contains (priv->pending_relayouts, actor))
+    {
+      return;
+    }
+
+  g_hash_table_add (priv->pending_relayouts, g_object_ref (actor));
 }
 
 void
@@ -1299,12 +1330,18 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
   ClutterStagePrivate *priv = stage->priv;
   gfloat natural_width, natural_height;
   ClutterActorBox box = { 0, };
+  GHashTable *stolen_relayouts;
 
-  if (!priv->relayout_pending)
+  if (!priv->relayout_pending && priv->pending_relayouts == NULL)
     return;
 
   /* avoid reentrancy */
-  if (!CLUTTER_ACTOR_IN_RELAYOUT (stage))
+  if (CLUTTER_ACTOR_IN_RELAYOUT (stage))
+    return;
+
+  _clutter_actor_begin_layout_pass ();
+
+  if (priv->relayout_pending)
     {
       priv->relayout_pending = FALSE;
       priv->stage_was_relayout = TRUE;
@@ -1332,6 +1369,35 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
 
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
     }
+
+  /* the sub-trees of relayout boundaries that were not reached by the
+   * allocation of the stage are allocated on their own
+   */
+  stolen_relayouts = priv->pending_relayouts;
+  priv->pending_relayouts = NULL;
+
+  if (stolen_relayouts != NULL)
+    {
+      GHashTableIter iter;
+      ClutterActor *root;
+
+      priv->stage_was_relayout = TRUE;
+
+      CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+
+      g_hash_table_iter_init (&iter, stolen_relayouts);
+      while (g_hash_table_iter_next (&iter, (gpointer *) &root, NULL))
+        {
+          if (_clutter_actor_get_stage_internal (root) == actor)
+            _clutter_actor_allocate_relayout_root (root);
+        }
+
+      CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+
+      g_hash_table_destroy (stolen_relayouts);
+    }
+
+  _clutter_actor_log_memory_stats ();
 }
 
 static void
@@ -1557,8 +1623,10 @@ clutter_stage_real_queue_redraw (ClutterActor       *actor,
     return TRUE;
 
   /* Convert the clip volume into stage coordinates and then into an
-   * axis aligned stage coordinates bounding box... */
-  _clutter_paint_volume_get_stage_paint_box (redraw_clip,
+   * axis aligned stage coordinates bounding box; the box is cached by
+   * the actor if the clip is its own paint volume... */
+  _clutter_actor_get_stage_paint_box_cached (leaf,
+                                             redraw_clip,
                                              stage,
                                              &bounding_box);
 
@@ -1910,6 +1978,8 @@ clutter_stage_dispose (GObject *object)
                     (GDestroyNotify) free_queue_redraw_entry);
   priv->pending_queue_redraws = NULL;
 
+  g_clear_pointer (&priv->pending_relayouts, g_hash_table_destroy);
+
   /* this will release the reference on the stage */
   stage_manager = clutter_stage_manager_get_default ();
   _clutter_stage_manager_remove_stage (stage_manager, stage);
@@ -2495,6 +2565,8 @@ _clutter_stage_dirty_projection (ClutterStage *stage)
 
       clutter_stage_view_set_dirty_projection (view, TRUE);
     }
+
+  clutter_stage_bump_view_stamp (stage);
 }
 
 /*
@@ -2585,6 +2657,8 @@ _clutter_stage_dirty_viewport (ClutterStage *stage)
 
       clutter_stage_view_set_dirty_viewport (view, TRUE);
     }
+
+  clutter_stage_bump_view_stamp (stage);
 }
 
 /*
@@ -3229,6 +3303,18 @@ calculate_z_translation (float z_near)
        + z_near;
 }
 
+static guint view_stamp_counter = 0;
+
+static void
+clutter_stage_bump_view_stamp (ClutterStage *stage)
+{
+  /* stamps are shared among stages, so that they never collide */
+  if (G_UNLIKELY (++view_stamp_counter == 0))
+    view_stamp_counter = 1;
+
+  stage->priv->view_stamp = view_stamp_counter;
+}
+
 static void
 clutter_stage_update_view_perspective (ClutterStage *stage)
 {
@@ -3271,6 +3357,24 @@ clutter_stage_update_view_perspective (ClutterStage *stage)
                                       z_2d,
                                       priv->viewport[2],
                                       priv->viewport[3]);
+
+  clutter_stage_bump_view_stamp (stage);
+}
+
+/*< private >
+ * _clutter_stage_get_view_stamp:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves a stamp identifying the current projection, view and
+ * viewport of @stage, and the layout and scale of its views, which can
+ * be used to validate data projected into stage coordinates.
+ *
+ * Return value: the view stamp, or 0 if the view was never set up
+ */
+guint
+_clutter_stage_get_view_stamp (ClutterStage *stage)
+{
+  return stage->priv->view_stamp;
 }
 
 void
@@ -4549,6 +4653,9 @@ _clutter_stage_peek_stage_views (ClutterStage *stage)
 void
 clutter_stage_update_resource_scales (ClutterStage *stage)
 {
+  /* called when the layout or scale of the views changed */
+  clutter_stage_bump_view_stamp (stage);
+
   _clutter_actor_queue_update_resource_scale_recursive (CLUTTER_ACTOR (stage));
 }
 
@@ -126,6 +126,10 @@ struct _ClutterTimelinePrivate
 
   GHashTable *markers_by_name;
 
+  /* the markers, sorted by their position for the current duration */
+  GPtrArray *sorted_markers;
+  guint sorted_markers_duration;
+
   /* Time we last advanced the elapsed time and showed a frame */
   gint64 last_frame_time;
 
@@ -140,6 +144,11 @@ struct _ClutterTimelinePrivate
   GDestroyNotify progress_notify;
   ClutterAnimationMode progress_mode;
 
+  /* the last value computed by the built-in progress function */
+  gdouble cached_progress;
+  gint64 cached_progress_elapsed;
+  guint cached_progress_duration;
+
   /* step() parameters */
   gint n_steps;
   ClutterStepMode step_mode;
@@ -155,6 +164,9 @@ struct _ClutterTimelinePrivate
    */
   guint waiting_first_tick : 1;
   guint auto_reverse       : 1;
+
+  guint sorted_markers_valid : 1;
+  guint progress_cached      : 1;
 };
 
 typedef struct {
@@ -169,6 +181,11 @@ typedef struct {
   guint is_relative : 1;
 } TimelineMarker;
 
+typedef struct {
+  GQuark quark;
+  gint msecs;
+} TimelineMarkerHit;
+
 enum
 {
   PROP_0,
@@ -202,6 +219,11 @@ static guint timeline_signals[LAST_SIGNAL] = { 0, };
 
 static void clutter_scriptable_iface_init (ClutterScriptableIface *iface);
 
+static gdouble clutter_timeline_progress_func (ClutterTimeline *timeline,
+                                               gdouble          elapsed,
+                                               gdouble          duration,
+                                               gpointer         user_data);
+
 G_DEFINE_TYPE_WITH_CODE (ClutterTimeline, clutter_timeline, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (ClutterTimeline)
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_SCRIPTABLE,
@@ -235,6 +257,16 @@ timeline_marker_new_progress (const gchar *name,
   return marker;
 }
 
+static inline gint
+timeline_marker_get_msecs (const TimelineMarker *marker,
+                           guint                 duration)
+{
+  if (marker->is_relative)
+    return (gdouble) duration * marker->data.progress;
+  else
+    return marker->data.msecs;
+}
+
 static void
 timeline_marker_free (gpointer data)
 {
@@ -289,6 +321,7 @@ clutter_timeline_add_marker_internal (ClutterTimeline *timeline,
     }
 
   g_hash_table_insert (priv->markers_by_name, marker->name, marker);
+  priv->sorted_markers_valid = FALSE;
 }
 
 static inline void
@@ -538,6 +571,9 @@ clutter_timeline_finalize (GObject *object)
   if (priv->markers_by_name)
     g_hash_table_destroy (priv->markers_by_name);
 
+  if (priv->sorted_markers)
+    g_ptr_array_free (priv->sorted_markers, TRUE);
+
   if (priv->is_playing)
     {
       master_clock = _clutter_master_clock_get_default ();
@@ -897,27 +933,67 @@ have_passed_time (const struct CheckIfMarkerHitClosure *data,
     }
 }
 
+static gint
+compare_markers (gconstpointer a,
+                 gconstpointer b,
+                 gpointer      user_data)
+{
+  const TimelineMarker *marker_a = *((const TimelineMarker **) a);
+  const TimelineMarker *marker_b = *((const TimelineMarker **) b);
+  guint duration = GPOINTER_TO_UINT (user_data);
+
+  return timeline_marker_get_msecs (marker_a, duration) -
+         timeline_marker_get_msecs (marker_b, duration);
+}
+
 static void
-check_if_marker_hit (const gchar *name,
-                     TimelineMarker *marker,
-                     struct CheckIfMarkerHitClosure *data)
+ensure_sorted_markers (ClutterTimeline *timeline)
 {
-  gint msecs;
+  ClutterTimelinePrivate *priv = timeline->priv;
+  GHashTableIter iter;
+  gpointer marker;
 
-  if (marker->is_relative)
-    msecs = (gdouble) data->duration * marker->data.progress;
-  else
-    msecs = marker->data.msecs;
+  if (priv->sorted_markers_valid &&
+      priv->sorted_markers_duration == priv->duration)
+    return;
+
+  if (priv->sorted_markers == NULL)
+    priv->sorted_markers = g_ptr_array_new ();
+
+  g_ptr_array_set_size (priv->sorted_markers, 0);
+
+  g_hash_table_iter_init (&iter, priv->markers_by_name);
+  while (g_hash_table_iter_next (&iter, NULL, &marker))
+    g_ptr_array_add (priv->sorted_markers, marker);
+
+  g_ptr_array_sort_with_data (priv->sorted_markers,
+                              compare_markers,
+                              GUINT_TO_POINTER (priv->duration));
+
+  priv->sorted_markers_duration = priv->duration;
+  priv->sorted_markers_valid = TRUE;
+}
 
-  if (have_passed_time (data, msecs))
+/* returns the index of the first marker placed at @msecs or later */
+static guint
+find_first_marker (ClutterTimeline *timeline,
+                   gint             msecs)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+  guint lo = 0, hi = priv->sorted_markers->len;
+
+  while (lo < hi)
     {
-      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", name);
+      guint mid = lo + (hi - lo) / 2;
+      TimelineMarker *marker = g_ptr_array_index (priv->sorted_markers, mid);
 
-      g_signal_emit (data->timeline, timeline_signals[MARKER_REACHED],
-                     marker->quark,
-                     name,
-                     msecs);
+      if (timeline_marker_get_msecs (marker, priv->duration) < msecs)
+        lo = mid + 1;
+      else
+        hi = mid;
     }
+
+  return lo;
 }
 
 static void
@@ -926,9 +1002,13 @@ check_markers (ClutterTimeline *timeline,
 {
   ClutterTimelinePrivate *priv = timeline->priv;
   struct CheckIfMarkerHitClosure data;
+  GArray *hits = NULL;
+  gint from, to;
+  guint i;
 
   /* shortcircuit here if we don't have any marker installed */
-  if (priv->markers_by_name == NULL)
+  if (priv->markers_by_name == NULL ||
+      g_hash_table_size (priv->markers_by_name) == 0)
     return;
 
   /* store the details of the timeline so that changing them in a
@@ -939,9 +1019,71 @@ check_markers (ClutterTimeline *timeline,
   data.duration = priv->duration;
   data.delta = delta;
 
-  g_hash_table_foreach (priv->markers_by_name,
-                        (GHFunc) check_if_marker_hit,
-                        &data);
+  ensure_sorted_markers (timeline);
+
+  /* only the markers between the previous and the new time can be hit */
+  if (data.direction == CLUTTER_TIMELINE_FORWARD)
+    {
+      from = data.new_time - data.delta;
+      to = data.new_time;
+    }
+  else
+    {
+      from = data.new_time;
+      to = data.new_time + data.delta;
+    }
+
+  for (i = find_first_marker (timeline, MAX (from, 0));
+       i < priv->sorted_markers->len;
+       i++)
+    {
+      TimelineMarker *marker = g_ptr_array_index (priv->sorted_markers, i);
+      gint msecs = timeline_marker_get_msecs (marker, data.duration);
+      TimelineMarkerHit hit;
+
+      if (msecs > to)
+        break;
+
+      if (!have_passed_time (&data, msecs))
+        continue;
+
+      if (hits == NULL)
+        hits = g_array_new (FALSE, FALSE, sizeof (TimelineMarkerHit));
+
+      hit.quark = marker->quark;
+      hit.msecs = msecs;
+      g_array_append_val (hits, hit);
+    }
+
+  if (hits == NULL)
+    return;
+
+  /* the markers are collected first, as the signal handlers are
+   * allowed to add or remove markers; the names are interned, so we
+   * do not need to keep the markers around. Markers are reached in
+   * the same order as the timeline is traversed
+   */
+  for (i = 0; i < hits->len; i++)
+    {
+      TimelineMarkerHit *hit;
+      const char *name;
+
+      if (data.direction == CLUTTER_TIMELINE_FORWARD)
+        hit = &g_array_index (hits, TimelineMarkerHit, i);
+      else
+        hit = &g_array_index (hits, TimelineMarkerHit, hits->len - i - 1);
+
+      name = g_quark_to_string (hit->quark);
+
+      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", name);
+
+      g_signal_emit (timeline, timeline_signals[MARKER_REACHED],
+                     hit->quark,
+                     name,
+                     hit->msecs);
+    }
+
+  g_array_free (hits, TRUE);
 }
 
 static void
@@ -954,7 +1096,22 @@ emit_frame_signal (ClutterTimeline *timeline)
 
   CLUTTER_NOTE (SCHEDULER, "Emitting ::new-frame signal on timeline[%p]", timeline);
 
-  g_signal_emit (timeline, timeline_signals[NEW_FRAME], 0, elapsed);
+  /* most timelines driving transitions have no handlers connected to
+   * ::new-frame, so we skip the signal emission machinery and just run
+   * the class handler
+   */
+  if (g_signal_has_handler_pending (timeline, timeline_signals[NEW_FRAME],
+                                    0, FALSE))
+    {
+      g_signal_emit (timeline, timeline_signals[NEW_FRAME], 0, elapsed);
+    }
+  else
+    {
+      ClutterTimelineClass *klass = CLUTTER_TIMELINE_GET_CLASS (timeline);
+
+      if (klass->new_frame != NULL)
+        klass->new_frame (timeline, elapsed);
+    }
 }
 
 static gboolean
@@ -1585,11 +1742,34 @@ clutter_timeline_get_progress (ClutterTimeline *timeline)
   /* short-circuit linear progress */
   if (priv->progress_func == NULL)
     return (gdouble) priv->elapsed_time / (gdouble) priv->duration;
-  else
-    return priv->progress_func (timeline,
-                                (gdouble) priv->elapsed_time,
-                                (gdouble) priv->duration,
-                                priv->progress_data);
+
+  /* the built-in easing functions only depend on the elapsed time
+   * and the duration, so we can avoid evaluating them again when the
+   * progress is queried multiple times during the same frame
+   */
+  if (priv->progress_func == clutter_timeline_progress_func)
+    {
+      if (!priv->progress_cached ||
+          priv->cached_progress_elapsed != priv->elapsed_time ||
+          priv->cached_progress_duration != priv->duration)
+        {
+          priv->cached_progress =
+            clutter_timeline_progress_func (timeline,
+                                            (gdouble) priv->elapsed_time,
+                                            (gdouble) priv->duration,
+                                            NULL);
+          priv->cached_progress_elapsed = priv->elapsed_time;
+          priv->cached_progress_duration = priv->duration;
+          priv->progress_cached = TRUE;
+        }
+
+      return priv->cached_progress;
+    }
+
+  return priv->progress_func (timeline,
+                              (gdouble) priv->elapsed_time,
+                              (gdouble) priv->duration,
+                              priv->progress_data);
 }
 
 /**
@@ -2018,6 +2198,7 @@ clutter_timeline_remove_marker (ClutterTimeline *timeline,
 
   /* this will take care of freeing the marker as well */
   g_hash_table_remove (priv->markers_by_name, marker_name);
+  priv->sorted_markers_valid = FALSE;
 }
 
 /**
@@ -2220,6 +2401,7 @@ clutter_timeline_set_progress_func (ClutterTimeline             *timeline,
   priv->progress_func = func;
   priv->progress_data = data;
   priv->progress_notify = notify;
+  priv->progress_cached = FALSE;
 
   if (priv->progress_func != NULL)
     priv->progress_mode = CLUTTER_CUSTOM_MODE;
@@ -2322,6 +2504,7 @@ clutter_timeline_set_progress_mode (ClutterTimeline      *timeline,
 
   priv->progress_data = NULL;
   priv->progress_notify = NULL;
+  priv->progress_cached = FALSE;
 
   g_object_notify_by_pspec (G_OBJECT (timeline), obj_props[PROP_PROGRESS_MODE]);
 }
@@ -2430,6 +2613,7 @@ clutter_timeline_set_step_progress (ClutterTimeline *timeline,
 
   priv->n_steps = n_steps;
   priv->step_mode = step_mode;
+  priv->progress_cached = FALSE;
   clutter_timeline_set_progress_mode (timeline, CLUTTER_STEPS);
 }
 
@@ -2502,6 +2686,7 @@ clutter_timeline_set_cubic_bezier_progress (ClutterTimeline        *timeline,
   /* ensure the range on the X coordinate */
   priv->cb_1.x = CLAMP (priv->cb_1.x, 0.f, 1.f);
   priv->cb_2.x = CLAMP (priv->cb_2.x, 0.f, 1.f);
+  priv->progress_cached = FALSE;
 
   clutter_timeline_set_progress_mode (timeline, CLUTTER_CUBIC_BEZIER);
 }
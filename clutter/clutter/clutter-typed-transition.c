@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* ClutterTypedTransition is an internal ClutterPropertyTransition used
+ * for the animatable properties of ClutterActor with a well known value
+ * type. Instead of going through ClutterInterval, GValue and the
+ * ClutterAnimatable API each frame, it interpolates the values of the
+ * interval directly and hands the result to a typed setter.
+ *
+ * Whenever the fast path cannot be used - the animatable overrides the
+ * interpolation or the setting of the final state, the interval has been
+ * replaced by one of a different type, or a custom progress function has
+ * been registered - the generic ClutterPropertyTransition implementation
+ * is used instead.
+ */
+
+#include "clutter-build-config.h"
+
+#include "clutter-typed-transition.h"
+
+#include "clutter-animatable.h"
+#include "clutter-debug.h"
+#include "clutter-interval.h"
+#include "clutter-private.h"
+
+typedef enum
+{
+  CLUTTER_TYPED_KIND_FLOAT,
+  CLUTTER_TYPED_KIND_DOUBLE,
+  CLUTTER_TYPED_KIND_UINT,
+  CLUTTER_TYPED_KIND_POINT,
+  CLUTTER_TYPED_KIND_SIZE,
+  CLUTTER_TYPED_KIND_COLOR,
+  CLUTTER_TYPED_KIND_MATRIX,
+} ClutterTypedKind;
+
+struct _ClutterTypedTransition
+{
+  ClutterPropertyTransition parent_instance;
+
+  GParamSpec *pspec;
+  ClutterTypedSetter setter;
+  ClutterTypedKind kind;
+
+  /* whether the attached animatable can use the fast path */
+  gboolean use_typed_path;
+
+  /* matrix intervals are decomposed once, instead of every frame */
+  gboolean has_decompositions;
+  ClutterMatrix initial_matrix;
+  ClutterMatrix final_matrix;
+  ClutterMatrixDecomposition initial_decomposition;
+  ClutterMatrixDecomposition final_decomposition;
+};
+
+G_DEFINE_TYPE (ClutterTypedTransition, clutter_typed_transition,
+               CLUTTER_TYPE_PROPERTY_TRANSITION)
+
+static gboolean
+get_kind_for_type (GType             value_type,
+                   ClutterTypedKind *kind)
+{
+  if (value_type == G_TYPE_FLOAT)
+    *kind = CLUTTER_TYPED_KIND_FLOAT;
+  else if (value_type == G_TYPE_DOUBLE)
+    *kind = CLUTTER_TYPED_KIND_DOUBLE;
+  else if (value_type == G_TYPE_UINT)
+    *kind = CLUTTER_TYPED_KIND_UINT;
+  else if (value_type == GRAPHENE_TYPE_POINT)
+    *kind = CLUTTER_TYPED_KIND_POINT;
+  else if (value_type == GRAPHENE_TYPE_SIZE)
+    *kind = CLUTTER_TYPED_KIND_SIZE;
+  else if (value_type == CLUTTER_TYPE_COLOR)
+    *kind = CLUTTER_TYPED_KIND_COLOR;
+  else if (value_type == CLUTTER_TYPE_MATRIX)
+    *kind = CLUTTER_TYPED_KIND_MATRIX;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+ensure_decompositions (ClutterTypedTransition *self,
+                       const ClutterMatrix    *initial,
+                       const ClutterMatrix    *final)
+{
+  if (self->has_decompositions &&
+      cogl_matrix_equal (&self->initial_matrix, initial) &&
+      cogl_matrix_equal (&self->final_matrix, final))
+    return;
+
+  self->initial_matrix = *initial;
+  self->final_matrix = *final;
+
+  _clutter_util_matrix_decomposition_init (&self->initial_decomposition,
+                                           initial);
+  _clutter_util_matrix_decomposition_init (&self->final_decomposition,
+                                           final);
+
+  self->has_decompositions = TRUE;
+}
+
+static void
+clutter_typed_transition_attached (ClutterTransition *transition,
+                                   ClutterAnimatable *animatable)
+{
+  ClutterTypedTransition *self = CLUTTER_TYPED_TRANSITION (transition);
+  ClutterPropertyTransition *property_transition =
+    CLUTTER_PROPERTY_TRANSITION (transition);
+  ClutterAnimatableInterface *iface, *owner_iface;
+  GType value_type;
+
+  CLUTTER_TRANSITION_CLASS (clutter_typed_transition_parent_class)->attached (transition,
+                                                                              animatable);
+
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (animatable);
+  value_type = G_PARAM_SPEC_VALUE_TYPE (self->pspec);
+
+  /* the typed setters replace ClutterAnimatable.set_final_state() of the
+   * type that installed the property, so a subclass overriding it needs
+   * the generic path
+   */
+  owner_iface = g_type_interface_peek (g_type_class_peek (self->pspec->owner_type),
+                                       CLUTTER_TYPE_ANIMATABLE);
+
+  self->use_typed_path =
+    iface->interpolate_value == NULL &&
+    owner_iface != NULL &&
+    iface->set_final_state == owner_iface->set_final_state &&
+    g_type_is_a (G_OBJECT_TYPE (animatable), self->pspec->owner_type) &&
+    g_strcmp0 (clutter_property_transition_get_property_name (property_transition),
+               self->pspec->name) == 0 &&
+    (!G_TYPE_IS_FUNDAMENTAL (value_type) ||
+     !_clutter_has_progress_function (value_type));
+
+  self->has_decompositions = FALSE;
+
+  CLUTTER_NOTE (ANIMATION, "Using the %s path for '%s'",
+                self->use_typed_path ? "typed" : "generic",
+                self->pspec->name);
+}
+
+static void
+clutter_typed_transition_detached (ClutterTransition *transition,
+                                   ClutterAnimatable *animatable)
+{
+  ClutterTypedTransition *self = CLUTTER_TYPED_TRANSITION (transition);
+
+  self->use_typed_path = FALSE;
+  self->has_decompositions = FALSE;
+
+  CLUTTER_TRANSITION_CLASS (clutter_typed_transition_parent_class)->detached (transition,
+                                                                              animatable);
+}
+
+static void
+clutter_typed_transition_compute_value (ClutterTransition *transition,
+                                        ClutterAnimatable *animatable,
+                                        ClutterInterval   *interval,
+                                        gdouble            progress)
+{
+  ClutterTypedTransition *self = CLUTTER_TYPED_TRANSITION (transition);
+  const GValue *initial, *final;
+  ClutterTypedValue value;
+
+  if (!self->use_typed_path ||
+      G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL ||
+      clutter_interval_get_value_type (interval) != G_PARAM_SPEC_VALUE_TYPE (self->pspec) ||
+      !clutter_interval_is_valid (interval))
+    {
+      CLUTTER_TRANSITION_CLASS (clutter_typed_transition_parent_class)->compute_value (transition,
+                                                                                       animatable,
+                                                                                       interval,
+                                                                                       progress);
+      return;
+    }
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  /* the math matches the one of ClutterInterval and of the progress
+   * functions registered for the boxed types
+   */
+  switch (self->kind)
+    {
+    case CLUTTER_TYPED_KIND_FLOAT:
+      {
+        double ia = g_value_get_float (initial);
+        double ib = g_value_get_float (final);
+
+        value.v_float = (progress * (ib - ia)) + ia;
+      }
+      break;
+
+    case CLUTTER_TYPED_KIND_DOUBLE:
+      {
+        double ia = g_value_get_double (initial);
+        double ib = g_value_get_double (final);
+
+        value.v_double = (progress * (ib - ia)) + ia;
+      }
+      break;
+
+    case CLUTTER_TYPED_KIND_UINT:
+      {
+        guint ia = g_value_get_uint (initial);
+        guint ib = g_value_get_uint (final);
+
+        value.v_uint = (progress * (ib - (double) ia)) + ia;
+      }
+      break;
+
+    case CLUTTER_TYPED_KIND_POINT:
+      graphene_point_interpolate (g_value_get_boxed (initial),
+                                  g_value_get_boxed (final),
+                                  progress,
+                                  &value.v_point);
+      break;
+
+    case CLUTTER_TYPED_KIND_SIZE:
+      graphene_size_interpolate (g_value_get_boxed (initial),
+                                 g_value_get_boxed (final),
+                                 progress,
+                                 &value.v_size);
+      break;
+
+    case CLUTTER_TYPED_KIND_COLOR:
+      clutter_color_interpolate (clutter_value_get_color (initial),
+                                 clutter_value_get_color (final),
+                                 progress,
+                                 &value.v_color);
+      break;
+
+    case CLUTTER_TYPED_KIND_MATRIX:
+      ensure_decompositions (self,
+                             g_value_get_boxed (initial),
+                             g_value_get_boxed (final));
+      _clutter_util_matrix_decomposition_interpolate (&self->initial_decomposition,
+                                                      &self->final_decomposition,
+                                                      progress,
+                                                      &value.v_matrix);
+      break;
+    }
+
+  self->setter (animatable, self->pspec, &value);
+}
+
+static void
+clutter_typed_transition_finalize (GObject *gobject)
+{
+  ClutterTypedTransition *self = CLUTTER_TYPED_TRANSITION (gobject);
+
+  g_param_spec_unref (self->pspec);
+
+  G_OBJECT_CLASS (clutter_typed_transition_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_typed_transition_class_init (ClutterTypedTransitionClass *klass)
+{
+  ClutterTransitionClass *transition_class = CLUTTER_TRANSITION_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  transition_class->attached = clutter_typed_transition_attached;
+  transition_class->detached = clutter_typed_transition_detached;
+  transition_class->compute_value = clutter_typed_transition_compute_value;
+
+  gobject_class->finalize = clutter_typed_transition_finalize;
+}
+
+static void
+clutter_typed_transition_init (ClutterTypedTransition *self)
+{
+}
+
+/*< private >
+ * clutter_typed_transition_supports_type:
+ * @value_type: a #GType
+ *
+ * Checks whether a #ClutterTypedTransition can animate properties
+ * of type @value_type.
+ *
+ * Return value: %TRUE if the type is supported
+ */
+gboolean
+clutter_typed_transition_supports_type (GType value_type)
+{
+  ClutterTypedKind kind;
+
+  return get_kind_for_type (value_type, &kind);
+}
+
+/*< private >
+ * clutter_typed_transition_new:
+ * @pspec: the #GParamSpec of the property to animate
+ * @setter: the function used to apply the interpolated values
+ *
+ * Creates a new #ClutterTypedTransition for @pspec; the value type
+ * of @pspec must be supported by clutter_typed_transition_supports_type().
+ *
+ * Return value: (transfer full): the newly created transition
+ */
+ClutterTransition *
+clutter_typed_transition_new (GParamSpec         *pspec,
+                              ClutterTypedSetter  setter)
+{
+  ClutterTypedTransition *self;
+  ClutterTypedKind kind;
+
+  if (!get_kind_for_type (G_PARAM_SPEC_VALUE_TYPE (pspec), &kind))
+    g_assert_not_reached ();
+
+  self = g_object_new (CLUTTER_TYPE_TYPED_TRANSITION,
+                       "property-name", pspec->name,
+                       NULL);
+
+  self->pspec = g_param_spec_ref (pspec);
+  self->setter = setter;
+  self->kind = kind;
+
+  return CLUTTER_TRANSITION (self);
+}
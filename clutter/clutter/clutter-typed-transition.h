@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_TYPED_TRANSITION_H__
+#define __CLUTTER_TYPED_TRANSITION_H__
+
+#include "clutter-color.h"
+#include "clutter-property-transition.h"
+#include "clutter-types.h"
+
+G_BEGIN_DECLS
+
+typedef union _ClutterTypedValue
+{
+  float v_float;
+  double v_double;
+  guint v_uint;
+  graphene_point_t v_point;
+  graphene_size_t v_size;
+  ClutterColor v_color;
+  ClutterMatrix v_matrix;
+} ClutterTypedValue;
+
+/* Writes an interpolated value straight into the state of the
+ * animatable, bypassing the GValue based ClutterAnimatable API */
+typedef void (* ClutterTypedSetter) (ClutterAnimatable       *animatable,
+                                     GParamSpec              *pspec,
+                                     const ClutterTypedValue *value);
+
+#define CLUTTER_TYPE_TYPED_TRANSITION (clutter_typed_transition_get_type ())
+G_DECLARE_FINAL_TYPE (ClutterTypedTransition, clutter_typed_transition,
+                      CLUTTER, TYPED_TRANSITION, ClutterPropertyTransition)
+
+gboolean            clutter_typed_transition_supports_type (GType               value_type);
+
+ClutterTransition * clutter_typed_transition_new           (GParamSpec         *pspec,
+                                                            ClutterTypedSetter  setter);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_TYPED_TRANSITION_H__ */
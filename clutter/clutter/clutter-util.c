@@ -518,6 +518,93 @@ _clutter_util_matrix_decompose (const ClutterMatrix *src,
   return TRUE;
 }
 
+/*< private >
+ * _clutter_util_matrix_decomposition_init:
+ * @decomposition: the decomposition to initialize
+ * @matrix: a #ClutterMatrix
+ *
+ * Decomposes @matrix, falling back to the identity transformations
+ * if @matrix is singular.
+ */
+void
+_clutter_util_matrix_decomposition_init (ClutterMatrixDecomposition *decomposition,
+                                         const ClutterMatrix        *matrix)
+{
+  graphene_point3d_init (&decomposition->scale, 1.f, 1.f, 1.f);
+  decomposition->shear[0] = decomposition->shear[1] = decomposition->shear[2] = 0.f;
+  graphene_point3d_init (&decomposition->rotate, 0.f, 0.f, 0.f);
+  graphene_point3d_init (&decomposition->translate, 0.f, 0.f, 0.f);
+  decomposition->perspective = (ClutterVertex4) { 0.f, 0.f, 0.f, 0.f };
+
+  _clutter_util_matrix_decompose (matrix,
+                                  &decomposition->scale,
+                                  decomposition->shear,
+                                  &decomposition->rotate,
+                                  &decomposition->translate,
+                                  &decomposition->perspective);
+}
+
+/*< private >
+ * _clutter_util_matrix_decomposition_interpolate:
+ * @a: the initial decomposition
+ * @b: the final decomposition
+ * @progress: the interpolation factor
+ * @res: (out caller-allocates): return location for the interpolated matrix
+ *
+ * Interpolates between two decomposed matrices and composes the result
+ * into @res.
+ */
+void
+_clutter_util_matrix_decomposition_interpolate (const ClutterMatrixDecomposition *a,
+                                                const ClutterMatrixDecomposition *b,
+                                                double                            progress,
+                                                ClutterMatrix                    *res)
+{
+  ClutterVertex4 perspective_res;
+  graphene_point3d_t scale_res;
+  graphene_point3d_t rotate_res;
+  graphene_point3d_t translate_res;
+  float shear_res;
+
+  clutter_matrix_init_identity (res);
+
+  /* perspective */
+  _clutter_util_vertex4_interpolate (&a->perspective, &b->perspective,
+                                     progress,
+                                     &perspective_res);
+  res->wx = perspective_res.x;
+  res->wy = perspective_res.y;
+  res->wz = perspective_res.z;
+  res->ww = perspective_res.w;
+
+  /* translation */
+  graphene_point3d_interpolate (&a->translate, &b->translate, progress, &translate_res);
+  cogl_matrix_translate (res, translate_res.x, translate_res.y, translate_res.z);
+
+  /* rotation */
+  graphene_point3d_interpolate (&a->rotate, &b->rotate, progress, &rotate_res);
+  cogl_matrix_rotate (res, rotate_res.x, 1.0f, 0.0f, 0.0f);
+  cogl_matrix_rotate (res, rotate_res.y, 0.0f, 1.0f, 0.0f);
+  cogl_matrix_rotate (res, rotate_res.z, 0.0f, 0.0f, 1.0f);
+
+  /* skew */
+  shear_res = a->shear[2] + (b->shear[2] - a->shear[2]) * progress; /* YZ */
+  if (shear_res != 0.f)
+    _clutter_util_matrix_skew_yz (res, shear_res);
+
+  shear_res = a->shear[1] + (b->shear[1] - a->shear[1]) * progress; /* XZ */
+  if (shear_res != 0.f)
+    _clutter_util_matrix_skew_xz (res, shear_res);
+
+  shear_res = a->shear[0] + (b->shear[0] - a->shear[0]) * progress; /* XY */
+  if (shear_res != 0.f)
+    _clutter_util_matrix_skew_xy (res, shear_res);
+
+  /* scale */
+  graphene_point3d_interpolate (&a->scale, &b->scale, progress, &scale_res);
+  cogl_matrix_scale (res, scale_res.x, scale_res.y, scale_res.z);
+}
+
 typedef struct
 {
   GType value_type;
@@ -1065,6 +1065,36 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
     }
 }
 
+static gboolean
+clutter_stage_cogl_scanout_view (ClutterStageView *view,
+                                 CoglScanout      *scanout)
+{
+  CoglFramebuffer *framebuffer = clutter_stage_view_get_framebuffer (view);
+  CoglFramebuffer *onscreen = clutter_stage_view_get_onscreen (view);
+  cairo_rectangle_int_t fb_rect;
+  g_autoptr (GError) error = NULL;
+
+  if (!cogl_is_onscreen (onscreen))
+    return FALSE;
+
+  if (!cogl_onscreen_direct_scanout (COGL_ONSCREEN (onscreen),
+                                     scanout, &error))
+    {
+      CLUTTER_NOTE (BACKEND, "Direct scanout failed: %s", error->message);
+      return FALSE;
+    }
+
+  /* The back buffers did not take part in this frame, so whatever is in
+   * them is stale with respect to what is now on screen. */
+  fb_rect = (cairo_rectangle_int_t) {
+    .width = cogl_framebuffer_get_width (framebuffer),
+    .height = cogl_framebuffer_get_height (framebuffer),
+  };
+  fill_current_damage_history_rectangle (view, &fb_rect);
+
+  return TRUE;
+}
+
 static void
 clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 {
@@ -1077,6 +1107,15 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
     {
       ClutterStageView *view = l->data;
+      g_autoptr (CoglScanout) scanout = NULL;
+
+      scanout = clutter_stage_view_take_scanout (view);
+      if (scanout &&
+          clutter_stage_cogl_scanout_view (view, scanout))
+        {
+          swap_event = TRUE;
+          continue;
+        }
 
       swap_event =
         clutter_stage_cogl_redraw_view (stage_window, view) || swap_event;
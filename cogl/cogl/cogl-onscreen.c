@@ -337,6 +337,44 @@ cogl_onscreen_swap_buffers (CoglOnscreen *onscreen)
   cogl_onscreen_swap_buffers_with_damage (onscreen, NULL, 0);
 }
 
+gboolean
+cogl_onscreen_direct_scanout (CoglOnscreen  *onscreen,
+                              CoglScanout   *scanout,
+                              GError       **error)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  const CoglWinsysVtable *winsys;
+  CoglFrameInfo *info;
+
+  g_return_val_if_fail (framebuffer->type == COGL_FRAMEBUFFER_TYPE_ONSCREEN,
+                        FALSE);
+
+  winsys = _cogl_framebuffer_get_winsys (framebuffer);
+  if (!winsys->onscreen_direct_scanout ||
+      !_cogl_winsys_has_feature (COGL_WINSYS_FEATURE_SYNC_AND_COMPLETE_EVENT))
+    {
+      g_set_error_literal (error, COGL_WINSYS_ERROR,
+                           COGL_WINSYS_ERROR_PRESENTATION,
+                           "Direct scanout not supported");
+      return FALSE;
+    }
+
+  info = _cogl_frame_info_new ();
+  info->frame_counter = onscreen->frame_counter;
+  g_queue_push_tail (&onscreen->pending_frame_infos, info);
+
+  if (!winsys->onscreen_direct_scanout (onscreen, scanout, info, error))
+    {
+      g_queue_pop_tail (&onscreen->pending_frame_infos);
+      cogl_object_unref (info);
+      return FALSE;
+    }
+
+  onscreen->frame_counter++;
+
+  return TRUE;
+}
+
 void
 cogl_onscreen_swap_region (CoglOnscreen *onscreen,
                            const int *rectangles,
@@ -283,6 +283,26 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen *onscreen,
                                         const int *rectangles,
                                         int n_rectangles);
 
+/**
+ * cogl_onscreen_direct_scanout: (skip)
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @scanout: A #CoglScanout to put on screen
+ * @error: return location for a #GError
+ *
+ * Presents @scanout instead of the contents of @onscreen's back buffer, as
+ * if it had been rendered and cogl_onscreen_swap_buffers() had been called.
+ * Frame events are delivered the same way as for a swap.
+ *
+ * If the window system can not present @scanout, %FALSE is returned and
+ * nothing happens; the caller is expected to render and swap as usual.
+ *
+ * Return value: %TRUE if @scanout will be presented
+ */
+gboolean
+cogl_onscreen_direct_scanout (CoglOnscreen  *onscreen,
+                              CoglScanout   *scanout,
+                              GError       **error);
+
 /**
  * cogl_onscreen_swap_region:
  * @onscreen: A #CoglOnscreen framebuffer
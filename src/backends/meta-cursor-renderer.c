@@ -335,6 +335,27 @@ meta_cursor_renderer_get_cursor (MetaCursorRenderer *renderer)
   return priv->displayed_cursor;
 }
 
+/*
+ * meta_cursor_renderer_get_overlay_rect:
+ *
+ * Returns %TRUE if the displayed cursor is painted as part of the stage
+ * rather than by the backend, and if so, where.
+ */
+gboolean
+meta_cursor_renderer_get_overlay_rect (MetaCursorRenderer *renderer,
+                                       graphene_rect_t    *rect)
+{
+  MetaCursorRendererPrivate *priv =
+    meta_cursor_renderer_get_instance_private (renderer);
+
+  if (!priv->displayed_cursor || priv->handled_by_backend)
+    return FALSE;
+
+  *rect = meta_cursor_renderer_calculate_rect (renderer,
+                                               priv->displayed_cursor);
+  return TRUE;
+}
+
 void
 meta_cursor_renderer_add_hw_cursor_inhibitor (MetaCursorRenderer    *renderer,
                                               MetaHwCursorInhibitor *inhibitor)
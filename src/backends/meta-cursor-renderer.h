@@ -67,6 +67,9 @@ void meta_cursor_renderer_force_update (MetaCursorRenderer *renderer);
 
 MetaCursorSprite * meta_cursor_renderer_get_cursor (MetaCursorRenderer *renderer);
 
+gboolean meta_cursor_renderer_get_overlay_rect (MetaCursorRenderer *renderer,
+                                                graphene_rect_t    *rect);
+
 void meta_cursor_renderer_add_hw_cursor_inhibitor (MetaCursorRenderer    *renderer,
                                                    MetaHwCursorInhibitor *inhibitor);
 
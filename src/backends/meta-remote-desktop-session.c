@@ -24,9 +24,14 @@
 
 #include "backends/meta-remote-desktop-session.h"
 
+#include <errno.h>
+#include <gio/gunixfdlist.h>
+#include <glib-unix.h>
 #include <linux/input.h>
 #include <xkbcommon/xkbcommon.h>
 #include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "backends/meta-dbus-session-watcher.h"
 #include "backends/meta-screen-cast-session.h"
@@ -44,6 +49,42 @@ enum _MetaRemoteDesktopNotifyAxisFlags
   META_REMOTE_DESKTOP_NOTIFY_AXIS_FLAGS_FINISH = 1 << 0,
 } MetaRemoteDesktopNotifyAxisFlags;
 
+/* Upper bound of packets handled per dispatch, to not starve the main loop */
+#define INPUT_CHANNEL_MAX_PACKETS_PER_DISPATCH 16
+#define INPUT_CHANNEL_MAX_EVENTS_PER_PACKET 64
+
+/* Upper bound of the steps of a single discrete axis event, each of which
+ * becomes a scroll event */
+#define INPUT_CHANNEL_MAX_DISCRETE_STEPS 120
+
+typedef enum _MetaRemoteDesktopInputEventType
+{
+  META_REMOTE_DESKTOP_INPUT_EVENT_KEYBOARD_KEYCODE = 1,
+  META_REMOTE_DESKTOP_INPUT_EVENT_KEYBOARD_KEYSYM = 2,
+  META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_BUTTON = 3,
+  META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_AXIS = 4,
+  META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_AXIS_DISCRETE = 5,
+  META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_MOTION_RELATIVE = 6,
+  META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_MOTION_ABSOLUTE = 7,
+  META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_DOWN = 8,
+  META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_MOTION = 9,
+  META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_UP = 10,
+} MetaRemoteDesktopInputEventType;
+
+/* Wire format of the input channel, see org.gnome.Mutter.RemoteDesktop.xml */
+typedef struct _MetaRemoteDesktopInputEvent
+{
+  uint64_t time_us;
+  uint32_t type;
+  uint32_t stream;
+  uint32_t code;
+  int32_t value;
+  double x;
+  double y;
+} MetaRemoteDesktopInputEvent;
+
+G_STATIC_ASSERT (sizeof (MetaRemoteDesktopInputEvent) == 40);
+
 struct _MetaRemoteDesktopSession
 {
   MetaDBusRemoteDesktopSessionSkeleton parent;
@@ -60,6 +101,10 @@ struct _MetaRemoteDesktopSession
   ClutterVirtualInputDevice *virtual_keyboard;
   ClutterVirtualInputDevice *virtual_touchscreen;
 
+  int input_channel_fd;
+  guint input_channel_source_id;
+  char **input_channel_streams;
+
   MetaRemoteDesktopSessionHandle *handle;
 };
 
@@ -112,6 +157,19 @@ init_remote_access_handle (MetaRemoteDesktopSession *session)
                                                    remote_access_handle);
 }
 
+static void
+close_input_channel (MetaRemoteDesktopSession *session)
+{
+  g_clear_handle_id (&session->input_channel_source_id, g_source_remove);
+  g_clear_pointer (&session->input_channel_streams, g_strfreev);
+
+  if (session->input_channel_fd != -1)
+    {
+      close (session->input_channel_fd);
+      session->input_channel_fd = -1;
+    }
+}
+
 static gboolean
 meta_remote_desktop_session_start (MetaRemoteDesktopSession *session,
                                    GError                  **error)
@@ -157,6 +215,8 @@ meta_remote_desktop_session_close (MetaRemoteDesktopSession *session)
       session->screen_cast_session = NULL;
     }
 
+  close_input_channel (session);
+
   g_clear_object (&session->virtual_pointer);
   g_clear_object (&session->virtual_keyboard);
   g_clear_object (&session->virtual_touchscreen);
@@ -736,6 +796,305 @@ handle_notify_touch_up (MetaDBusRemoteDesktopSession *skeleton,
   return TRUE;
 }
 
+static gboolean
+transform_input_event_position (MetaRemoteDesktopSession          *session,
+                                const MetaRemoteDesktopInputEvent *event,
+                                double                            *abs_x,
+                                double                            *abs_y)
+{
+  MetaScreenCastStream *stream;
+
+  if (!session->screen_cast_session ||
+      !session->input_channel_streams ||
+      event->stream >= g_strv_length (session->input_channel_streams))
+    return FALSE;
+
+  stream =
+    meta_screen_cast_session_get_stream (session->screen_cast_session,
+                                         session->input_channel_streams[event->stream]);
+  if (!stream)
+    return FALSE;
+
+  meta_screen_cast_stream_transform_position (stream, event->x, event->y,
+                                              abs_x, abs_y);
+  return TRUE;
+}
+
+static gboolean
+process_input_event (MetaRemoteDesktopSession          *session,
+                     const MetaRemoteDesktopInputEvent *event)
+{
+  uint64_t time_us = event->time_us;
+  double abs_x, abs_y;
+
+  switch ((MetaRemoteDesktopInputEventType) event->type)
+    {
+    case META_REMOTE_DESKTOP_INPUT_EVENT_KEYBOARD_KEYCODE:
+      clutter_virtual_input_device_notify_key (session->virtual_keyboard,
+                                               time_us,
+                                               event->code,
+                                               (event->value ?
+                                                CLUTTER_KEY_STATE_PRESSED :
+                                                CLUTTER_KEY_STATE_RELEASED));
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_KEYBOARD_KEYSYM:
+      clutter_virtual_input_device_notify_keyval (session->virtual_keyboard,
+                                                  time_us,
+                                                  event->code,
+                                                  (event->value ?
+                                                   CLUTTER_KEY_STATE_PRESSED :
+                                                   CLUTTER_KEY_STATE_RELEASED));
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_BUTTON:
+      clutter_virtual_input_device_notify_button (session->virtual_pointer,
+                                                  time_us,
+                                                  translate_to_clutter_button (event->code),
+                                                  (event->value ?
+                                                   CLUTTER_BUTTON_STATE_PRESSED :
+                                                   CLUTTER_BUTTON_STATE_RELEASED));
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_AXIS:
+      {
+        ClutterScrollFinishFlags finish_flags = CLUTTER_SCROLL_FINISHED_NONE;
+
+        if (event->value & META_REMOTE_DESKTOP_NOTIFY_AXIS_FLAGS_FINISH)
+          {
+            finish_flags |= (CLUTTER_SCROLL_FINISHED_HORIZONTAL |
+                             CLUTTER_SCROLL_FINISHED_VERTICAL);
+          }
+
+        clutter_virtual_input_device_notify_scroll_continuous (session->virtual_pointer,
+                                                               time_us,
+                                                               event->x,
+                                                               event->y,
+                                                               CLUTTER_SCROLL_SOURCE_FINGER,
+                                                               finish_flags);
+        return TRUE;
+      }
+    case META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      {
+        ClutterScrollDirection direction;
+        int step_count;
+
+        if (event->code > 1 || event->value == 0)
+          return FALSE;
+
+        if (event->value < -INPUT_CHANNEL_MAX_DISCRETE_STEPS ||
+            event->value > INPUT_CHANNEL_MAX_DISCRETE_STEPS)
+          return FALSE;
+
+        direction = discrete_steps_to_scroll_direction (event->code,
+                                                        event->value);
+        for (step_count = 0; step_count < abs (event->value); step_count++)
+          clutter_virtual_input_device_notify_discrete_scroll (session->virtual_pointer,
+                                                               time_us,
+                                                               direction,
+                                                               CLUTTER_SCROLL_SOURCE_WHEEL);
+        return TRUE;
+      }
+    case META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_MOTION_RELATIVE:
+      clutter_virtual_input_device_notify_relative_motion (session->virtual_pointer,
+                                                           time_us,
+                                                           event->x, event->y);
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+      if (!transform_input_event_position (session, event, &abs_x, &abs_y))
+        return FALSE;
+
+      clutter_virtual_input_device_notify_absolute_motion (session->virtual_pointer,
+                                                           time_us,
+                                                           abs_x, abs_y);
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_DOWN:
+      if (!transform_input_event_position (session, event, &abs_x, &abs_y))
+        return FALSE;
+
+      clutter_virtual_input_device_notify_touch_down (session->virtual_touchscreen,
+                                                      time_us,
+                                                      event->code,
+                                                      abs_x, abs_y);
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_MOTION:
+      if (!transform_input_event_position (session, event, &abs_x, &abs_y))
+        return FALSE;
+
+      clutter_virtual_input_device_notify_touch_motion (session->virtual_touchscreen,
+                                                        time_us,
+                                                        event->code,
+                                                        abs_x, abs_y);
+      return TRUE;
+    case META_REMOTE_DESKTOP_INPUT_EVENT_TOUCH_UP:
+      clutter_virtual_input_device_notify_touch_up (session->virtual_touchscreen,
+                                                    time_us,
+                                                    event->code);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+on_input_channel_readable (int           fd,
+                           GIOCondition  condition,
+                           gpointer      user_data)
+{
+  MetaRemoteDesktopSession *session = user_data;
+  MetaRemoteDesktopInputEvent events[INPUT_CHANNEL_MAX_EVENTS_PER_PACKET];
+  int n_packets;
+
+  for (n_packets = 0;
+       n_packets < INPUT_CHANNEL_MAX_PACKETS_PER_DISPATCH;
+       n_packets++)
+    {
+      ssize_t size;
+      size_t n_events;
+      size_t i;
+
+      size = recv (fd, events, sizeof (events), MSG_DONTWAIT | MSG_TRUNC);
+      if (size < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return G_SOURCE_CONTINUE;
+
+          g_warning ("Failed to read from remote desktop input channel: %s",
+                     g_strerror (errno));
+          goto close;
+        }
+
+      /* The other end hung up. */
+      if (size == 0)
+        goto close;
+
+      if ((size_t) size > sizeof (events) ||
+          size % sizeof (MetaRemoteDesktopInputEvent) != 0)
+        {
+          g_warning ("Invalid remote desktop input channel packet size %zd",
+                     size);
+          goto close;
+        }
+
+      n_events = size / sizeof (MetaRemoteDesktopInputEvent);
+      for (i = 0; i < n_events; i++)
+        {
+          if (!process_input_event (session, &events[i]))
+            {
+              g_warning ("Invalid remote desktop input channel event "
+                         "(type %u)", events[i].type);
+              goto close;
+            }
+        }
+    }
+
+  return G_SOURCE_CONTINUE;
+
+close:
+  session->input_channel_source_id = 0;
+  close_input_channel (session);
+  return G_SOURCE_REMOVE;
+}
+
+static int
+open_input_channel (MetaRemoteDesktopSession  *session,
+                    GVariant                  *options,
+                    GError                   **error)
+{
+  int fds[2];
+
+  if (session->input_channel_fd != -1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+                   "Input channel already open");
+      return -1;
+    }
+
+  if (socketpair (AF_UNIX,
+                  SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                  0, fds) < 0)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                   "Failed to create socket pair: %s",
+                   g_strerror (saved_errno));
+      return -1;
+    }
+
+  if (!g_variant_lookup (options, "streams", "^as",
+                         &session->input_channel_streams))
+    session->input_channel_streams = NULL;
+
+  session->input_channel_fd = fds[0];
+  session->input_channel_source_id =
+    g_unix_fd_add (fds[0], G_IO_IN | G_IO_HUP | G_IO_ERR,
+                   on_input_channel_readable,
+                   session);
+
+  return fds[1];
+}
+
+static gboolean
+handle_open_input_channel (MetaDBusRemoteDesktopSession *skeleton,
+                           GDBusMethodInvocation        *invocation,
+                           GUnixFDList                  *in_fd_list,
+                           GVariant                     *options)
+{
+  MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
+  g_autoptr (GUnixFDList) fd_list = NULL;
+  GError *error = NULL;
+  int fd;
+  int fd_index;
+
+  if (!check_permission (session, invocation))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_ACCESS_DENIED,
+                                             "Permission denied");
+      return TRUE;
+    }
+
+  if (!meta_remote_desktop_session_is_running (session))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Session not started");
+      return TRUE;
+    }
+
+  fd = open_input_channel (session, options, &error);
+  if (fd == -1)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Failed to open input channel: %s",
+                                             error->message);
+      g_error_free (error);
+      return TRUE;
+    }
+
+  fd_list = g_unix_fd_list_new ();
+  fd_index = g_unix_fd_list_append (fd_list, fd, &error);
+  close (fd);
+  if (fd_index == -1)
+    {
+      close_input_channel (session);
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Failed to send input channel: %s",
+                                             error->message);
+      g_error_free (error);
+      return TRUE;
+    }
+
+  meta_dbus_remote_desktop_session_complete_open_input_channel (skeleton,
+                                                                invocation,
+                                                                fd_list,
+                                                                g_variant_new_handle (fd_index));
+
+  return TRUE;
+}
+
 static void
 meta_remote_desktop_session_init_iface (MetaDBusRemoteDesktopSessionIface *iface)
 {
@@ -751,6 +1110,7 @@ meta_remote_desktop_session_init_iface (MetaDBusRemoteDesktopSessionIface *iface
   iface->handle_notify_touch_down = handle_notify_touch_down;
   iface->handle_notify_touch_motion = handle_notify_touch_motion;
   iface->handle_notify_touch_up = handle_notify_touch_up;
+  iface->handle_open_input_channel = handle_open_input_channel;
 }
 
 static void
@@ -771,6 +1131,7 @@ meta_remote_desktop_session_finalize (GObject *object)
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (object);
 
   g_assert (!meta_remote_desktop_session_is_running (session));
+  g_assert (session->input_channel_fd == -1);
 
   g_clear_object (&session->handle);
   g_free (session->peer_name);
@@ -794,6 +1155,8 @@ meta_remote_desktop_session_init (MetaRemoteDesktopSession *session)
 
   meta_dbus_remote_desktop_session_set_session_id (skeleton, session->session_id);
 
+  session->input_channel_fd = -1;
+
   session->object_path =
     g_strdup_printf (META_REMOTE_DESKTOP_SESSION_DBUS_PATH "/u%u",
                      ++global_session_number);
@@ -0,0 +1,356 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+/*
+ * Monitor streams of the same logical monitor record the same stage
+ * contents at the same point of the same paint, so the copy of the stage
+ * view, or the readback of it, is made once per frame and shared. Each
+ * stream then only pays for its own scaling and format conversion.
+ *
+ * A readback normally goes straight into the buffer of the stream asking
+ * for it; it is only kept in the entry once a second stream asks for the
+ * same monitor during the same paint, and for as long as the monitor
+ * keeps being recorded by more than one stream.
+ *
+ * Captures are dropped before every view paint; entries nobody asked for
+ * in a while are freed altogether.
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-capture-cache.h"
+
+#include <gio/gio.h>
+#include <string.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-renderer.h"
+#include "clutter/clutter-mutter.h"
+#include "meta/boxes.h"
+
+#define ENTRY_EXPIRY_US (G_USEC_PER_SEC)
+
+typedef struct _MetaCaptureEntry
+{
+  MetaRectangle layout;
+  MetaStageWatchPhase phase;
+  int64_t last_used_us;
+
+  gboolean has_texture;
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+
+  gboolean has_data;
+  uint8_t *data;
+  int data_width;
+  int data_height;
+
+  /* readbacks asked for during the current paint */
+  int n_data_requests;
+  /* whether more than one stream asked during the last paint */
+  gboolean is_data_shared;
+} MetaCaptureEntry;
+
+struct _MetaScreenCastCaptureCache
+{
+  MetaBackend *backend;
+
+  MetaStage *stage;
+  MetaStageWatch *before_paint_watch;
+
+  GList *entries;
+};
+
+static void
+meta_capture_entry_free (MetaCaptureEntry *entry)
+{
+  g_clear_pointer (&entry->offscreen, cogl_object_unref);
+  g_clear_pointer (&entry->texture, cogl_object_unref);
+  g_free (entry->data);
+  g_free (entry);
+}
+
+static void
+before_paint (MetaStage        *stage,
+              ClutterStageView *view,
+              gpointer          user_data)
+{
+  MetaScreenCastCaptureCache *cache = user_data;
+  int64_t now_us = g_get_monotonic_time ();
+  GList *l;
+
+  l = cache->entries;
+  while (l)
+    {
+      MetaCaptureEntry *entry = l->data;
+      GList *next = l->next;
+
+      if (now_us - entry->last_used_us > ENTRY_EXPIRY_US)
+        {
+          meta_capture_entry_free (entry);
+          cache->entries = g_list_delete_link (cache->entries, l);
+        }
+      else
+        {
+          entry->has_texture = FALSE;
+          entry->has_data = FALSE;
+
+          if (entry->n_data_requests > 1)
+            {
+              entry->is_data_shared = TRUE;
+            }
+          else if (entry->n_data_requests == 1 && entry->is_data_shared)
+            {
+              entry->is_data_shared = FALSE;
+              g_clear_pointer (&entry->data, g_free);
+              entry->data_width = 0;
+              entry->data_height = 0;
+            }
+
+          entry->n_data_requests = 0;
+        }
+
+      l = next;
+    }
+}
+
+static MetaCaptureEntry *
+ensure_entry (MetaScreenCastCaptureCache *cache,
+              MetaLogicalMonitor         *logical_monitor,
+              MetaStageWatchPhase         phase)
+{
+  MetaCaptureEntry *entry;
+  GList *l;
+
+  if (!cache->before_paint_watch)
+    {
+      cache->stage = META_STAGE (meta_backend_get_stage (cache->backend));
+      g_object_add_weak_pointer (G_OBJECT (cache->stage),
+                                 (gpointer *) &cache->stage);
+      cache->before_paint_watch =
+        meta_stage_watch_view (cache->stage,
+                               NULL,
+                               META_STAGE_WATCH_BEFORE_PAINT,
+                               before_paint,
+                               cache);
+    }
+
+  for (l = cache->entries; l; l = l->next)
+    {
+      entry = l->data;
+
+      if (entry->phase == phase &&
+          meta_rectangle_equal (&entry->layout, &logical_monitor->rect))
+        {
+          entry->last_used_us = g_get_monotonic_time ();
+          return entry;
+        }
+    }
+
+  entry = g_new0 (MetaCaptureEntry, 1);
+  entry->layout = logical_monitor->rect;
+  entry->phase = phase;
+  entry->last_used_us = g_get_monotonic_time ();
+  cache->entries = g_list_prepend (cache->entries, entry);
+
+  return entry;
+}
+
+static gboolean
+ensure_entry_offscreen (MetaScreenCastCaptureCache  *cache,
+                        MetaCaptureEntry            *entry,
+                        int                          width,
+                        int                          height,
+                        GError                     **error)
+{
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (cache->backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  CoglTexture2D *texture;
+  CoglOffscreen *offscreen;
+
+  if (entry->texture &&
+      cogl_texture_get_width (entry->texture) == width &&
+      cogl_texture_get_height (entry->texture) == height)
+    return TRUE;
+
+  g_clear_pointer (&entry->offscreen, cogl_object_unref);
+  g_clear_pointer (&entry->texture, cogl_object_unref);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_primitive_texture_set_auto_mipmap (COGL_PRIMITIVE_TEXTURE (texture),
+                                          FALSE);
+  if (!cogl_texture_allocate (COGL_TEXTURE (texture), error))
+    {
+      cogl_object_unref (texture);
+      return FALSE;
+    }
+
+  offscreen = cogl_offscreen_new_with_texture (COGL_TEXTURE (texture));
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    {
+      cogl_object_unref (offscreen);
+      cogl_object_unref (texture);
+      return FALSE;
+    }
+
+  entry->texture = COGL_TEXTURE (texture);
+  entry->offscreen = offscreen;
+
+  return TRUE;
+}
+
+CoglTexture *
+meta_screen_cast_capture_cache_get_texture (MetaScreenCastCaptureCache  *cache,
+                                            MetaLogicalMonitor          *logical_monitor,
+                                            MetaStageWatchPhase          phase,
+                                            GError                     **error)
+{
+  MetaRenderer *renderer = meta_backend_get_renderer (cache->backend);
+  MetaCaptureEntry *entry;
+  MetaRendererView *view;
+  cairo_rectangle_int_t view_layout;
+  CoglFramebuffer *framebuffer;
+  int width, height;
+  GError *local_error = NULL;
+
+  entry = ensure_entry (cache, logical_monitor, phase);
+  if (entry->has_texture)
+    return cogl_object_ref (entry->texture);
+
+  view = meta_renderer_get_view_from_logical_monitor (renderer,
+                                                      logical_monitor);
+  if (!view)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Monitor has no stage view");
+      return NULL;
+    }
+
+  /*
+   * Only a view showing exactly the monitor can be copied as is; anything
+   * else goes through the regular stage capture.
+   */
+  clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+  if (!meta_rectangle_equal (&view_layout, &logical_monitor->rect))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Stage view doesn't match the monitor");
+      return NULL;
+    }
+
+  framebuffer = clutter_stage_view_get_framebuffer (CLUTTER_STAGE_VIEW (view));
+  width = cogl_framebuffer_get_width (framebuffer);
+  height = cogl_framebuffer_get_height (framebuffer);
+
+  if (!ensure_entry_offscreen (cache, entry, width, height, error))
+    return NULL;
+
+  if (!cogl_blit_framebuffer (framebuffer,
+                              COGL_FRAMEBUFFER (entry->offscreen),
+                              0, 0,
+                              0, 0,
+                              width, height,
+                              &local_error))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Failed to copy stage view: %s", local_error->message);
+      g_error_free (local_error);
+      return NULL;
+    }
+
+  entry->has_texture = TRUE;
+
+  return cogl_object_ref (entry->texture);
+}
+
+void
+meta_screen_cast_capture_cache_capture_into (MetaScreenCastCaptureCache *cache,
+                                             MetaLogicalMonitor         *logical_monitor,
+                                             MetaStageWatchPhase         phase,
+                                             int                         width,
+                                             int                         height,
+                                             uint8_t                    *data)
+{
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (cache->backend));
+  MetaCaptureEntry *entry;
+  size_t size = (size_t) width * height * 4;
+
+  entry = ensure_entry (cache, logical_monitor, phase);
+  entry->n_data_requests++;
+
+  if (entry->has_data &&
+      entry->data_width == width &&
+      entry->data_height == height)
+    {
+      memcpy (data, entry->data, size);
+      return;
+    }
+
+  /* the only stream recording the monitor gets the readback directly */
+  if (!entry->is_data_shared && entry->n_data_requests == 1)
+    {
+      clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
+      return;
+    }
+
+  if (entry->data_width != width || entry->data_height != height)
+    {
+      g_free (entry->data);
+      entry->data = g_malloc (size);
+      entry->data_width = width;
+      entry->data_height = height;
+    }
+
+  clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect,
+                              entry->data);
+  entry->has_data = TRUE;
+
+  memcpy (data, entry->data, size);
+}
+
+MetaScreenCastCaptureCache *
+meta_screen_cast_capture_cache_new (MetaBackend *backend)
+{
+  MetaScreenCastCaptureCache *cache;
+
+  cache = g_new0 (MetaScreenCastCaptureCache, 1);
+  cache->backend = backend;
+
+  return cache;
+}
+
+void
+meta_screen_cast_capture_cache_free (MetaScreenCastCaptureCache *cache)
+{
+  if (cache->stage)
+    {
+      meta_stage_remove_watch (cache->stage, cache->before_paint_watch);
+      g_object_remove_weak_pointer (G_OBJECT (cache->stage),
+                                    (gpointer *) &cache->stage);
+    }
+
+  g_list_free_full (cache->entries, (GDestroyNotify) meta_capture_entry_free);
+  g_free (cache);
+}
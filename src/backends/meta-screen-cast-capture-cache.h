@@ -0,0 +1,51 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef META_SCREEN_CAST_CAPTURE_CACHE_H
+#define META_SCREEN_CAST_CAPTURE_CACHE_H
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "backends/meta-backend-types.h"
+#include "backends/meta-stage-private.h"
+#include "cogl/cogl.h"
+
+typedef struct _MetaScreenCastCaptureCache MetaScreenCastCaptureCache;
+
+MetaScreenCastCaptureCache * meta_screen_cast_capture_cache_new (MetaBackend *backend);
+
+void meta_screen_cast_capture_cache_free (MetaScreenCastCaptureCache *cache);
+
+CoglTexture * meta_screen_cast_capture_cache_get_texture (MetaScreenCastCaptureCache  *cache,
+                                                          MetaLogicalMonitor          *logical_monitor,
+                                                          MetaStageWatchPhase          phase,
+                                                          GError                     **error);
+
+void meta_screen_cast_capture_cache_capture_into (MetaScreenCastCaptureCache *cache,
+                                                  MetaLogicalMonitor         *logical_monitor,
+                                                  MetaStageWatchPhase         phase,
+                                                  int                         width,
+                                                  int                         height,
+                                                  uint8_t                    *data);
+
+#endif /* META_SCREEN_CAST_CAPTURE_CACHE_H */
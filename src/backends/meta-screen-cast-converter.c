@@ -0,0 +1,576 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-converter.h"
+
+#include <spa/utils/defs.h>
+#include <string.h>
+
+#include "clutter/clutter.h"
+
+/*
+ * The YUV formats are converted by drawing the source texture into an RGBA
+ * texture a quarter as wide as the stream, where each texel holds four
+ * consecutive bytes of the final frame. The fragment shader works out which
+ * plane and which pixels a texel corresponds to, samples the source and
+ * packs the BT.601 (limited range) values, so that the texture contents read
+ * back verbatim is the frame as it is laid out in the stream buffer.
+ *
+ * Sources larger than the stream are first halved repeatedly, like the
+ * levels of a mipmap, until they are less than twice the stream size, so
+ * that the final bilinear pass doesn't skip over source pixels.
+ */
+
+#define YUV_FRAGMENT_SHADER_DECLARATIONS                                    \
+"uniform vec2 stream_size;\n"                                              \
+"uniform float is_i420;\n"                                                 \
+"vec3 sample_rgb (vec2 position)\n"                                        \
+"{\n"                                                                      \
+"  return texture2D (cogl_sampler0, position / stream_size).rgb;\n"        \
+"}\n"                                                                      \
+"float rgb_to_y (vec3 rgb)\n"                                              \
+"{\n"                                                                      \
+"  return 0.0625 + dot (rgb, vec3 (0.257, 0.504, 0.098));\n"               \
+"}\n"                                                                      \
+"vec2 rgb_to_uv (vec3 rgb)\n"                                              \
+"{\n"                                                                      \
+"  return vec2 (0.5 + dot (rgb, vec3 (-0.148, -0.291, 0.439)),\n"          \
+"               0.5 + dot (rgb, vec3 (0.439, -0.368, -0.071)));\n"         \
+"}\n"                                                                      \
+
+#define YUV_FRAGMENT_SHADER_CODE                                            \
+"vec2 output_size = vec2 (stream_size.x / 4.0, stream_size.y * 1.5);\n"    \
+"vec2 texel = floor (cogl_tex_coord0_in.st * output_size);\n"              \
+"if (texel.y < stream_size.y)\n"                                           \
+"  {\n"                                                                    \
+"    vec2 p = vec2 (texel.x * 4.0 + 0.5, texel.y + 0.5);\n"                \
+"    cogl_color_out = vec4 (rgb_to_y (sample_rgb (p)),\n"                  \
+"                           rgb_to_y (sample_rgb (p + vec2 (1.0, 0.0))),\n" \
+"                           rgb_to_y (sample_rgb (p + vec2 (2.0, 0.0))),\n" \
+"                           rgb_to_y (sample_rgb (p + vec2 (3.0, 0.0))));\n" \
+"  }\n"                                                                    \
+"else if (is_i420 < 0.5)\n"                                                \
+"  {\n"                                                                    \
+"    vec2 p = vec2 (texel.x * 4.0 + 1.0,\n"                                \
+"                   (texel.y - stream_size.y) * 2.0 + 1.0);\n"             \
+"    cogl_color_out = vec4 (rgb_to_uv (sample_rgb (p)),\n"                 \
+"                           rgb_to_uv (sample_rgb (p + vec2 (2.0, 0.0))));\n" \
+"  }\n"                                                                    \
+"else\n"                                                                   \
+"  {\n"                                                                    \
+"    float plane_height = stream_size.y / 4.0;\n"                          \
+"    float plane_row = texel.y - stream_size.y;\n"                         \
+"    float plane = step (plane_height, plane_row);\n"                      \
+"    float half_width = stream_size.x / 2.0;\n"                            \
+"    float x = texel.x * 4.0;\n"                                           \
+"    float row = (plane_row - plane * plane_height) * 2.0 +\n"             \
+"                floor (x / half_width);\n"                                \
+"    vec2 p = vec2 (mod (x, half_width) * 2.0 + 1.0, row * 2.0 + 1.0);\n"  \
+"    vec2 c0 = rgb_to_uv (sample_rgb (p));\n"                              \
+"    vec2 c1 = rgb_to_uv (sample_rgb (p + vec2 (2.0, 0.0)));\n"            \
+"    vec2 c2 = rgb_to_uv (sample_rgb (p + vec2 (4.0, 0.0)));\n"            \
+"    vec2 c3 = rgb_to_uv (sample_rgb (p + vec2 (6.0, 0.0)));\n"            \
+"    cogl_color_out = mix (vec4 (c0.x, c1.x, c2.x, c3.x),\n"               \
+"                          vec4 (c0.y, c1.y, c2.y, c3.y),\n"               \
+"                          plane);\n"                                      \
+"  }\n"                                                                    \
+
+struct _MetaScreenCastConverter
+{
+  CoglContext *cogl_context;
+
+  MetaScreenCastFormat format;
+  int width;
+  int height;
+
+  gboolean use_shader;
+  CoglPipeline *pipeline;
+  CoglOffscreen *offscreen;
+
+  CoglPipeline *downscale_pipeline;
+  GPtrArray *downscale_offscreens;
+
+  uint8_t *bgrx_data;
+};
+
+gboolean
+meta_screen_cast_format_supports_size (MetaScreenCastFormat format,
+                                       int                  width,
+                                       int                  height)
+{
+  switch (format)
+    {
+    case META_SCREEN_CAST_FORMAT_BGRX:
+      return width > 0 && height > 0;
+    case META_SCREEN_CAST_FORMAT_NV12:
+    case META_SCREEN_CAST_FORMAT_I420:
+      return (width > 0 && height > 0 &&
+              width % 2 == 0 && height % 2 == 0);
+    }
+
+  g_assert_not_reached ();
+}
+
+static int
+get_chroma_stride (MetaScreenCastFormat format,
+                   int                  width)
+{
+  switch (format)
+    {
+    case META_SCREEN_CAST_FORMAT_BGRX:
+      return 0;
+    case META_SCREEN_CAST_FORMAT_NV12:
+      return SPA_ROUND_UP_N (width, 4);
+    case META_SCREEN_CAST_FORMAT_I420:
+      return SPA_ROUND_UP_N (width / 2, 4);
+    }
+
+  g_assert_not_reached ();
+}
+
+int
+meta_screen_cast_format_get_stride (MetaScreenCastFormat format,
+                                    int                  width)
+{
+  switch (format)
+    {
+    case META_SCREEN_CAST_FORMAT_BGRX:
+      return width * 4;
+    case META_SCREEN_CAST_FORMAT_NV12:
+    case META_SCREEN_CAST_FORMAT_I420:
+      return SPA_ROUND_UP_N (width, 4);
+    }
+
+  g_assert_not_reached ();
+}
+
+int
+meta_screen_cast_format_get_frame_size (MetaScreenCastFormat format,
+                                        int                  width,
+                                        int                  height)
+{
+  int stride = meta_screen_cast_format_get_stride (format, width);
+  int chroma_stride = get_chroma_stride (format, width);
+
+  switch (format)
+    {
+    case META_SCREEN_CAST_FORMAT_BGRX:
+      return stride * height;
+    case META_SCREEN_CAST_FORMAT_NV12:
+      return stride * height + chroma_stride * (height / 2);
+    case META_SCREEN_CAST_FORMAT_I420:
+      return stride * height + 2 * chroma_stride * (height / 2);
+    }
+
+  g_assert_not_reached ();
+}
+
+static gboolean
+can_convert_with_shader (MetaScreenCastFormat format,
+                         int                  width,
+                         int                  height)
+{
+  /*
+   * The shader writes four bytes per texel and has no notion of row
+   * padding, so the planes must be tightly packed in whole texels.
+   */
+  switch (format)
+    {
+    case META_SCREEN_CAST_FORMAT_BGRX:
+      return TRUE;
+    case META_SCREEN_CAST_FORMAT_NV12:
+      return width % 4 == 0;
+    case META_SCREEN_CAST_FORMAT_I420:
+      return width % 8 == 0 && height % 4 == 0;
+    }
+
+  g_assert_not_reached ();
+}
+
+MetaScreenCastConverter *
+meta_screen_cast_converter_new (CoglContext          *cogl_context,
+                                MetaScreenCastFormat  format,
+                                int                   width,
+                                int                   height)
+{
+  MetaScreenCastConverter *converter;
+
+  g_return_val_if_fail (meta_screen_cast_format_supports_size (format,
+                                                               width,
+                                                               height),
+                        NULL);
+
+  converter = g_new0 (MetaScreenCastConverter, 1);
+  converter->cogl_context = cogl_context;
+  converter->format = format;
+  converter->width = width;
+  converter->height = height;
+  converter->use_shader = can_convert_with_shader (format, width, height);
+  converter->downscale_offscreens =
+    g_ptr_array_new_with_free_func (cogl_object_unref);
+
+  return converter;
+}
+
+void
+meta_screen_cast_converter_free (MetaScreenCastConverter *converter)
+{
+  g_clear_pointer (&converter->pipeline, cogl_object_unref);
+  g_clear_pointer (&converter->offscreen, cogl_object_unref);
+  g_clear_pointer (&converter->downscale_pipeline, cogl_object_unref);
+  g_ptr_array_free (converter->downscale_offscreens, TRUE);
+  g_free (converter->bgrx_data);
+  g_free (converter);
+}
+
+MetaScreenCastFormat
+meta_screen_cast_converter_get_format (MetaScreenCastConverter *converter)
+{
+  return converter->format;
+}
+
+static gboolean
+is_yuv_pass (MetaScreenCastConverter *converter)
+{
+  return (converter->use_shader &&
+          converter->format != META_SCREEN_CAST_FORMAT_BGRX);
+}
+
+static CoglPipeline *
+create_pipeline (MetaScreenCastConverter *converter)
+{
+  CoglPipeline *pipeline;
+
+  pipeline = cogl_pipeline_new (converter->cogl_context);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  if (is_yuv_pass (converter))
+    {
+      CoglSnippet *snippet;
+      float stream_size[2];
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                  YUV_FRAGMENT_SHADER_DECLARATIONS,
+                                  NULL);
+      cogl_snippet_set_replace (snippet, YUV_FRAGMENT_SHADER_CODE);
+      cogl_pipeline_add_snippet (pipeline, snippet);
+      cogl_object_unref (snippet);
+
+      stream_size[0] = converter->width;
+      stream_size[1] = converter->height;
+      cogl_pipeline_set_uniform_float (pipeline,
+                                       cogl_pipeline_get_uniform_location (pipeline,
+                                                                           "stream_size"),
+                                       2, 1, stream_size);
+      cogl_pipeline_set_uniform_1f (pipeline,
+                                    cogl_pipeline_get_uniform_location (pipeline,
+                                                                        "is_i420"),
+                                    (converter->format ==
+                                     META_SCREEN_CAST_FORMAT_I420) ? 1.0 : 0.0);
+    }
+
+  return pipeline;
+}
+
+static CoglOffscreen *
+create_offscreen (MetaScreenCastConverter  *converter,
+                  int                       width,
+                  int                       height,
+                  GError                  **error)
+{
+  CoglTexture2D *texture;
+  CoglOffscreen *offscreen;
+
+  texture = cogl_texture_2d_new_with_size (converter->cogl_context,
+                                           width, height);
+  cogl_primitive_texture_set_auto_mipmap (COGL_PRIMITIVE_TEXTURE (texture),
+                                          FALSE);
+  if (!cogl_texture_allocate (COGL_TEXTURE (texture), error))
+    {
+      cogl_object_unref (texture);
+      return NULL;
+    }
+
+  offscreen = cogl_offscreen_new_with_texture (COGL_TEXTURE (texture));
+  cogl_object_unref (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    {
+      cogl_object_unref (offscreen);
+      return NULL;
+    }
+
+  return offscreen;
+}
+
+static gboolean
+ensure_offscreen (MetaScreenCastConverter  *converter,
+                  GError                  **error)
+{
+  int width, height;
+
+  if (converter->offscreen)
+    return TRUE;
+
+  if (is_yuv_pass (converter))
+    {
+      width = converter->width / 4;
+      height = converter->height + converter->height / 2;
+    }
+  else
+    {
+      width = converter->width;
+      height = converter->height;
+    }
+
+  converter->offscreen = create_offscreen (converter, width, height, error);
+  if (!converter->offscreen)
+    return FALSE;
+
+  converter->pipeline = create_pipeline (converter);
+
+  return TRUE;
+}
+
+static void
+draw_texture (CoglFramebuffer *framebuffer,
+              CoglPipeline    *template,
+              CoglTexture     *texture)
+{
+  CoglPipeline *pipeline;
+
+  pipeline = cogl_pipeline_copy (template);
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                   -1, 1, 1, -1);
+  cogl_object_unref (pipeline);
+}
+
+static CoglTexture *
+downscale_texture (MetaScreenCastConverter  *converter,
+                   CoglTexture              *texture,
+                   GError                  **error)
+{
+  int width = cogl_texture_get_width (texture);
+  int height = cogl_texture_get_height (texture);
+  unsigned int level = 0;
+
+  if (!converter->downscale_pipeline)
+    {
+      converter->downscale_pipeline =
+        cogl_pipeline_new (converter->cogl_context);
+      cogl_pipeline_set_blend (converter->downscale_pipeline,
+                               "RGBA = ADD (SRC_COLOR, 0)", NULL);
+    }
+
+  while (width >= converter->width * 2 || height >= converter->height * 2)
+    {
+      CoglOffscreen *offscreen = NULL;
+
+      if (width >= converter->width * 2)
+        width /= 2;
+      if (height >= converter->height * 2)
+        height /= 2;
+
+      if (level < converter->downscale_offscreens->len)
+        {
+          CoglFramebuffer *framebuffer;
+
+          offscreen = g_ptr_array_index (converter->downscale_offscreens,
+                                         level);
+          framebuffer = COGL_FRAMEBUFFER (offscreen);
+          if (cogl_framebuffer_get_width (framebuffer) != width ||
+              cogl_framebuffer_get_height (framebuffer) != height)
+            {
+              g_ptr_array_set_size (converter->downscale_offscreens, level);
+              offscreen = NULL;
+            }
+        }
+
+      if (!offscreen)
+        {
+          offscreen = create_offscreen (converter, width, height, error);
+          if (!offscreen)
+            return NULL;
+
+          g_ptr_array_add (converter->downscale_offscreens, offscreen);
+        }
+
+      draw_texture (COGL_FRAMEBUFFER (offscreen),
+                    converter->downscale_pipeline,
+                    texture);
+      texture = cogl_offscreen_get_texture (offscreen);
+      level++;
+    }
+
+  return texture;
+}
+
+gboolean
+meta_screen_cast_converter_convert_texture (MetaScreenCastConverter  *converter,
+                                            CoglTexture              *texture,
+                                            uint8_t                  *data,
+                                            GError                  **error)
+{
+  CoglFramebuffer *fb;
+  int stride;
+
+  if (!ensure_offscreen (converter, error))
+    return FALSE;
+
+  texture = downscale_texture (converter, texture, error);
+  if (!texture)
+    return FALSE;
+
+  fb = COGL_FRAMEBUFFER (converter->offscreen);
+  draw_texture (fb, converter->pipeline, texture);
+
+  if (is_yuv_pass (converter))
+    {
+      cogl_framebuffer_read_pixels (fb,
+                                    0, 0,
+                                    cogl_framebuffer_get_width (fb),
+                                    cogl_framebuffer_get_height (fb),
+                                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                    data);
+      return TRUE;
+    }
+
+  if (converter->format == META_SCREEN_CAST_FORMAT_BGRX)
+    {
+      cogl_framebuffer_read_pixels (fb,
+                                    0, 0,
+                                    converter->width, converter->height,
+                                    CLUTTER_CAIRO_FORMAT_ARGB32,
+                                    data);
+      return TRUE;
+    }
+
+  stride = converter->width * 4;
+  if (!converter->bgrx_data)
+    converter->bgrx_data = g_malloc (stride * converter->height);
+
+  cogl_framebuffer_read_pixels (fb,
+                                0, 0,
+                                converter->width, converter->height,
+                                CLUTTER_CAIRO_FORMAT_ARGB32,
+                                converter->bgrx_data);
+  meta_screen_cast_converter_convert_bgrx (converter,
+                                           converter->bgrx_data, stride,
+                                           data);
+
+  return TRUE;
+}
+
+static inline uint8_t
+rgb_to_y (int r,
+          int g,
+          int b)
+{
+  return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+static inline uint8_t
+rgb_to_u (int r,
+          int g,
+          int b)
+{
+  return ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+}
+
+static inline uint8_t
+rgb_to_v (int r,
+          int g,
+          int b)
+{
+  return ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+}
+
+void
+meta_screen_cast_converter_convert_bgrx (MetaScreenCastConverter *converter,
+                                         const uint8_t           *bgrx_data,
+                                         int                      bgrx_stride,
+                                         uint8_t                 *data)
+{
+  MetaScreenCastFormat format = converter->format;
+  int width = converter->width;
+  int height = converter->height;
+  int stride = meta_screen_cast_format_get_stride (format, width);
+  int chroma_stride = get_chroma_stride (format, width);
+  uint8_t *u_plane;
+  uint8_t *v_plane;
+  int x, y;
+
+  if (format == META_SCREEN_CAST_FORMAT_BGRX)
+    {
+      for (y = 0; y < height; y++)
+        memcpy (data + y * stride, bgrx_data + y * bgrx_stride, width * 4);
+      return;
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      const uint8_t *src = bgrx_data + y * bgrx_stride;
+      uint8_t *dst = data + y * stride;
+
+      for (x = 0; x < width; x++)
+        dst[x] = rgb_to_y (src[x * 4 + 2], src[x * 4 + 1], src[x * 4]);
+    }
+
+  u_plane = data + stride * height;
+  if (format == META_SCREEN_CAST_FORMAT_NV12)
+    v_plane = u_plane + 1;
+  else
+    v_plane = u_plane + chroma_stride * (height / 2);
+
+  for (y = 0; y < height / 2; y++)
+    {
+      const uint8_t *row0 = bgrx_data + (y * 2) * bgrx_stride;
+      const uint8_t *row1 = row0 + bgrx_stride;
+
+      for (x = 0; x < width / 2; x++)
+        {
+          const uint8_t *p0 = row0 + x * 8;
+          const uint8_t *p1 = row1 + x * 8;
+          int r, g, b;
+          int offset;
+
+          b = (p0[0] + p0[4] + p1[0] + p1[4] + 2) >> 2;
+          g = (p0[1] + p0[5] + p1[1] + p1[5] + 2) >> 2;
+          r = (p0[2] + p0[6] + p1[2] + p1[6] + 2) >> 2;
+
+          if (format == META_SCREEN_CAST_FORMAT_NV12)
+            offset = y * chroma_stride + x * 2;
+          else
+            offset = y * chroma_stride + x;
+
+          u_plane[offset] = rgb_to_u (r, g, b);
+          v_plane[offset] = rgb_to_v (r, g, b);
+        }
+    }
+}
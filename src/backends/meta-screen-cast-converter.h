@@ -0,0 +1,70 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef META_SCREEN_CAST_CONVERTER_H
+#define META_SCREEN_CAST_CONVERTER_H
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "cogl/cogl.h"
+
+typedef enum _MetaScreenCastFormat
+{
+  META_SCREEN_CAST_FORMAT_BGRX,
+  META_SCREEN_CAST_FORMAT_NV12,
+  META_SCREEN_CAST_FORMAT_I420,
+} MetaScreenCastFormat;
+
+typedef struct _MetaScreenCastConverter MetaScreenCastConverter;
+
+gboolean meta_screen_cast_format_supports_size (MetaScreenCastFormat format,
+                                                int                  width,
+                                                int                  height);
+
+int meta_screen_cast_format_get_stride (MetaScreenCastFormat format,
+                                        int                  width);
+
+int meta_screen_cast_format_get_frame_size (MetaScreenCastFormat format,
+                                            int                  width,
+                                            int                  height);
+
+MetaScreenCastConverter * meta_screen_cast_converter_new (CoglContext          *cogl_context,
+                                                          MetaScreenCastFormat  format,
+                                                          int                   width,
+                                                          int                   height);
+
+void meta_screen_cast_converter_free (MetaScreenCastConverter *converter);
+
+MetaScreenCastFormat meta_screen_cast_converter_get_format (MetaScreenCastConverter *converter);
+
+gboolean meta_screen_cast_converter_convert_texture (MetaScreenCastConverter  *converter,
+                                                     CoglTexture              *texture,
+                                                     uint8_t                  *data,
+                                                     GError                  **error);
+
+void meta_screen_cast_converter_convert_bgrx (MetaScreenCastConverter *converter,
+                                              const uint8_t           *bgrx_data,
+                                              int                      bgrx_stride,
+                                              uint8_t                 *data);
+
+#endif /* META_SCREEN_CAST_CONVERTER_H */
@@ -36,6 +36,8 @@
 #include "clutter/clutter.h"
 #include "clutter/clutter-mutter.h"
 #include "core/boxes-private.h"
+#include "core/display-private.h"
+#include "meta/compositor-mutter.h"
 
 struct _MetaScreenCastMonitorStreamSrc
 {
@@ -48,6 +50,13 @@ struct _MetaScreenCastMonitorStreamSrc
 
   gulong cursor_moved_handler_id;
   gulong cursor_changed_handler_id;
+
+  MetaStageWatchPhase capture_phase;
+
+  CoglOnscreen *onscreen;
+  CoglClosure *frame_closure;
+  int64_t last_presentation_time_us;
+  float refresh_rate;
 };
 
 static void
@@ -136,6 +145,18 @@ get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
   return meta_screen_cast_get_backend (screen_cast);
 }
 
+static MetaScreenCastCaptureCache *
+get_capture_cache (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+
+  return meta_screen_cast_get_capture_cache (screen_cast);
+}
+
 static gboolean
 is_cursor_in_stream (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
@@ -242,6 +263,67 @@ uninhibit_hw_cursor (MetaScreenCastMonitorStreamSrc *monitor_src)
   meta_cursor_renderer_remove_hw_cursor_inhibitor (cursor_renderer, inhibitor);
 }
 
+static void
+on_frame_event (CoglOnscreen  *onscreen,
+                CoglFrameEvent frame_event,
+                CoglFrameInfo *frame_info,
+                void          *user_data)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src = user_data;
+  CoglContext *cogl_context;
+  int64_t presentation_time_cogl;
+
+  if (frame_event != COGL_FRAME_EVENT_COMPLETE)
+    return;
+
+  presentation_time_cogl = cogl_frame_info_get_presentation_time (frame_info);
+  if (presentation_time_cogl == 0)
+    return;
+
+  /* Cogl reports presentation in nanoseconds of its own clock. */
+  cogl_context = cogl_framebuffer_get_context (COGL_FRAMEBUFFER (onscreen));
+  monitor_src->last_presentation_time_us =
+    g_get_monotonic_time () +
+    (presentation_time_cogl - cogl_get_clock_time (cogl_context)) / 1000;
+  monitor_src->refresh_rate = cogl_frame_info_get_refresh_rate (frame_info);
+}
+
+static void
+watch_presentation (MetaScreenCastMonitorStreamSrc *monitor_src,
+                    ClutterStageView               *stage_view)
+{
+  CoglFramebuffer *framebuffer;
+
+  if (!stage_view)
+    return;
+
+  framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  if (!framebuffer || !cogl_is_onscreen (framebuffer))
+    return;
+
+  monitor_src->onscreen = cogl_object_ref (framebuffer);
+  monitor_src->frame_closure =
+    cogl_onscreen_add_frame_callback (monitor_src->onscreen,
+                                      on_frame_event,
+                                      monitor_src,
+                                      NULL);
+}
+
+static void
+unwatch_presentation (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  if (!monitor_src->onscreen)
+    return;
+
+  cogl_onscreen_remove_frame_callback (monitor_src->onscreen,
+                                       monitor_src->frame_closure);
+  monitor_src->frame_closure = NULL;
+  g_clear_pointer (&monitor_src->onscreen, cogl_object_unref);
+
+  monitor_src->last_presentation_time_us = 0;
+  monitor_src->refresh_rate = 0.0f;
+}
+
 static void
 meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
 {
@@ -284,6 +366,7 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
                                 monitor_src);
       /* Intentional fall-through */
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
+      monitor_src->capture_phase = META_STAGE_WATCH_AFTER_ACTOR_PAINT;
       monitor_src->paint_watch =
         meta_stage_watch_view (meta_stage,
                                stage_view,
@@ -293,6 +376,7 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
       break;
     case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
       inhibit_hw_cursor (monitor_src);
+      monitor_src->capture_phase = META_STAGE_WATCH_AFTER_PAINT;
       monitor_src->after_paint_watch =
         meta_stage_watch_view (meta_stage,
                                stage_view,
@@ -302,6 +386,14 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
       break;
     }
 
+  watch_presentation (monitor_src, stage_view);
+
+  /* A view showing a client buffer directly is not painted, so neither
+   * would the stage watches run nor would the view have the content to
+   * capture.
+   */
+  meta_disable_unredirect_for_display (meta_get_display ());
+
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
@@ -335,6 +427,43 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
                           cursor_tracker);
   g_clear_signal_handler (&monitor_src->cursor_changed_handler_id,
                           cursor_tracker);
+
+  unwatch_presentation (monitor_src);
+
+  meta_enable_unredirect_for_display (meta_get_display ());
+}
+
+/*
+ * Frames are recorded while the view is painted, so they are shown at the
+ * next vblank after the last one the view was presented at.
+ */
+static int64_t
+meta_screen_cast_monitor_stream_src_get_frame_timestamp (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src =
+    META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
+  int64_t refresh_interval_us;
+  int64_t next_presentation_time_us;
+  int64_t now_us;
+
+  if (monitor_src->last_presentation_time_us == 0 ||
+      monitor_src->refresh_rate <= 0.0f)
+    return 0;
+
+  refresh_interval_us = (int64_t) (0.5 + G_USEC_PER_SEC /
+                                   monitor_src->refresh_rate);
+  next_presentation_time_us = (monitor_src->last_presentation_time_us +
+                               refresh_interval_us);
+
+  now_us = g_get_monotonic_time ();
+  if (next_presentation_time_us < now_us)
+    {
+      next_presentation_time_us +=
+        ((now_us - next_presentation_time_us) / refresh_interval_us + 1) *
+        refresh_interval_us;
+    }
+
+  return next_presentation_time_us;
 }
 
 static gboolean
@@ -343,9 +472,12 @@ meta_screen_cast_monitor_stream_src_record_frame (MetaScreenCastStreamSrc *src,
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
+  MetaScreenCastCaptureCache *capture_cache = get_capture_cache (monitor_src);
   ClutterStage *stage;
   MetaMonitor *monitor;
   MetaLogicalMonitor *logical_monitor;
+  int width, height;
+  float frame_rate;
 
   stage = get_stage (monitor_src);
   if (!clutter_stage_is_redraw_queued (stage))
@@ -353,11 +485,41 @@ meta_screen_cast_monitor_stream_src_record_frame (MetaScreenCastStreamSrc *src,
 
   monitor = get_monitor (monitor_src);
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
+  meta_screen_cast_monitor_stream_src_get_specs (src, &width, &height,
+                                                 &frame_rate);
+  meta_screen_cast_capture_cache_capture_into (capture_cache,
+                                               logical_monitor,
+                                               monitor_src->capture_phase,
+                                               width, height,
+                                               data);
 
   return TRUE;
 }
 
+static CoglTexture *
+meta_screen_cast_monitor_stream_src_record_texture (MetaScreenCastStreamSrc  *src,
+                                                    GError                  **error)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src =
+    META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
+  MetaScreenCastCaptureCache *capture_cache = get_capture_cache (monitor_src);
+  ClutterStage *stage;
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+
+  stage = get_stage (monitor_src);
+  if (!clutter_stage_is_redraw_queued (stage))
+    return NULL;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+
+  return meta_screen_cast_capture_cache_get_texture (capture_cache,
+                                                     logical_monitor,
+                                                     monitor_src->capture_phase,
+                                                     error);
+}
+
 static void
 meta_screen_cast_monitor_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *src,
                                                          struct spa_meta_cursor  *spa_meta_cursor)
@@ -483,6 +645,10 @@ meta_screen_cast_monitor_stream_src_class_init (MetaScreenCastMonitorStreamSrcCl
   src_class->enable = meta_screen_cast_monitor_stream_src_enable;
   src_class->disable = meta_screen_cast_monitor_stream_src_disable;
   src_class->record_frame = meta_screen_cast_monitor_stream_src_record_frame;
+  src_class->record_texture =
+    meta_screen_cast_monitor_stream_src_record_texture;
   src_class->set_cursor_metadata =
     meta_screen_cast_monitor_stream_src_set_cursor_metadata;
+  src_class->get_frame_timestamp =
+    meta_screen_cast_monitor_stream_src_get_frame_timestamp;
 }
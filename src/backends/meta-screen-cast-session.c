@@ -384,6 +384,7 @@ handle_record_window (MetaDBusScreenCastSession *skeleton,
   GDBusConnection *connection;
   MetaWindow *window;
   MetaScreenCastCursorMode cursor_mode;
+  gboolean capture_occluded;
   GError *error = NULL;
   MetaDisplay *display;
   GVariant *window_id_variant = NULL;
@@ -440,6 +441,10 @@ handle_record_window (MetaDBusScreenCastSession *skeleton,
         }
     }
 
+  if (!g_variant_lookup (properties_variant, "capture-occluded", "b",
+                         &capture_occluded))
+    capture_occluded = FALSE;
+
   interface_skeleton = G_DBUS_INTERFACE_SKELETON (skeleton);
   connection = g_dbus_interface_skeleton_get_connection (interface_skeleton);
 
@@ -447,6 +452,7 @@ handle_record_window (MetaDBusScreenCastSession *skeleton,
                                                       connection,
                                                       window,
                                                       cursor_mode,
+                                                      capture_occluded,
                                                       &error);
   if (!window_stream)
     {
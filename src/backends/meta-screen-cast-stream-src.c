@@ -25,6 +25,7 @@
 #include "backends/meta-screen-cast-stream-src.h"
 
 #include <errno.h>
+#include <math.h>
 #include <pipewire/pipewire.h>
 #include <spa/param/props.h>
 #include <spa/param/format-utils.h>
@@ -32,6 +33,7 @@
 #include <stdint.h>
 #include <sys/mman.h>
 
+#include "backends/meta-screen-cast-converter.h"
 #include "backends/meta-screen-cast-session.h"
 #include "backends/meta-screen-cast-stream.h"
 #include "clutter/clutter-mutter.h"
@@ -95,8 +97,13 @@ typedef struct _MetaScreenCastStreamSrcPrivate
 
   MetaSpaType spa_type;
   struct spa_video_info_raw video_format;
+  MetaScreenCastFormat format;
+  MetaScreenCastConverter *converter;
+  uint8_t *bgrx_frame;
+  CoglTexture2D *bgrx_texture;
 
-  uint64_t last_frame_timestamp_us;
+  int64_t next_frame_timestamp_us;
+  uint32_t frame_sequence;
 
   int stream_width;
   int stream_height;
@@ -113,6 +120,8 @@ G_DEFINE_TYPE_WITH_CODE (MetaScreenCastStreamSrc,
                          G_ADD_PRIVATE (MetaScreenCastStreamSrc))
 
 #define PROP_RANGE(min, max) 2, (min), (max)
+#define PROP_STEP(min, max, step) 3, (min), (max), (step)
+#define PROP_ENUM(n, ...) (n), __VA_ARGS__
 
 static void
 meta_screen_cast_stream_src_get_specs (MetaScreenCastStreamSrc *src,
@@ -149,6 +158,266 @@ meta_screen_cast_stream_src_record_frame (MetaScreenCastStreamSrc *src,
   return klass->record_frame (src, data);
 }
 
+/*
+ * Returns the monotonic time, in microseconds, at which the frame about to be
+ * recorded reaches the screen, when the source knows it.
+ */
+static int64_t
+get_frame_timestamp (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  int64_t timestamp_us = 0;
+
+  if (klass->get_frame_timestamp)
+    timestamp_us = klass->get_frame_timestamp (src);
+
+  if (timestamp_us == 0)
+    timestamp_us = g_get_monotonic_time ();
+
+  return timestamp_us;
+}
+
+/*
+ * Returns the interval between two frames of the negotiated format, in
+ * microseconds, or 0 if no format was negotiated yet.
+ */
+int64_t
+meta_screen_cast_stream_src_get_frame_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_fraction *frame_rate;
+
+  /* A fixed frame rate is a target; otherwise pace to the maximum. */
+  if (priv->video_format.framerate.num > 0)
+    frame_rate = &priv->video_format.framerate;
+  else
+    frame_rate = &priv->video_format.max_framerate;
+
+  if (frame_rate->num == 0)
+    return 0;
+
+  return (G_USEC_PER_SEC * (int64_t) frame_rate->denom) / frame_rate->num;
+}
+
+/*
+ * Frames are due on a fixed grid of the target frame interval, rather than an
+ * interval after the previous recorded frame. This drops frames evenly, e.g.
+ * every other one of a 60 Hz source for a 30 fps stream, instead of the
+ * stream dropping to 20 fps whenever frames arrive slightly early.
+ */
+static gboolean
+should_record_frame (MetaScreenCastStreamSrc *src,
+                     int64_t                  frame_timestamp_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t frame_interval_us;
+
+  frame_interval_us = meta_screen_cast_stream_src_get_frame_interval_us (src);
+  if (frame_interval_us == 0 || priv->next_frame_timestamp_us == 0)
+    return TRUE;
+
+  /* Take the first frame from half an interval before the next slot on,
+   * so that frames arriving slightly early still fill their slot.
+   */
+  return frame_timestamp_us >= (priv->next_frame_timestamp_us -
+                                frame_interval_us / 2);
+}
+
+/*
+ * Moves on to the next slot once a frame was queued; a frame that failed to
+ * be recorded leaves its slot to the next one.
+ */
+static void
+note_frame_recorded (MetaScreenCastStreamSrc *src,
+                     int64_t                  frame_timestamp_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t frame_interval_us;
+
+  frame_interval_us = meta_screen_cast_stream_src_get_frame_interval_us (src);
+  if (frame_interval_us == 0)
+    return;
+
+  /* Stay on the grid, unless a whole slot was missed; then restart it
+   * from this frame rather than recording a burst to catch up.
+   */
+  if (priv->next_frame_timestamp_us == 0 ||
+      frame_timestamp_us - priv->next_frame_timestamp_us >= frame_interval_us)
+    priv->next_frame_timestamp_us = frame_timestamp_us + frame_interval_us;
+  else
+    priv->next_frame_timestamp_us += frame_interval_us;
+}
+
+static gboolean
+is_stream_scaled (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  return (priv->video_format.size.width != (uint32_t) priv->stream_width ||
+          priv->video_format.size.height != (uint32_t) priv->stream_height);
+}
+
+static void
+get_stream_scale (MetaScreenCastStreamSrc *src,
+                  float                   *scale_x,
+                  float                   *scale_y)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  *scale_x = (float) priv->video_format.size.width / priv->stream_width;
+  *scale_y = (float) priv->video_format.size.height / priv->stream_height;
+}
+
+static CoglContext *
+get_cogl_context (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+  MetaBackend *backend = meta_screen_cast_get_backend (screen_cast);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static gboolean
+record_converted_frame (MetaScreenCastStreamSrc *src,
+                        uint8_t                 *data)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  GError *error = NULL;
+
+  if (klass->record_texture)
+    {
+      CoglTexture *texture;
+      gboolean converted;
+
+      texture = klass->record_texture (src, &error);
+      if (texture)
+        {
+          converted =
+            meta_screen_cast_converter_convert_texture (priv->converter,
+                                                        texture,
+                                                        data,
+                                                        &error);
+          cogl_object_unref (texture);
+          if (!converted)
+            {
+              g_warning ("Failed to convert screen cast frame: %s",
+                         error->message);
+              g_error_free (error);
+              return FALSE;
+            }
+
+          return TRUE;
+        }
+      else if (!error)
+        {
+          return FALSE;
+        }
+      else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_warning ("Failed to record screen cast frame: %s",
+                     error->message);
+          g_error_free (error);
+          return FALSE;
+        }
+
+      g_clear_error (&error);
+    }
+
+  /*
+   * No texture to convert from; record a regular BGRx frame and convert it on
+   * the CPU, or upload it again if it still needs to be scaled.
+   */
+  if (!priv->bgrx_frame)
+    {
+      priv->bgrx_frame = g_malloc (priv->stream_width *
+                                   priv->stream_height * 4);
+    }
+
+  if (!meta_screen_cast_stream_src_record_frame (src, priv->bgrx_frame))
+    return FALSE;
+
+  if (is_stream_scaled (src))
+    {
+      gboolean uploaded;
+
+      if (!priv->bgrx_texture)
+        {
+          priv->bgrx_texture =
+            cogl_texture_2d_new_from_data (get_cogl_context (src),
+                                           priv->stream_width,
+                                           priv->stream_height,
+                                           CLUTTER_CAIRO_FORMAT_ARGB32,
+                                           priv->stream_width * 4,
+                                           priv->bgrx_frame,
+                                           &error);
+          uploaded = priv->bgrx_texture != NULL;
+        }
+      else
+        {
+          uploaded = cogl_texture_set_data (COGL_TEXTURE (priv->bgrx_texture),
+                                            CLUTTER_CAIRO_FORMAT_ARGB32,
+                                            priv->stream_width * 4,
+                                            priv->bgrx_frame,
+                                            0,
+                                            &error);
+        }
+
+      if (!uploaded)
+        {
+          g_warning ("Failed to upload screen cast frame: %s",
+                     error->message);
+          g_error_free (error);
+          return FALSE;
+        }
+
+      if (!meta_screen_cast_converter_convert_texture (priv->converter,
+                                                       COGL_TEXTURE (priv->bgrx_texture),
+                                                       data,
+                                                       &error))
+        {
+          g_warning ("Failed to convert screen cast frame: %s",
+                     error->message);
+          g_error_free (error);
+          return FALSE;
+        }
+    }
+  else
+    {
+      meta_screen_cast_converter_convert_bgrx (priv->converter,
+                                               priv->bgrx_frame,
+                                               priv->stream_width * 4,
+                                               data);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+record_frame_into (MetaScreenCastStreamSrc *src,
+                   uint8_t                 *data)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->converter)
+    return record_converted_frame (src, data);
+  else
+    return meta_screen_cast_stream_src_record_frame (src, data);
+}
+
 static void
 meta_screen_cast_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *src,
                                                  struct spa_meta_cursor  *spa_meta_cursor)
@@ -168,14 +437,7 @@ draw_cursor_sprite_via_offscreen (MetaScreenCastStreamSrc  *src,
                                   uint8_t                  *bitmap_data,
                                   GError                  **error)
 {
-  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
-  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
-  MetaScreenCast *screen_cast =
-    meta_screen_cast_session_get_screen_cast (session);
-  MetaBackend *backend = meta_screen_cast_get_backend (screen_cast);
-  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
-  CoglContext *cogl_context =
-    clutter_backend_get_cogl_context (clutter_backend);
+  CoglContext *cogl_context = get_cogl_context (src);
   CoglTexture2D *bitmap_texture;
   CoglOffscreen *offscreen;
   CoglFramebuffer *fb;
@@ -222,20 +484,18 @@ draw_cursor_sprite_via_offscreen (MetaScreenCastStreamSrc  *src,
   return TRUE;
 }
 
-gboolean
-meta_screen_cast_stream_src_draw_cursor_into (MetaScreenCastStreamSrc  *src,
-                                              CoglTexture              *cursor_texture,
-                                              float                     scale,
-                                              uint8_t                  *data,
-                                              GError                  **error)
+static gboolean
+draw_cursor_into_size (MetaScreenCastStreamSrc  *src,
+                       CoglTexture              *cursor_texture,
+                       int                       width,
+                       int                       height,
+                       uint8_t                  *data,
+                       GError                  **error)
 {
   int texture_width, texture_height;
-  int width, height;
 
   texture_width = cogl_texture_get_width (cursor_texture);
   texture_height = cogl_texture_get_height (cursor_texture);
-  width = texture_width * scale;
-  height = texture_height * scale;
 
   if (texture_width == width &&
       texture_height == height)
@@ -259,6 +519,22 @@ meta_screen_cast_stream_src_draw_cursor_into (MetaScreenCastStreamSrc  *src,
   return TRUE;
 }
 
+gboolean
+meta_screen_cast_stream_src_draw_cursor_into (MetaScreenCastStreamSrc  *src,
+                                              CoglTexture              *cursor_texture,
+                                              float                     scale,
+                                              uint8_t                  *data,
+                                              GError                  **error)
+{
+  int width, height;
+
+  width = cogl_texture_get_width (cursor_texture) * scale;
+  height = cogl_texture_get_height (cursor_texture) * scale;
+
+  return draw_cursor_into_size (src, cursor_texture, width, height,
+                                data, error);
+}
+
 void
 meta_screen_cast_stream_src_unset_cursor_metadata (MetaScreenCastStreamSrc *src,
                                                    struct spa_meta_cursor  *spa_meta_cursor)
@@ -272,9 +548,13 @@ meta_screen_cast_stream_src_set_cursor_position_metadata (MetaScreenCastStreamSr
                                                           int                      x,
                                                           int                      y)
 {
+  float scale_x, scale_y;
+
+  get_stream_scale (src, &scale_x, &scale_y);
+
   spa_meta_cursor->id = 1;
-  spa_meta_cursor->position.x = x;
-  spa_meta_cursor->position.y = y;
+  spa_meta_cursor->position.x = (int32_t) roundf (x * scale_x);
+  spa_meta_cursor->position.y = (int32_t) roundf (y * scale_y);
   spa_meta_cursor->hotspot.x = 0;
   spa_meta_cursor->hotspot.y = 0;
   spa_meta_cursor->bitmap_offset = 0;
@@ -290,10 +570,13 @@ meta_screen_cast_stream_src_set_empty_cursor_sprite_metadata (MetaScreenCastStre
     meta_screen_cast_stream_src_get_instance_private (src);
   MetaSpaType *spa_type = &priv->spa_type;
   struct spa_meta_bitmap *spa_meta_bitmap;
+  float scale_x, scale_y;
+
+  get_stream_scale (src, &scale_x, &scale_y);
 
   spa_meta_cursor->id = 1;
-  spa_meta_cursor->position.x = x;
-  spa_meta_cursor->position.y = y;
+  spa_meta_cursor->position.x = (int32_t) roundf (x * scale_x);
+  spa_meta_cursor->position.y = (int32_t) roundf (y * scale_y);
 
   spa_meta_cursor->bitmap_offset = sizeof (struct spa_meta_cursor);
 
@@ -326,6 +609,8 @@ meta_screen_cast_stream_src_set_cursor_sprite_metadata (MetaScreenCastStreamSrc
   int texture_width, texture_height;
   int bitmap_width, bitmap_height;
   uint8_t *bitmap_data;
+  float scale_x, scale_y;
+  float cursor_scale_x, cursor_scale_y;
   GError *error = NULL;
 
   cursor_texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
@@ -337,9 +622,13 @@ meta_screen_cast_stream_src_set_cursor_sprite_metadata (MetaScreenCastStreamSrc
       return;
     }
 
+  get_stream_scale (src, &scale_x, &scale_y);
+  cursor_scale_x = scale * scale_x;
+  cursor_scale_y = scale * scale_y;
+
   spa_meta_cursor->id = 1;
-  spa_meta_cursor->position.x = x;
-  spa_meta_cursor->position.y = y;
+  spa_meta_cursor->position.x = (int32_t) roundf (x * scale_x);
+  spa_meta_cursor->position.y = (int32_t) roundf (y * scale_y);
 
   spa_meta_cursor->bitmap_offset = sizeof (struct spa_meta_cursor);
 
@@ -350,13 +639,13 @@ meta_screen_cast_stream_src_set_cursor_sprite_metadata (MetaScreenCastStreamSrc
   spa_meta_bitmap->offset = sizeof (struct spa_meta_bitmap);
 
   meta_cursor_sprite_get_hotspot (cursor_sprite, &hotspot_x, &hotspot_y);
-  spa_meta_cursor->hotspot.x = (int32_t) roundf (hotspot_x * scale);
-  spa_meta_cursor->hotspot.y = (int32_t) roundf (hotspot_y * scale);
+  spa_meta_cursor->hotspot.x = (int32_t) roundf (hotspot_x * cursor_scale_x);
+  spa_meta_cursor->hotspot.y = (int32_t) roundf (hotspot_y * cursor_scale_y);
 
   texture_width = cogl_texture_get_width (cursor_texture);
   texture_height = cogl_texture_get_height (cursor_texture);
-  bitmap_width = texture_width * scale;
-  bitmap_height = texture_height * scale;
+  bitmap_width = texture_width * cursor_scale_x;
+  bitmap_height = texture_height * cursor_scale_y;
 
   spa_meta_bitmap->size.width = bitmap_width;
   spa_meta_bitmap->size.height = bitmap_height;
@@ -366,11 +655,12 @@ meta_screen_cast_stream_src_set_cursor_sprite_metadata (MetaScreenCastStreamSrc
                             spa_meta_bitmap->offset,
                             uint8_t);
 
-  if (!meta_screen_cast_stream_src_draw_cursor_into (src,
-                                                     cursor_texture,
-                                                     scale,
-                                                     bitmap_data,
-                                                     &error))
+  if (!draw_cursor_into_size (src,
+                              cursor_texture,
+                              bitmap_width,
+                              bitmap_height,
+                              bitmap_data,
+                              &error))
     {
       g_warning ("Failed to draw cursor: %s", error->message);
       g_error_free (error);
@@ -420,18 +710,17 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
   MetaRectangle crop_rect;
   struct pw_buffer *buffer;
   struct spa_buffer *spa_buffer;
+  struct spa_meta_header *spa_meta_header;
   uint8_t *map = NULL;
   uint8_t *data;
-  uint64_t now_us;
+  int64_t frame_timestamp_us;
+  gboolean recorded;
 
-  now_us = g_get_monotonic_time ();
-  if (priv->last_frame_timestamp_us != 0 &&
-      (now_us - priv->last_frame_timestamp_us <
-       ((1000000 * priv->video_format.max_framerate.denom) /
-        priv->video_format.max_framerate.num)))
+  if (!priv->pipewire_stream)
     return;
 
-  if (!priv->pipewire_stream)
+  frame_timestamp_us = get_frame_timestamp (src);
+  if (!should_record_frame (src, frame_timestamp_us))
     return;
 
   buffer = pw_stream_dequeue_buffer (priv->pipewire_stream);
@@ -467,7 +756,8 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
       return;
     }
 
-  if (meta_screen_cast_stream_src_record_frame (src, data))
+  recorded = record_frame_into (src, data);
+  if (recorded)
     {
       struct spa_meta_video_crop *spa_meta_video_crop;
 
@@ -480,17 +770,22 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
         {
           if (meta_screen_cast_stream_src_get_videocrop (src, &crop_rect))
             {
-              spa_meta_video_crop->x = crop_rect.x;
-              spa_meta_video_crop->y = crop_rect.y;
-              spa_meta_video_crop->width = crop_rect.width;
-              spa_meta_video_crop->height = crop_rect.height;
+              float scale_x, scale_y;
+
+              get_stream_scale (src, &scale_x, &scale_y);
+              spa_meta_video_crop->x = (int) floorf (crop_rect.x * scale_x);
+              spa_meta_video_crop->y = (int) floorf (crop_rect.y * scale_y);
+              spa_meta_video_crop->width =
+                (int) ceilf (crop_rect.width * scale_x);
+              spa_meta_video_crop->height =
+                (int) ceilf (crop_rect.height * scale_y);
             }
           else
             {
               spa_meta_video_crop->x = 0;
               spa_meta_video_crop->y = 0;
-              spa_meta_video_crop->width = priv->stream_width;
-              spa_meta_video_crop->height = priv->stream_height;
+              spa_meta_video_crop->width = priv->video_format.size.width;
+              spa_meta_video_crop->height = priv->video_format.size.height;
             }
         }
     }
@@ -501,12 +796,27 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
 
   maybe_record_cursor (src, spa_buffer, data);
 
-  priv->last_frame_timestamp_us = now_us;
+  spa_meta_header =
+    spa_buffer_find_meta (spa_buffer, priv->pipewire_type->meta.Header);
+  if (spa_meta_header)
+    {
+      spa_meta_header->flags = 0;
+      spa_meta_header->seq = priv->frame_sequence++;
+      spa_meta_header->pts = frame_timestamp_us * 1000;
+      spa_meta_header->dts_offset = 0;
+    }
 
   if (map)
     munmap (map, spa_buffer->datas[0].maxsize + spa_buffer->datas[0].mapoffset);
 
-  pw_stream_queue_buffer (priv->pipewire_stream, buffer);
+  if (pw_stream_queue_buffer (priv->pipewire_stream, buffer) < 0)
+    {
+      g_warning ("Failed to queue PipeWire buffer");
+      return;
+    }
+
+  if (recorded)
+    note_frame_recorded (src, frame_timestamp_us);
 }
 
 static gboolean
@@ -581,6 +891,22 @@ on_stream_state_changed (void                 *data,
     }
 }
 
+static MetaScreenCastFormat
+format_from_spa_video_format (MetaScreenCastStreamSrc *src,
+                              uint32_t                 spa_video_format)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaSpaType *spa_type = &priv->spa_type;
+
+  if (spa_video_format == spa_type->video_format.NV12)
+    return META_SCREEN_CAST_FORMAT_NV12;
+  else if (spa_video_format == spa_type->video_format.I420)
+    return META_SCREEN_CAST_FORMAT_I420;
+  else
+    return META_SCREEN_CAST_FORMAT_BGRX;
+}
+
 static void
 on_stream_format_changed (void                 *data,
                           const struct spa_pod *format)
@@ -592,8 +918,12 @@ on_stream_format_changed (void                 *data,
   uint8_t params_buffer[1024];
   int32_t width, height, stride, size;
   struct spa_pod_builder pod_builder;
-  const struct spa_pod *params[3];
-  const int bpp = 4;
+  const struct spa_pod *params[4];
+
+  g_clear_pointer (&priv->converter, meta_screen_cast_converter_free);
+  g_clear_pointer (&priv->bgrx_frame, g_free);
+  g_clear_pointer (&priv->bgrx_texture, cogl_object_unref);
+  priv->next_frame_timestamp_us = 0;
 
   if (!format)
     {
@@ -607,8 +937,24 @@ on_stream_format_changed (void                 *data,
 
   width = priv->video_format.size.width;
   height = priv->video_format.size.height;
-  stride = SPA_ROUND_UP_N (width * bpp, 4);
-  size = height * stride;
+  priv->format = format_from_spa_video_format (src,
+                                               priv->video_format.format);
+  if (!meta_screen_cast_format_supports_size (priv->format, width, height))
+    {
+      g_warning ("Unsupported screen cast stream size %dx%d", width, height);
+      pw_stream_finish_format (priv->pipewire_stream, -EINVAL, NULL, 0);
+      return;
+    }
+
+  stride = meta_screen_cast_format_get_stride (priv->format, width);
+  size = meta_screen_cast_format_get_frame_size (priv->format, width, height);
+
+  if (priv->format != META_SCREEN_CAST_FORMAT_BGRX || is_stream_scaled (src))
+    {
+      priv->converter = meta_screen_cast_converter_new (get_cogl_context (src),
+                                                        priv->format,
+                                                        width, height);
+    }
 
   pod_builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
 
@@ -632,6 +978,12 @@ on_stream_format_changed (void                 *data,
     ":", pipewire_type->param_meta.type, "I", priv->spa_type.meta_cursor,
     ":", pipewire_type->param_meta.size, "i", CURSOR_META_SIZE (64, 64));
 
+  params[3] = spa_pod_builder_object (
+    &pod_builder,
+    pipewire_type->param.idMeta, pipewire_type->param_meta.Meta,
+    ":", pipewire_type->param_meta.type, "I", pipewire_type->meta.Header,
+    ":", pipewire_type->param_meta.size, "i", sizeof (struct spa_meta_header));
+
   pw_stream_finish_format (priv->pipewire_stream, 0,
                            params, G_N_ELEMENTS (params));
 }
@@ -642,6 +994,79 @@ static const struct pw_stream_events stream_events = {
   .format_changed = on_stream_format_changed,
 };
 
+static int
+build_enum_format_params (MetaScreenCastStreamSrc *src,
+                          struct spa_pod_builder  *pod_builder,
+                          struct spa_fraction     *min_framerate,
+                          struct spa_fraction     *max_framerate,
+                          const struct spa_pod    *params[2])
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaSpaType *spa_type = &priv->spa_type;
+  struct pw_type *pipewire_type = priv->pipewire_type;
+  int width = priv->stream_width;
+  int height = priv->stream_height;
+  int n_params = 0;
+
+  /*
+   * Any size up to the source size can be picked, and the frames are then
+   * scaled down on the GPU before being read back. Picking a fixed frame
+   * rate instead of the default variable one (0/1) paces the stream to
+   * exactly that rate.
+   */
+  params[n_params++] = spa_pod_builder_object (
+    pod_builder,
+    pipewire_type->param.idEnumFormat, pipewire_type->spa_format,
+    "I", spa_type->media_type.video,
+    "I", spa_type->media_subtype.raw,
+    ":", spa_type->format_video.format, "I", spa_type->video_format.BGRx,
+    ":", spa_type->format_video.size, "Rru", &SPA_RECTANGLE (width, height),
+                                             PROP_RANGE (&SPA_RECTANGLE (1, 1),
+                                                         &SPA_RECTANGLE (width, height)),
+    ":", spa_type->format_video.framerate, "Fru", &SPA_FRACTION (0, 1),
+                                                  PROP_RANGE (&SPA_FRACTION (0, 1),
+                                                              max_framerate),
+    ":", spa_type->format_video.max_framerate, "Fru", max_framerate,
+                                                      PROP_RANGE (min_framerate,
+                                                                  max_framerate));
+
+  /*
+   * The YUV formats are only offered when the chroma planes subsample the
+   * frame evenly, so their size is stepped by two; consumers of odd sized
+   * streams have to take BGRx. The converter writes BT.601 limited range
+   * values, which is advertised so that consumers don't have to guess
+   * from the frame size.
+   */
+  if (meta_screen_cast_format_supports_size (META_SCREEN_CAST_FORMAT_NV12,
+                                             width, height))
+    {
+      params[n_params++] = spa_pod_builder_object (
+        pod_builder,
+        pipewire_type->param.idEnumFormat, pipewire_type->spa_format,
+        "I", spa_type->media_type.video,
+        "I", spa_type->media_subtype.raw,
+        ":", spa_type->format_video.format, "Ieu", spa_type->video_format.NV12,
+                                                   PROP_ENUM (2,
+                                                              spa_type->video_format.NV12,
+                                                              spa_type->video_format.I420),
+        ":", spa_type->format_video.size, "Rsu", &SPA_RECTANGLE (width, height),
+                                                 PROP_STEP (&SPA_RECTANGLE (2, 2),
+                                                            &SPA_RECTANGLE (width, height),
+                                                            &SPA_RECTANGLE (2, 2)),
+        ":", spa_type->format_video.framerate, "Fru", &SPA_FRACTION (0, 1),
+                                                      PROP_RANGE (&SPA_FRACTION (0, 1),
+                                                                  max_framerate),
+        ":", spa_type->format_video.max_framerate, "Fru", max_framerate,
+                                                          PROP_RANGE (min_framerate,
+                                                                      max_framerate),
+        ":", spa_type->format_video.color_range, "i", SPA_VIDEO_COLOR_RANGE_16_235,
+        ":", spa_type->format_video.color_matrix, "i", SPA_VIDEO_COLOR_MATRIX_BT601);
+    }
+
+  return n_params;
+}
+
 static struct pw_stream *
 create_pipewire_stream (MetaScreenCastStreamSrc  *src,
                         GError                  **error)
@@ -649,16 +1074,15 @@ create_pipewire_stream (MetaScreenCastStreamSrc  *src,
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
   struct pw_stream *pipewire_stream;
-  uint8_t buffer[1024];
+  uint8_t buffer[2048];
   struct spa_pod_builder pod_builder =
     SPA_POD_BUILDER_INIT (buffer, sizeof (buffer));
-  MetaSpaType *spa_type = &priv->spa_type;
-  struct pw_type *pipewire_type = priv->pipewire_type;
   float frame_rate;
   MetaFraction frame_rate_fraction;
   struct spa_fraction max_framerate;
   struct spa_fraction min_framerate;
-  const struct spa_pod *params[1];
+  const struct spa_pod *params[2];
+  int n_params;
   int result;
 
   pipewire_stream = pw_stream_new (priv->pipewire_remote,
@@ -682,18 +1106,9 @@ create_pipewire_stream (MetaScreenCastStreamSrc  *src,
   max_framerate = SPA_FRACTION (frame_rate_fraction.num,
                                 frame_rate_fraction.denom);
 
-  params[0] = spa_pod_builder_object (
-    &pod_builder,
-    pipewire_type->param.idEnumFormat, pipewire_type->spa_format,
-    "I", spa_type->media_type.video,
-    "I", spa_type->media_subtype.raw,
-    ":", spa_type->format_video.format, "I", spa_type->video_format.BGRx,
-    ":", spa_type->format_video.size, "R", &SPA_RECTANGLE (priv->stream_width,
-                                                           priv->stream_height),
-    ":", spa_type->format_video.framerate, "F", &SPA_FRACTION (0, 1),
-    ":", spa_type->format_video.max_framerate, "Fru", &max_framerate,
-                                                      PROP_RANGE (&min_framerate,
-                                                                  &max_framerate));
+  n_params = build_enum_format_params (src, &pod_builder,
+                                       &min_framerate, &max_framerate,
+                                       params);
 
   pw_stream_add_listener (pipewire_stream,
                           &priv->pipewire_stream_listener,
@@ -705,7 +1120,7 @@ create_pipewire_stream (MetaScreenCastStreamSrc  *src,
                               NULL,
                               (PW_STREAM_FLAG_DRIVER |
                                PW_STREAM_FLAG_MAP_BUFFERS),
-                              params, G_N_ELEMENTS (params));
+                              params, n_params);
   if (result != 0)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
@@ -912,6 +1327,9 @@ meta_screen_cast_stream_src_finalize (GObject *object)
     meta_screen_cast_stream_src_disable (src);
 
   g_clear_pointer (&priv->pipewire_stream, pw_stream_destroy);
+  g_clear_pointer (&priv->converter, meta_screen_cast_converter_free);
+  g_clear_pointer (&priv->bgrx_frame, g_free);
+  g_clear_pointer (&priv->bgrx_texture, cogl_object_unref);
   g_clear_pointer (&priv->pipewire_remote, pw_remote_destroy);
   g_clear_pointer (&priv->pipewire_core, pw_core_destroy);
   g_source_destroy (&priv->pipewire_source->base);
@@ -34,6 +34,11 @@ struct _MetaScreenCastWindowStreamSrc
 
   MetaScreenCastWindow *screen_cast_window;
 
+  CoglOffscreen *offscreen;
+  gboolean offscreen_valid;
+
+  guint frame_callbacks_source_id;
+
   unsigned long screen_cast_window_damaged_handler_id;
   unsigned long screen_cast_window_destroyed_handler_id;
   unsigned long cursor_moved_handler_id;
@@ -178,6 +183,88 @@ maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
   cairo_surface_destroy (cursor_surface);
 }
 
+static CoglContext *
+get_cogl_context (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaBackend *backend = get_backend (window_src);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static gboolean
+ensure_offscreen (MetaScreenCastWindowStreamSrc  *window_src,
+                  GError                        **error)
+{
+  CoglTexture2D *texture;
+  CoglOffscreen *offscreen;
+
+  if (window_src->offscreen)
+    return TRUE;
+
+  texture = cogl_texture_2d_new_with_size (get_cogl_context (window_src),
+                                           get_stream_width (window_src),
+                                           get_stream_height (window_src));
+  cogl_primitive_texture_set_auto_mipmap (COGL_PRIMITIVE_TEXTURE (texture),
+                                          FALSE);
+  if (!cogl_texture_allocate (COGL_TEXTURE (texture), error))
+    {
+      cogl_object_unref (texture);
+      return FALSE;
+    }
+
+  offscreen = cogl_offscreen_new_with_texture (COGL_TEXTURE (texture));
+  cogl_object_unref (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    {
+      cogl_object_unref (offscreen);
+      return FALSE;
+    }
+
+  window_src->offscreen = offscreen;
+
+  return TRUE;
+}
+
+/*
+ * Paints the window into the cached offscreen, unless nothing has been
+ * committed since the last time, e.g. when only the cursor moved.
+ */
+static gboolean
+blit_window (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaRectangle stream_rect;
+  GError *error = NULL;
+
+  if (!window_src->screen_cast_window)
+    return FALSE;
+
+  if (!ensure_offscreen (window_src, &error))
+    {
+      g_warning ("Failed to allocate window screen cast framebuffer: %s",
+                 error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  if (window_src->offscreen_valid)
+    return TRUE;
+
+  stream_rect.x = 0;
+  stream_rect.y = 0;
+  stream_rect.width = get_stream_width (window_src);
+  stream_rect.height = get_stream_height (window_src);
+
+  if (!meta_screen_cast_window_blit_to_framebuffer (window_src->screen_cast_window,
+                                                    &stream_rect,
+                                                    COGL_FRAMEBUFFER (window_src->offscreen)))
+    return FALSE;
+
+  window_src->offscreen_valid = TRUE;
+
+  return TRUE;
+}
+
 static gboolean
 capture_into (MetaScreenCastWindowStreamSrc *window_src,
               uint8_t                       *data)
@@ -191,8 +278,19 @@ capture_into (MetaScreenCastWindowStreamSrc *window_src,
   stream_rect.width = get_stream_width (window_src);
   stream_rect.height = get_stream_height (window_src);
 
-  meta_screen_cast_window_capture_into (window_src->screen_cast_window,
-                                        &stream_rect, data);
+  if (blit_window (window_src))
+    {
+      cogl_framebuffer_read_pixels (COGL_FRAMEBUFFER (window_src->offscreen),
+                                    0, 0,
+                                    stream_rect.width, stream_rect.height,
+                                    CLUTTER_CAIRO_FORMAT_ARGB32,
+                                    data);
+    }
+  else
+    {
+      meta_screen_cast_window_capture_into (window_src->screen_cast_window,
+                                            &stream_rect, data);
+    }
 
   stream = meta_screen_cast_stream_src_get_stream (src);
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
@@ -261,6 +359,56 @@ meta_screen_cast_window_stream_src_stop (MetaScreenCastWindowStreamSrc *window_s
                           cursor_tracker);
   g_clear_signal_handler (&window_src->cursor_changed_handler_id,
                           cursor_tracker);
+  g_clear_handle_id (&window_src->frame_callbacks_source_id, g_source_remove);
+}
+
+static gboolean
+send_frame_callbacks (gpointer user_data)
+{
+  MetaScreenCastWindowStreamSrc *window_src = user_data;
+
+  /* Keep waiting while the window is still going to be painted. */
+  if (window_src->screen_cast_window &&
+      meta_screen_cast_window_send_hidden_frame_callbacks (window_src->screen_cast_window))
+    return G_SOURCE_CONTINUE;
+
+  window_src->frame_callbacks_source_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static unsigned int
+get_frame_callbacks_interval_ms (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  int64_t frame_interval_us;
+
+  /* Until a format is negotiated, use the frame rate of get_specs() */
+  frame_interval_us = meta_screen_cast_stream_src_get_frame_interval_us (src);
+  if (frame_interval_us == 0)
+    return 1000 / 60;
+
+  return MAX (1, frame_interval_us / 1000);
+}
+
+/*
+ * Occluded or hidden windows are not painted, so their clients are not told
+ * to draw the next frame. When asked to, give them their frame callbacks at
+ * the stream frame rate instead, so the stream keeps being updated.
+ */
+static void
+maybe_schedule_frame_callbacks (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastWindowStream *window_stream = get_window_stream (window_src);
+
+  if (!meta_screen_cast_window_stream_get_capture_occluded (window_stream))
+    return;
+
+  if (window_src->frame_callbacks_source_id)
+    return;
+
+  window_src->frame_callbacks_source_id =
+    g_timeout_add (get_frame_callbacks_interval_ms (window_src),
+                   send_frame_callbacks, window_src);
 }
 
 static void
@@ -269,7 +417,10 @@ screen_cast_window_damaged (MetaWindowActor               *actor,
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
 
+  window_src->offscreen_valid = FALSE;
+
   meta_screen_cast_stream_src_maybe_record_frame (src);
+  maybe_schedule_frame_callbacks (window_src);
 }
 
 static void
@@ -378,6 +529,9 @@ meta_screen_cast_window_stream_src_enable (MetaScreenCastStreamSrc *src)
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
       break;
     }
+
+  window_src->offscreen_valid = FALSE;
+  maybe_schedule_frame_callbacks (window_src);
 }
 
 static void
@@ -401,6 +555,27 @@ meta_screen_cast_window_stream_src_record_frame (MetaScreenCastStreamSrc *src,
   return TRUE;
 }
 
+static CoglTexture *
+meta_screen_cast_window_stream_src_record_texture (MetaScreenCastStreamSrc  *src,
+                                                   GError                  **error)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+
+  /* The embedded cursor is drawn on the CPU. */
+  if (meta_screen_cast_stream_get_cursor_mode (stream) ==
+      META_SCREEN_CAST_CURSOR_MODE_EMBEDDED ||
+      !blit_window (window_src))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Window can't be captured as a texture");
+      return NULL;
+    }
+
+  return cogl_object_ref (cogl_offscreen_get_texture (window_src->offscreen));
+}
+
 static void
 meta_screen_cast_window_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *src,
                                                         struct spa_meta_cursor  *spa_meta_cursor)
@@ -469,6 +644,18 @@ meta_screen_cast_window_stream_src_new (MetaScreenCastWindowStream  *window_stre
                          NULL);
 }
 
+static void
+meta_screen_cast_window_stream_src_finalize (GObject *object)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (object);
+
+  g_clear_handle_id (&window_src->frame_callbacks_source_id, g_source_remove);
+  g_clear_pointer (&window_src->offscreen, cogl_object_unref);
+
+  G_OBJECT_CLASS (meta_screen_cast_window_stream_src_parent_class)->finalize (object);
+}
+
 static void
 meta_screen_cast_window_stream_src_init (MetaScreenCastWindowStreamSrc *window_src)
 {
@@ -478,13 +665,17 @@ meta_screen_cast_window_stream_src_init (MetaScreenCastWindowStreamSrc *window_s
 static void
 meta_screen_cast_window_stream_src_class_init (MetaScreenCastWindowStreamSrcClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   MetaScreenCastStreamSrcClass *src_class =
     META_SCREEN_CAST_STREAM_SRC_CLASS (klass);
 
+  object_class->finalize = meta_screen_cast_window_stream_src_finalize;
+
   src_class->get_specs = meta_screen_cast_window_stream_src_get_specs;
   src_class->enable = meta_screen_cast_window_stream_src_enable;
   src_class->disable = meta_screen_cast_window_stream_src_disable;
   src_class->record_frame = meta_screen_cast_window_stream_src_record_frame;
+  src_class->record_texture = meta_screen_cast_window_stream_src_record_texture;
   src_class->get_videocrop = meta_screen_cast_window_stream_src_get_videocrop;
   src_class->set_cursor_metadata = meta_screen_cast_window_stream_src_set_cursor_metadata;
 }
@@ -34,6 +34,7 @@ enum
   PROP_0,
 
   PROP_WINDOW,
+  PROP_CAPTURE_OCCLUDED,
 };
 
 struct _MetaScreenCastWindowStream
@@ -41,6 +42,7 @@ struct _MetaScreenCastWindowStream
   MetaScreenCastStream parent;
 
   MetaWindow *window;
+  gboolean capture_occluded;
 
   int stream_width;
   int stream_height;
@@ -79,11 +81,18 @@ meta_screen_cast_window_stream_get_height (MetaScreenCastWindowStream *window_st
   return window_stream->stream_height;
 }
 
+gboolean
+meta_screen_cast_window_stream_get_capture_occluded (MetaScreenCastWindowStream *window_stream)
+{
+  return window_stream->capture_occluded;
+}
+
 MetaScreenCastWindowStream *
 meta_screen_cast_window_stream_new (MetaScreenCastSession     *session,
                                     GDBusConnection           *connection,
                                     MetaWindow                *window,
                                     MetaScreenCastCursorMode   cursor_mode,
+                                    gboolean                   capture_occluded,
                                     GError                   **error)
 {
   return g_initable_new (META_TYPE_SCREEN_CAST_WINDOW_STREAM,
@@ -93,6 +102,7 @@ meta_screen_cast_window_stream_new (MetaScreenCastSession     *session,
                          "connection", connection,
                          "cursor-mode", cursor_mode,
                          "window", window,
+                         "capture-occluded", capture_occluded,
                          NULL);
 }
 
@@ -165,6 +175,9 @@ meta_screen_cast_window_stream_set_property (GObject      *object,
     case PROP_WINDOW:
       window_stream->window = g_value_get_object (value);
       break;
+    case PROP_CAPTURE_OCCLUDED:
+      window_stream->capture_occluded = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -184,6 +197,9 @@ meta_screen_cast_window_stream_get_property (GObject    *object,
     case PROP_WINDOW:
       g_value_set_object (value, window_stream->window);
       break;
+    case PROP_CAPTURE_OCCLUDED:
+      g_value_set_boolean (value, window_stream->capture_occluded);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -279,4 +295,14 @@ meta_screen_cast_window_stream_class_init (MetaScreenCastWindowStreamClass *klas
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_CONSTRUCT_ONLY |
                                                         G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (object_class,
+                                   PROP_CAPTURE_OCCLUDED,
+                                   g_param_spec_boolean ("capture-occluded",
+                                                         "capture-occluded",
+                                                         "Capture while occluded",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_CONSTRUCT_ONLY |
+                                                         G_PARAM_STATIC_STRINGS));
 }
@@ -36,10 +36,12 @@ MetaScreenCastWindowStream * meta_screen_cast_window_stream_new (MetaScreenCastS
                                                                  GDBusConnection           *connection,
                                                                  MetaWindow                *window,
                                                                  MetaScreenCastCursorMode   cursor_mode,
+                                                                 gboolean                   capture_occluded,
                                                                  GError                   **error);
 
 MetaWindow  * meta_screen_cast_window_stream_get_window (MetaScreenCastWindowStream *window_stream);
 int           meta_screen_cast_window_stream_get_width  (MetaScreenCastWindowStream *window_stream);
 int           meta_screen_cast_window_stream_get_height (MetaScreenCastWindowStream *window_stream);
+gboolean      meta_screen_cast_window_stream_get_capture_occluded (MetaScreenCastWindowStream *window_stream);
 
 #endif /* META_SCREEN_CAST_WINDOW_STREAM_H */
@@ -86,3 +86,25 @@ meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window)
 
   return iface->has_damage (screen_cast_window);
 }
+
+gboolean
+meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
+                                             MetaRectangle        *bounds,
+                                             CoglFramebuffer      *framebuffer)
+{
+  MetaScreenCastWindowInterface *iface =
+    META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window);
+
+  return iface->blit_to_framebuffer (screen_cast_window,
+                                     bounds,
+                                     framebuffer);
+}
+
+gboolean
+meta_screen_cast_window_send_hidden_frame_callbacks (MetaScreenCastWindow *screen_cast_window)
+{
+  MetaScreenCastWindowInterface *iface =
+    META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window);
+
+  return iface->send_hidden_frame_callbacks (screen_cast_window);
+}
@@ -25,6 +25,7 @@
 #include <glib-object.h>
 
 #include "backends/meta-cursor.h"
+#include "cogl/cogl.h"
 #include "meta/boxes.h"
 
 G_BEGIN_DECLS
@@ -57,6 +58,12 @@ struct _MetaScreenCastWindowInterface
                         uint8_t              *data);
 
   gboolean (*has_damage) (MetaScreenCastWindow *screen_cast_window);
+
+  gboolean (*blit_to_framebuffer) (MetaScreenCastWindow *screen_cast_window,
+                                   MetaRectangle        *bounds,
+                                   CoglFramebuffer      *framebuffer);
+
+  gboolean (*send_hidden_frame_callbacks) (MetaScreenCastWindow *screen_cast_window);
 };
 
 void meta_screen_cast_window_get_frame_bounds (MetaScreenCastWindow *screen_cast_window,
@@ -80,6 +87,12 @@ void meta_screen_cast_window_capture_into (MetaScreenCastWindow *screen_cast_win
 
 gboolean meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window);
 
+gboolean meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
+                                                      MetaRectangle        *bounds,
+                                                      CoglFramebuffer      *framebuffer);
+
+gboolean meta_screen_cast_window_send_hidden_frame_callbacks (MetaScreenCastWindow *screen_cast_window);
+
 G_END_DECLS
 
 #endif /* META_SCREEN_CAST_WINDOW_H */
@@ -32,7 +32,7 @@
 
 #define META_SCREEN_CAST_DBUS_SERVICE "org.gnome.Mutter.ScreenCast"
 #define META_SCREEN_CAST_DBUS_PATH "/org/gnome/Mutter/ScreenCast"
-#define META_SCREEN_CAST_API_VERSION 2
+#define META_SCREEN_CAST_API_VERSION 3
 
 struct _MetaScreenCast
 {
@@ -44,6 +44,8 @@ struct _MetaScreenCast
 
   MetaDbusSessionWatcher *session_watcher;
   MetaBackend *backend;
+
+  MetaScreenCastCaptureCache *capture_cache;
 };
 
 static void
@@ -69,6 +71,12 @@ meta_screen_cast_get_backend (MetaScreenCast *screen_cast)
   return screen_cast->backend;
 }
 
+MetaScreenCastCaptureCache *
+meta_screen_cast_get_capture_cache (MetaScreenCast *screen_cast)
+{
+  return screen_cast->capture_cache;
+}
+
 static gboolean
 register_remote_desktop_screen_cast_session (MetaScreenCastSession  *session,
                                              const char             *remote_desktop_session_id,
@@ -249,6 +257,9 @@ meta_screen_cast_finalize (GObject *object)
       meta_screen_cast_session_close (session);
     }
 
+  g_clear_pointer (&screen_cast->capture_cache,
+                   meta_screen_cast_capture_cache_free);
+
   G_OBJECT_CLASS (meta_screen_cast_parent_class)->finalize (object);
 }
 
@@ -261,6 +272,7 @@ meta_screen_cast_new (MetaBackend            *backend,
   screen_cast = g_object_new (META_TYPE_SCREEN_CAST, NULL);
   screen_cast->backend = backend;
   screen_cast->session_watcher = session_watcher;
+  screen_cast->capture_cache = meta_screen_cast_capture_cache_new (backend);
 
   return screen_cast;
 }
@@ -30,6 +30,8 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 
+#include "cogl/cogl.h"
+
 #define INVALID_FB_ID 0U
 
 struct _MetaDrmBufferGbm
@@ -44,7 +46,13 @@ struct _MetaDrmBufferGbm
   uint32_t fb_id;
 };
 
-G_DEFINE_TYPE (MetaDrmBufferGbm, meta_drm_buffer_gbm, META_TYPE_DRM_BUFFER)
+static void
+cogl_scanout_iface_init (CoglScanoutInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MetaDrmBufferGbm, meta_drm_buffer_gbm,
+                         META_TYPE_DRM_BUFFER,
+                         G_IMPLEMENT_INTERFACE (COGL_TYPE_SCANOUT,
+                                                cogl_scanout_iface_init))
 
 struct gbm_bo *
 meta_drm_buffer_gbm_get_bo (MetaDrmBufferGbm *buffer_gbm)
@@ -53,9 +61,10 @@ meta_drm_buffer_gbm_get_bo (MetaDrmBufferGbm *buffer_gbm)
 }
 
 static gboolean
-acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
-                        gboolean           use_modifiers,
-                        GError           **error)
+init_fb_id (MetaDrmBufferGbm  *buffer_gbm,
+            struct gbm_bo     *bo,
+            gboolean           use_modifiers,
+            GError           **error)
 {
   uint32_t handles[4] = {0, 0, 0, 0};
   uint32_t strides[4] = {0, 0, 0, 0};
@@ -63,21 +72,10 @@ acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
   uint64_t modifiers[4] = {0, 0, 0, 0};
   uint32_t width, height;
   uint32_t format;
-  struct gbm_bo *bo;
   int kms_fd;
 
   kms_fd = meta_gpu_kms_get_fd (buffer_gbm->gpu_kms);
 
-  bo = gbm_surface_lock_front_buffer (buffer_gbm->surface);
-  if (!bo)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "gbm_surface_lock_front_buffer failed");
-      return FALSE;
-    }
-
   if (gbm_bo_get_handle_for_plane (bo, 0).s32 == -1)
     {
       /* Failed to fetch handle to plane, falling back to old method */
@@ -120,7 +118,6 @@ acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
                        g_io_error_from_errno (errno),
                        "drmModeAddFB2WithModifiers failed: %s",
                        g_strerror (errno));
-          gbm_surface_release_buffer (buffer_gbm->surface, bo);
           return FALSE;
         }
     }
@@ -141,7 +138,6 @@ acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
                        G_IO_ERROR_FAILED,
                        "drmModeAddFB does not support format 0x%x",
                        format);
-          gbm_surface_release_buffer (buffer_gbm->surface, bo);
           return FALSE;
         }
 
@@ -159,11 +155,36 @@ acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
                        g_io_error_from_errno (errno),
                        "drmModeAddFB failed: %s",
                        g_strerror (errno));
-          gbm_surface_release_buffer (buffer_gbm->surface, bo);
           return FALSE;
         }
     }
 
+  return TRUE;
+}
+
+static gboolean
+acquire_swapped_buffer (MetaDrmBufferGbm  *buffer_gbm,
+                        gboolean           use_modifiers,
+                        GError           **error)
+{
+  struct gbm_bo *bo;
+
+  bo = gbm_surface_lock_front_buffer (buffer_gbm->surface);
+  if (!bo)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "gbm_surface_lock_front_buffer failed");
+      return FALSE;
+    }
+
+  if (!init_fb_id (buffer_gbm, bo, use_modifiers, error))
+    {
+      gbm_surface_release_buffer (buffer_gbm->surface, bo);
+      return FALSE;
+    }
+
   buffer_gbm->bo = bo;
 
   return TRUE;
@@ -190,6 +211,35 @@ meta_drm_buffer_gbm_new (MetaGpuKms          *gpu_kms,
   return buffer_gbm;
 }
 
+/*
+ * meta_drm_buffer_gbm_new_take:
+ *
+ * Creates a buffer for scanning out @bo, which is not backed by a
+ * gbm_surface. On success, ownership of @bo is transferred to the returned
+ * buffer; on failure, the caller keeps it.
+ */
+MetaDrmBufferGbm *
+meta_drm_buffer_gbm_new_take (MetaGpuKms     *gpu_kms,
+                              struct gbm_bo  *bo,
+                              gboolean        use_modifiers,
+                              GError        **error)
+{
+  MetaDrmBufferGbm *buffer_gbm;
+
+  buffer_gbm = g_object_new (META_TYPE_DRM_BUFFER_GBM, NULL);
+  buffer_gbm->gpu_kms = gpu_kms;
+
+  if (!init_fb_id (buffer_gbm, bo, use_modifiers, error))
+    {
+      g_object_unref (buffer_gbm);
+      return NULL;
+    }
+
+  buffer_gbm->bo = bo;
+
+  return buffer_gbm;
+}
+
 static uint32_t
 meta_drm_buffer_gbm_get_fb_id (MetaDrmBuffer *buffer)
 {
@@ -210,11 +260,21 @@ meta_drm_buffer_gbm_finalize (GObject *object)
     }
 
   if (buffer_gbm->bo)
-    gbm_surface_release_buffer (buffer_gbm->surface, buffer_gbm->bo);
+    {
+      if (buffer_gbm->surface)
+        gbm_surface_release_buffer (buffer_gbm->surface, buffer_gbm->bo);
+      else
+        gbm_bo_destroy (buffer_gbm->bo);
+    }
 
   G_OBJECT_CLASS (meta_drm_buffer_gbm_parent_class)->finalize (object);
 }
 
+static void
+cogl_scanout_iface_init (CoglScanoutInterface *iface)
+{
+}
+
 static void
 meta_drm_buffer_gbm_init (MetaDrmBufferGbm *buffer_gbm)
 {
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/native/meta-drm-buffer-import.h"
+
+#include <drm_fourcc.h>
+#include <errno.h>
+#include <gio/gio.h>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#define INVALID_FB_ID 0U
+
+struct _MetaDrmBufferImport
+{
+  MetaDrmBuffer parent;
+
+  MetaGpuKms *gpu_kms;
+
+  struct gbm_bo *imported_bo;
+
+  uint32_t fb_id;
+};
+
+G_DEFINE_TYPE (MetaDrmBufferImport, meta_drm_buffer_import,
+               META_TYPE_DRM_BUFFER)
+
+static gboolean
+import_gbm_bo (MetaDrmBufferImport  *buffer_import,
+               struct gbm_device    *importer,
+               struct gbm_bo        *primary_bo,
+               GError              **error)
+{
+  struct gbm_import_fd_data import_data;
+  uint32_t handles[4] = { 0, 0, 0, 0 };
+  uint32_t strides[4] = { 0, 0, 0, 0 };
+  uint32_t offsets[4] = { 0, 0, 0, 0 };
+  struct gbm_bo *imported_bo;
+  int dmabuf_fd;
+  int kms_fd;
+
+  if (gbm_bo_get_plane_count (primary_bo) != 1 ||
+      gbm_bo_get_modifier (primary_bo) != DRM_FORMAT_MOD_LINEAR)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Only single plane linear buffers can be imported");
+      return FALSE;
+    }
+
+  dmabuf_fd = gbm_bo_get_fd (primary_bo);
+  if (dmabuf_fd == -1)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "gbm_bo_get_fd failed: %s", g_strerror (errno));
+      return FALSE;
+    }
+
+  import_data = (struct gbm_import_fd_data) {
+    .fd = dmabuf_fd,
+    .width = gbm_bo_get_width (primary_bo),
+    .height = gbm_bo_get_height (primary_bo),
+    .stride = gbm_bo_get_stride (primary_bo),
+    .format = gbm_bo_get_format (primary_bo),
+  };
+
+  imported_bo = gbm_bo_import (importer,
+                               GBM_BO_IMPORT_FD,
+                               &import_data,
+                               GBM_BO_USE_SCANOUT);
+  close (dmabuf_fd);
+
+  if (!imported_bo)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "gbm_bo_import failed");
+      return FALSE;
+    }
+
+  handles[0] = gbm_bo_get_handle (imported_bo).u32;
+  strides[0] = gbm_bo_get_stride (imported_bo);
+  offsets[0] = 0;
+
+  kms_fd = meta_gpu_kms_get_fd (buffer_import->gpu_kms);
+  if (drmModeAddFB2 (kms_fd,
+                     gbm_bo_get_width (imported_bo),
+                     gbm_bo_get_height (imported_bo),
+                     gbm_bo_get_format (imported_bo),
+                     handles,
+                     strides,
+                     offsets,
+                     &buffer_import->fb_id,
+                     0))
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "drmModeAddFB2 failed: %s", g_strerror (errno));
+      gbm_bo_destroy (imported_bo);
+      return FALSE;
+    }
+
+  buffer_import->imported_bo = imported_bo;
+
+  return TRUE;
+}
+
+MetaDrmBufferImport *
+meta_drm_buffer_import_new (MetaGpuKms          *gpu_kms,
+                            struct gbm_device   *importer,
+                            struct gbm_bo       *primary_bo,
+                            GError             **error)
+{
+  MetaDrmBufferImport *buffer_import;
+
+  buffer_import = g_object_new (META_TYPE_DRM_BUFFER_IMPORT, NULL);
+  buffer_import->gpu_kms = gpu_kms;
+
+  if (!import_gbm_bo (buffer_import, importer, primary_bo, error))
+    {
+      g_object_unref (buffer_import);
+      return NULL;
+    }
+
+  return buffer_import;
+}
+
+static uint32_t
+meta_drm_buffer_import_get_fb_id (MetaDrmBuffer *buffer)
+{
+  return META_DRM_BUFFER_IMPORT (buffer)->fb_id;
+}
+
+static void
+meta_drm_buffer_import_finalize (GObject *object)
+{
+  MetaDrmBufferImport *buffer_import = META_DRM_BUFFER_IMPORT (object);
+
+  if (buffer_import->fb_id != INVALID_FB_ID)
+    {
+      int kms_fd;
+
+      kms_fd = meta_gpu_kms_get_fd (buffer_import->gpu_kms);
+      drmModeRmFB (kms_fd, buffer_import->fb_id);
+    }
+
+  g_clear_pointer (&buffer_import->imported_bo, gbm_bo_destroy);
+
+  G_OBJECT_CLASS (meta_drm_buffer_import_parent_class)->finalize (object);
+}
+
+static void
+meta_drm_buffer_import_init (MetaDrmBufferImport *buffer_import)
+{
+}
+
+static void
+meta_drm_buffer_import_class_init (MetaDrmBufferImportClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaDrmBufferClass *buffer_class = META_DRM_BUFFER_CLASS (klass);
+
+  object_class->finalize = meta_drm_buffer_import_finalize;
+
+  buffer_class->get_fb_id = meta_drm_buffer_import_get_fb_id;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef META_DRM_BUFFER_IMPORT_H
+#define META_DRM_BUFFER_IMPORT_H
+
+#include <gbm.h>
+
+#include "backends/native/meta-drm-buffer.h"
+#include "backends/native/meta-gpu-kms.h"
+
+#define META_TYPE_DRM_BUFFER_IMPORT (meta_drm_buffer_import_get_type ())
+G_DECLARE_FINAL_TYPE (MetaDrmBufferImport,
+                      meta_drm_buffer_import,
+                      META, DRM_BUFFER_IMPORT,
+                      MetaDrmBuffer)
+
+/*
+ * MetaDrmBufferImport is a buffer that refers to the storage of a gbm_bo
+ * allocated on another GPU, imported into @gpu_kms as a framebuffer, so it
+ * can be scanned out directly by @gpu_kms without any copy. It does not keep
+ * @primary_bo alive; the caller must make sure the imported buffer is not
+ * scanned out after @primary_bo has been released or reused.
+ */
+MetaDrmBufferImport * meta_drm_buffer_import_new (MetaGpuKms          *gpu_kms,
+                                                  struct gbm_device   *importer,
+                                                  struct gbm_bo       *primary_bo,
+                                                  GError             **error);
+
+#endif /* META_DRM_BUFFER_IMPORT_H */
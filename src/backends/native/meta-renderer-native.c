@@ -37,6 +37,7 @@
 
 #include "config.h"
 
+#include <cairo.h>
 #include <drm_fourcc.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -60,6 +61,7 @@
 #include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-drm-buffer-dumb.h"
 #include "backends/native/meta-drm-buffer-gbm.h"
+#include "backends/native/meta-drm-buffer-import.h"
 #include "backends/native/meta-drm-buffer.h"
 #include "backends/native/meta-gpu-kms.h"
 #include "backends/native/meta-kms-update.h"
@@ -105,6 +107,16 @@ typedef enum _MetaSharedFramebufferCopyMode
   META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY
 } MetaSharedFramebufferCopyMode;
 
+typedef enum _MetaSharedFramebufferImportStatus
+{
+  /* Not tried importing yet. */
+  META_SHARED_FRAMEBUFFER_IMPORT_STATUS_NONE,
+  /* Tried before and failed. */
+  META_SHARED_FRAMEBUFFER_IMPORT_STATUS_FAILED,
+  /* Tried before and succeeded. */
+  META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK
+} MetaSharedFramebufferImportStatus;
+
 typedef struct _MetaRendererNativeGpuData
 {
   MetaRendererNative *renderer_native;
@@ -148,6 +160,11 @@ typedef struct _MetaDumbBuffer
   int stride_bytes;
   uint32_t drm_format;
   int dmabuf_fd;
+
+  /* Primary GPU framebuffer wrapping the dumb buffer, created on demand. */
+  CoglFramebuffer *cogl_fbo;
+  /* Area that no longer matches the content of the shared framebuffer. */
+  cairo_region_t *stale_region;
 } MetaDumbBuffer;
 
 typedef struct _MetaOnscreenNativeSecondaryGpuState
@@ -172,6 +189,11 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
 
   gboolean noted_primary_gpu_copy_ok;
   gboolean noted_primary_gpu_copy_failed;
+  MetaSharedFramebufferImportStatus import_status;
+  /* struct gbm_bo of the onscreen -> MetaDrmBufferImport */
+  GHashTable *imported_buffers;
+
+  MetaSharedFramebufferCopyStats stats;
 } MetaOnscreenNativeSecondaryGpuState;
 
 typedef struct _MetaOnscreenNative
@@ -740,6 +762,8 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
   free_current_secondary_bo (gpu_kms, secondary_gpu_state);
   free_next_secondary_bo (gpu_kms, secondary_gpu_state);
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
+  g_clear_pointer (&secondary_gpu_state->imported_buffers,
+                   g_hash_table_destroy);
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     {
@@ -749,6 +773,19 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
         release_dumb_fb (dumb_fb, gpu_kms);
     }
 
+  g_debug ("Shared framebuffer copies for %s: "
+           "%" G_GUINT64_FORMAT " zero-copy, "
+           "%" G_GUINT64_FORMAT " secondary GPU, "
+           "%" G_GUINT64_FORMAT " primary GPU, "
+           "%" G_GUINT64_FORMAT " CPU frames, "
+           "%" G_GUINT64_FORMAT " pixels copied",
+           meta_gpu_kms_get_file_path (gpu_kms),
+           secondary_gpu_state->stats.n_zero_copy_frames,
+           secondary_gpu_state->stats.n_secondary_gpu_copy_frames,
+           secondary_gpu_state->stats.n_primary_gpu_copy_frames,
+           secondary_gpu_state->stats.n_cpu_copy_frames,
+           secondary_gpu_state->stats.n_copied_pixels);
+
   g_free (secondary_gpu_state);
 }
 
@@ -974,17 +1011,11 @@ static void
 free_current_secondary_bo (MetaGpuKms                          *gpu_kms,
                            MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
-  MetaRendererNativeGpuData *renderer_gpu_data;
-
-  renderer_gpu_data = secondary_gpu_state->renderer_gpu_data;
-  switch (renderer_gpu_data->secondary.copy_mode)
-    {
-    case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
-      g_clear_object (&secondary_gpu_state->gbm.current_fb);
-      break;
-    case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
-      break;
-    }
+  /*
+   * Regardless of the copy mode, the buffer may be an imported primary GPU
+   * buffer, which must be released to unlock it.
+   */
+  g_clear_object (&secondary_gpu_state->gbm.current_fb);
 }
 
 static void
@@ -1465,17 +1496,11 @@ static void
 free_next_secondary_bo (MetaGpuKms                          *gpu_kms,
                         MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
-  MetaRendererNativeGpuData *renderer_gpu_data;
-
-  renderer_gpu_data = secondary_gpu_state->renderer_gpu_data;
-  switch (renderer_gpu_data->secondary.copy_mode)
-    {
-    case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
-      g_clear_object (&secondary_gpu_state->gbm.next_fb);
-      break;
-    case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
-      break;
-    }
+  /*
+   * Regardless of the copy mode, the buffer may be an imported primary GPU
+   * buffer, which must be released to unlock it.
+   */
+  g_clear_object (&secondary_gpu_state->gbm.next_fb);
 }
 
 #ifdef HAVE_EGL_DEVICE
@@ -1838,6 +1863,147 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
       g_error_free (error);
       return;
     }
+
+  secondary_gpu_state->stats.n_secondary_gpu_copy_frames++;
+  secondary_gpu_state->stats.n_copied_pixels +=
+    gbm_bo_get_width (bo) * gbm_bo_get_height (bo);
+}
+
+static gboolean
+import_shared_framebuffer (CoglOnscreen                        *onscreen,
+                           MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaRendererNativeGpuData *renderer_gpu_data =
+    secondary_gpu_state->renderer_gpu_data;
+  MetaDrmBufferImport *buffer_import;
+  struct gbm_bo *primary_bo;
+  g_autoptr (GError) error = NULL;
+
+  if (secondary_gpu_state->import_status ==
+      META_SHARED_FRAMEBUFFER_IMPORT_STATUS_FAILED)
+    return FALSE;
+
+  if (!renderer_gpu_data->gbm.device ||
+      !META_IS_DRM_BUFFER_GBM (onscreen_native->gbm.next_fb))
+    {
+      secondary_gpu_state->import_status =
+        META_SHARED_FRAMEBUFFER_IMPORT_STATUS_FAILED;
+      return FALSE;
+    }
+
+  /*
+   * The buffers of the onscreen gbm surface are recycled and only destroyed
+   * together with the surface, so an import is done once per buffer and
+   * kept until the secondary GPU state goes away. The onscreen keeps the
+   * primary buffer locked for as long as the secondary GPU scans out its
+   * import, as both are swapped in lockstep.
+   */
+  primary_bo =
+    meta_drm_buffer_gbm_get_bo (META_DRM_BUFFER_GBM (onscreen_native->gbm.next_fb));
+
+  if (!secondary_gpu_state->imported_buffers)
+    {
+      secondary_gpu_state->imported_buffers =
+        g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+    }
+
+  buffer_import = g_hash_table_lookup (secondary_gpu_state->imported_buffers,
+                                       primary_bo);
+  if (!buffer_import)
+    {
+      buffer_import =
+        meta_drm_buffer_import_new (secondary_gpu_state->gpu_kms,
+                                    renderer_gpu_data->gbm.device,
+                                    primary_bo,
+                                    &error);
+      if (!buffer_import)
+        {
+          g_debug ("Zero-copy disabled for %s, import failed: %s",
+                   meta_gpu_kms_get_file_path (secondary_gpu_state->gpu_kms),
+                   error->message);
+          secondary_gpu_state->import_status =
+            META_SHARED_FRAMEBUFFER_IMPORT_STATUS_FAILED;
+          return FALSE;
+        }
+
+      g_hash_table_insert (secondary_gpu_state->imported_buffers,
+                           primary_bo, buffer_import);
+    }
+
+  if (secondary_gpu_state->import_status ==
+      META_SHARED_FRAMEBUFFER_IMPORT_STATUS_NONE)
+    {
+      g_debug ("Using zero-copy for %s succeeded once.",
+               meta_gpu_kms_get_file_path (secondary_gpu_state->gpu_kms));
+    }
+
+  secondary_gpu_state->import_status = META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK;
+
+  g_clear_object (&secondary_gpu_state->gbm.next_fb);
+  secondary_gpu_state->gbm.next_fb =
+    META_DRM_BUFFER (g_object_ref (buffer_import));
+  secondary_gpu_state->stats.n_zero_copy_frames++;
+
+  return TRUE;
+}
+
+static void
+invalidate_dumb_buffer (MetaDumbBuffer *dumb_fb)
+{
+  cairo_rectangle_int_t rect = {
+    .width = dumb_fb->width,
+    .height = dumb_fb->height,
+  };
+
+  cairo_region_union_rectangle (dumb_fb->stale_region, &rect);
+}
+
+static void
+add_secondary_gpu_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                          const int                           *rectangles,
+                          int                                  n_rectangles)
+{
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
+    {
+      MetaDumbBuffer *dumb_fb = &secondary_gpu_state->cpu.dumb_fbs[i];
+      cairo_region_t *damage;
+      int j;
+
+      if (!dumb_fb->map)
+        continue;
+
+      if (n_rectangles == 0)
+        {
+          invalidate_dumb_buffer (dumb_fb);
+          continue;
+        }
+
+      damage = cairo_region_create ();
+      for (j = 0; j < n_rectangles; j++)
+        {
+          const int *rect = rectangles + 4 * j;
+
+          cairo_region_union_rectangle (damage,
+                                        &(cairo_rectangle_int_t) {
+                                          .x = rect[0],
+                                          .y = rect[1],
+                                          .width = rect[2],
+                                          .height = rect[3],
+                                        });
+        }
+
+      cairo_region_intersect_rectangle (damage,
+                                        &(cairo_rectangle_int_t) {
+                                          .width = dumb_fb->width,
+                                          .height = dumb_fb->height,
+                                        });
+      cairo_region_union (dumb_fb->stale_region, damage);
+      cairo_region_destroy (damage);
+    }
 }
 
 static MetaDumbBuffer *
@@ -1852,9 +2018,15 @@ secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *seconda
     return &secondary_gpu_state->cpu.dumb_fbs[0];
 }
 
-static gboolean
-copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscreen,
-                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+static CoglFramebuffer *
+create_dma_buf_framebuffer (CoglOnscreen *onscreen,
+                            int           dmabuf_fd,
+                            int           width,
+                            int           height,
+                            uint32_t      stride,
+                            uint32_t      offset,
+                            uint64_t      modifier,
+                            uint32_t      drm_format)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   CoglContext *cogl_context = framebuffer->context;
@@ -1866,10 +2038,6 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   EGLDisplay egl_display = cogl_renderer_egl->edpy;
   MetaRendererNative *renderer_native = onscreen_native->renderer_native;
   MetaEgl *egl = meta_renderer_native_get_egl (renderer_native);
-  MetaRendererNativeGpuData *primary_gpu_data;
-  MetaDrmBufferDumb *buffer_dumb;
-  MetaDumbBuffer *dumb_fb;
-  int dmabuf_fd;
   EGLImageKHR egl_image;
   g_autoptr (GError) error = NULL;
   uint32_t strides[1];
@@ -1881,37 +2049,20 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   CoglOffscreen *cogl_fbo;
   int ret;
 
-  COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
-                           "FB Copy (primary GPU)");
-
-  primary_gpu_data = meta_renderer_native_get_gpu_data (renderer_native,
-                                                        renderer_native->primary_gpu_kms);
-  if (!primary_gpu_data->secondary.has_EGL_EXT_image_dma_buf_import_modifiers)
-    return FALSE;
-
-  dumb_fb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
-
-  g_assert (cogl_framebuffer_get_width (framebuffer) == dumb_fb->width);
-  g_assert (cogl_framebuffer_get_height (framebuffer) == dumb_fb->height);
-
-  ret = cogl_pixel_format_from_drm_format (dumb_fb->drm_format,
+  ret = cogl_pixel_format_from_drm_format (drm_format,
                                            &cogl_format,
                                            NULL);
-  g_assert (ret);
-
-  dmabuf_fd = meta_dumb_buffer_ensure_dmabuf_fd (dumb_fb,
-                                                 secondary_gpu_state->gpu_kms);
-  if (dmabuf_fd == -1)
-    return FALSE;
+  if (!ret)
+    return NULL;
 
-  strides[0] = dumb_fb->stride_bytes;
-  offsets[0] = 0;
-  modifiers[0] = DRM_FORMAT_MOD_LINEAR;
+  strides[0] = stride;
+  offsets[0] = offset;
+  modifiers[0] = modifier;
   egl_image = meta_egl_create_dmabuf_image (egl,
                                             egl_display,
-                                            dumb_fb->width,
-                                            dumb_fb->height,
-                                            dumb_fb->drm_format,
+                                            width,
+                                            height,
+                                            drm_format,
                                             1 /* n_planes */,
                                             &dmabuf_fd,
                                             strides,
@@ -1920,16 +2071,16 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                                             &error);
   if (egl_image == EGL_NO_IMAGE_KHR)
     {
-      g_debug ("%s: Failed to import dumb buffer to EGL: %s",
+      g_debug ("%s: Failed to import dma-buf to EGL: %s",
                __func__, error->message);
 
-      return FALSE;
+      return NULL;
     }
 
   flags = COGL_EGL_IMAGE_FLAG_NO_GET_DATA;
   cogl_tex = cogl_egl_texture_2d_new_from_image (cogl_context,
-                                                 dumb_fb->width,
-                                                 dumb_fb->height,
+                                                 width,
+                                                 height,
                                                  cogl_format,
                                                  egl_image,
                                                  flags,
@@ -1942,7 +2093,7 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
       g_debug ("%s: Failed to make Cogl texture: %s",
                __func__, error->message);
 
-      return FALSE;
+      return NULL;
     }
 
   cogl_fbo = cogl_offscreen_new_with_texture (COGL_TEXTURE (cogl_tex));
@@ -1954,26 +2105,109 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                __func__, error->message);
       cogl_object_unref (cogl_fbo);
 
-      return FALSE;
+      return NULL;
     }
 
-  if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (cogl_fbo),
-                              0, 0, 0, 0,
-                              dumb_fb->width, dumb_fb->height, &error))
+  return COGL_FRAMEBUFFER (cogl_fbo);
+}
+
+static CoglFramebuffer *
+ensure_dumb_buffer_cogl_fbo (CoglOnscreen                        *onscreen,
+                             MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                             MetaDumbBuffer                      *dumb_fb)
+{
+  int dmabuf_fd;
+
+  if (dumb_fb->cogl_fbo)
+    return dumb_fb->cogl_fbo;
+
+  dmabuf_fd = meta_dumb_buffer_ensure_dmabuf_fd (dumb_fb,
+                                                 secondary_gpu_state->gpu_kms);
+  if (dmabuf_fd == -1)
+    return NULL;
+
+  dumb_fb->cogl_fbo = create_dma_buf_framebuffer (onscreen,
+                                                  dmabuf_fd,
+                                                  dumb_fb->width,
+                                                  dumb_fb->height,
+                                                  dumb_fb->stride_bytes,
+                                                  0,
+                                                  DRM_FORMAT_MOD_LINEAR,
+                                                  dumb_fb->drm_format);
+
+  return dumb_fb->cogl_fbo;
+}
+
+static gboolean
+copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscreen,
+                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                     CoglFramebuffer                     *framebuffer)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaRendererNativeGpuData *primary_gpu_data;
+  MetaDrmBufferDumb *buffer_dumb;
+  MetaDumbBuffer *dumb_fb;
+  CoglFramebuffer *dumb_cogl_fbo;
+  g_autoptr (GError) error = NULL;
+  uint64_t n_copied_pixels = 0;
+  int n_rects, i;
+
+  COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
+                           "FB Copy (primary GPU)");
+
+  primary_gpu_data = meta_renderer_native_get_gpu_data (renderer_native,
+                                                        renderer_native->primary_gpu_kms);
+  if (!primary_gpu_data->secondary.has_EGL_EXT_image_dma_buf_import_modifiers)
+    return FALSE;
+
+  dumb_fb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+
+  g_assert (cogl_framebuffer_get_width (framebuffer) == dumb_fb->width);
+  g_assert (cogl_framebuffer_get_height (framebuffer) == dumb_fb->height);
+
+  dumb_cogl_fbo = ensure_dumb_buffer_cogl_fbo (onscreen,
+                                               secondary_gpu_state,
+                                               dumb_fb);
+  if (!dumb_cogl_fbo)
+    return FALSE;
+
+  /*
+   * Only the area that changed since the dumb buffer was last presented
+   * needs to be copied; the rest still holds the right content.
+   */
+  n_rects = cairo_region_num_rectangles (dumb_fb->stale_region);
+  for (i = 0; i < n_rects; i++)
     {
-      g_debug ("%s: Failed Cogl blit: %s", __func__, error->message);
-      cogl_object_unref (cogl_fbo);
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (dumb_fb->stale_region, i, &rect);
+      if (!cogl_blit_framebuffer (framebuffer, dumb_cogl_fbo,
+                                  rect.x, rect.y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  &error))
+        {
+          g_debug ("%s: Failed Cogl blit: %s", __func__, error->message);
 
-      return FALSE;
+          return FALSE;
+        }
+
+      n_copied_pixels += rect.width * rect.height;
     }
 
-  cogl_object_unref (cogl_fbo);
+  cairo_region_destroy (dumb_fb->stale_region);
+  dumb_fb->stale_region = cairo_region_create ();
 
   g_clear_object (&secondary_gpu_state->gbm.next_fb);
   buffer_dumb = meta_drm_buffer_dumb_new (dumb_fb->fb_id);
   secondary_gpu_state->gbm.next_fb = META_DRM_BUFFER (buffer_dumb);
   secondary_gpu_state->cpu.dumb_fb = dumb_fb;
 
+  secondary_gpu_state->stats.n_primary_gpu_copy_frames++;
+  secondary_gpu_state->stats.n_copied_pixels += n_copied_pixels;
+
   return TRUE;
 }
 
@@ -2036,6 +2270,61 @@ cogl_pixel_format_from_drm_format (uint32_t               drm_format,
   return TRUE;
 }
 
+/*
+ * Copy from the buffer that was just swapped, for when the copy before
+ * eglSwapBuffers was skipped expecting that buffer to be imported directly
+ * but the import failed. The onscreen back buffer no longer holds the frame
+ * at this point.
+ */
+static gboolean
+copy_shared_framebuffer_from_swapped_buffer (CoglOnscreen                        *onscreen,
+                                             MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  CoglFramebuffer *bo_framebuffer;
+  struct gbm_bo *bo;
+  int dmabuf_fd;
+  gboolean ret;
+
+  if (!META_IS_DRM_BUFFER_GBM (onscreen_native->gbm.next_fb))
+    return FALSE;
+
+  bo = meta_drm_buffer_gbm_get_bo (META_DRM_BUFFER_GBM (onscreen_native->gbm.next_fb));
+  if (gbm_bo_get_plane_count (bo) != 1)
+    return FALSE;
+
+  dmabuf_fd = gbm_bo_get_fd (bo);
+  if (dmabuf_fd == -1)
+    return FALSE;
+
+  bo_framebuffer = create_dma_buf_framebuffer (onscreen,
+                                               dmabuf_fd,
+                                               gbm_bo_get_width (bo),
+                                               gbm_bo_get_height (bo),
+                                               gbm_bo_get_stride (bo),
+                                               gbm_bo_get_offset (bo, 0),
+                                               gbm_bo_get_modifier (bo),
+                                               gbm_bo_get_format (bo));
+  close (dmabuf_fd);
+
+  if (!bo_framebuffer)
+    return FALSE;
+
+  ret = copy_shared_framebuffer_primary_gpu (onscreen,
+                                             secondary_gpu_state,
+                                             bo_framebuffer);
+  cogl_object_unref (bo_framebuffer);
+
+  if (!ret)
+    return FALSE;
+
+  /* There is no eglSwapBuffers left to flush the blit before the flip. */
+  cogl_framebuffer_finish (secondary_gpu_state->cpu.dumb_fb->cogl_fbo);
+
+  return TRUE;
+}
+
 static void
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
@@ -2044,10 +2333,12 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   CoglContext *cogl_context = framebuffer->context;
   MetaDumbBuffer *dumb_fb;
-  CoglBitmap *dumb_bitmap;
   CoglPixelFormat cogl_format;
   gboolean ret;
   MetaDrmBufferDumb *buffer_dumb;
+  uint64_t n_copied_pixels = 0;
+  int bpp;
+  int n_rects, i;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "FB Copy (CPU)");
@@ -2062,30 +2353,55 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                                            NULL);
   g_assert (ret);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          dumb_fb->width,
-                                          dumb_fb->height,
-                                          cogl_format,
-                                          dumb_fb->stride_bytes,
-                                          dumb_fb->map);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  n_rects = cairo_region_num_rectangles (dumb_fb->stale_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      CoglBitmap *dumb_bitmap;
+      uint8_t *data;
+
+      cairo_region_get_rectangle (dumb_fb->stale_region, i, &rect);
+
+      data = ((uint8_t *) dumb_fb->map +
+              rect.y * dumb_fb->stride_bytes +
+              rect.x * bpp);
+      dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                              rect.width,
+                                              rect.height,
+                                              cogl_format,
+                                              dumb_fb->stride_bytes,
+                                              data);
+
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect.x,
+                                                     rect.y,
+                                                     COGL_READ_PIXELS_COLOR_BUFFER,
+                                                     dumb_bitmap))
+        g_warning ("Failed to CPU-copy to a secondary GPU output");
+
+      cogl_object_unref (dumb_bitmap);
+
+      n_copied_pixels += rect.width * rect.height;
+    }
 
-  cogl_object_unref (dumb_bitmap);
+  cairo_region_destroy (dumb_fb->stale_region);
+  dumb_fb->stale_region = cairo_region_create ();
 
   g_clear_object (&secondary_gpu_state->gbm.next_fb);
   buffer_dumb = meta_drm_buffer_dumb_new (dumb_fb->fb_id);
   secondary_gpu_state->gbm.next_fb = META_DRM_BUFFER (buffer_dumb);
   secondary_gpu_state->cpu.dumb_fb = dumb_fb;
+
+  secondary_gpu_state->stats.n_cpu_copy_frames++;
+  secondary_gpu_state->stats.n_copied_pixels += n_copied_pixels;
 }
 
 static void
-update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
+update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
+                                             const int    *rectangles,
+                                             int           n_rectangles)
 {
   CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
   MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
@@ -2109,8 +2425,24 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
           /* Done after eglSwapBuffers. */
           break;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
+          add_secondary_gpu_damage (secondary_gpu_state,
+                                    rectangles, n_rectangles);
+
+          /*
+           * When the shared framebuffer was imported directly last frame,
+           * it most likely will be again; the damage is still accumulated
+           * so that, if the import fails, the swapped buffer can be copied
+           * from with the primary GPU, picking up where the last copy left
+           * off.
+           */
+          if (secondary_gpu_state->import_status ==
+              META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK &&
+              !secondary_gpu_state->noted_primary_gpu_copy_failed)
+            break;
+
           if (!copy_shared_framebuffer_primary_gpu (onscreen,
-                                                    secondary_gpu_state))
+                                                    secondary_gpu_state,
+                                                    COGL_FRAMEBUFFER (onscreen)))
             {
               if (!secondary_gpu_state->noted_primary_gpu_copy_failed)
                 {
@@ -2157,6 +2489,10 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen *onscreen,
       renderer_gpu_data =
         meta_renderer_native_get_gpu_data (renderer_native,
                                            secondary_gpu_state->gpu_kms);
+
+      if (import_shared_framebuffer (onscreen, secondary_gpu_state))
+        continue;
+
       switch (renderer_gpu_data->secondary.copy_mode)
         {
         case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
@@ -2166,7 +2502,21 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen *onscreen,
                                        egl_context_changed);
           break;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
-          /* Done before eglSwapBuffers. */
+          /* Done before eglSwapBuffers, unless skipped for an import. */
+          if (!secondary_gpu_state->gbm.next_fb &&
+              !copy_shared_framebuffer_from_swapped_buffer (onscreen,
+                                                            secondary_gpu_state))
+            {
+              MetaDrmBufferDumb *buffer_dumb;
+
+              g_warning ("Failed to copy the shared framebuffer for %s",
+                         meta_gpu_kms_get_file_path (secondary_gpu_state->gpu_kms));
+              secondary_gpu_state->noted_primary_gpu_copy_failed = TRUE;
+
+              buffer_dumb =
+                meta_drm_buffer_dumb_new (secondary_gpu_state->cpu.dumb_fb->fb_id);
+              secondary_gpu_state->gbm.next_fb = META_DRM_BUFFER (buffer_dumb);
+            }
           break;
         }
     }
@@ -2215,7 +2565,9 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
   frame_info = g_queue_peek_tail (&onscreen->pending_frame_infos);
   frame_info->global_frame_counter = renderer_native->frame_counter;
 
-  update_secondary_gpu_state_pre_swap_buffers (onscreen);
+  update_secondary_gpu_state_pre_swap_buffers (onscreen,
+                                               rectangles,
+                                               n_rectangles);
 
   parent_vtable->onscreen_swap_buffers_with_damage (onscreen,
                                                     rectangles,
@@ -2285,6 +2637,78 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
   COGL_TRACE_END (MetaRendererNativePostKmsUpdate);
 }
 
+static gboolean
+meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
+                                     CoglScanout    *scanout,
+                                     CoglFrameInfo  *frame_info,
+                                     GError        **error)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaGpuKms *render_gpu = onscreen_native->render_gpu;
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  MetaBackend *backend = renderer_native->backend;
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  MetaKmsUpdate *kms_update;
+  MetaPowerSave power_save_mode;
+  g_autoptr (GError) post_error = NULL;
+
+  renderer_gpu_data = meta_renderer_native_get_gpu_data (renderer_native,
+                                                         render_gpu);
+
+  /*
+   * Only a single render GPU driving all of the view's CRTCs directly is
+   * handled; copying a client buffer to secondary GPUs would defeat the
+   * purpose.
+   */
+  if (renderer_gpu_data->mode != META_RENDERER_NATIVE_MODE_GBM ||
+      g_hash_table_size (onscreen_native->secondary_gpu_states) > 0 ||
+      !META_IS_DRM_BUFFER_GBM (scanout))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Direct scanout not possible for this onscreen");
+      return FALSE;
+    }
+
+  COGL_TRACE_BEGIN_SCOPED (MetaRendererNativeDirectScanout,
+                           "Onscreen (direct scanout)");
+
+  kms_update = meta_kms_ensure_pending_update (kms);
+
+  wait_for_pending_flips (onscreen);
+
+  frame_info->global_frame_counter = renderer_native->frame_counter;
+
+  g_warn_if_fail (onscreen_native->gbm.next_fb == NULL);
+  g_set_object (&onscreen_native->gbm.next_fb, META_DRM_BUFFER (scanout));
+
+  power_save_mode = meta_monitor_manager_get_power_save_mode (monitor_manager);
+  if (onscreen_native->pending_set_crtc &&
+      power_save_mode == META_POWER_SAVE_ON)
+    {
+      meta_onscreen_native_set_crtc_modes (onscreen,
+                                           renderer_gpu_data,
+                                           kms_update);
+      onscreen_native->pending_set_crtc = FALSE;
+    }
+
+  onscreen_native->pending_queue_swap_notify_frame_count = renderer_native->frame_counter;
+  meta_onscreen_native_flip_crtcs (onscreen, kms_update);
+
+  if (!meta_kms_post_pending_update_sync (kms, &post_error))
+    {
+      if (!g_error_matches (post_error,
+                            G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+        g_warning ("Failed to post KMS update: %s", post_error->message);
+    }
+
+  return TRUE;
+}
+
 static gboolean
 meta_renderer_native_init_egl_context (CoglContext *cogl_context,
                                        GError     **error)
@@ -2648,6 +3072,12 @@ init_dumb_fb (MetaDumbBuffer  *dumb_fb,
   dumb_fb->stride_bytes = create_arg.pitch;
   dumb_fb->drm_format = format;
   dumb_fb->dmabuf_fd = -1;
+  dumb_fb->cogl_fbo = NULL;
+  dumb_fb->stale_region =
+    cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                     .width = width,
+                                     .height = height,
+                                   });
 
   return TRUE;
 
@@ -2702,6 +3132,9 @@ release_dumb_fb (MetaDumbBuffer *dumb_fb,
   if (!dumb_fb->map)
     return;
 
+  g_clear_pointer (&dumb_fb->cogl_fbo, cogl_object_unref);
+  g_clear_pointer (&dumb_fb->stale_region, cairo_region_destroy);
+
   if (dumb_fb->dmabuf_fd != -1)
     close (dumb_fb->dmabuf_fd);
 
@@ -3116,6 +3549,7 @@ get_native_cogl_winsys_vtable (CoglRenderer *cogl_renderer)
       vtable.onscreen_swap_region = NULL;
       vtable.onscreen_swap_buffers_with_damage =
         meta_onscreen_native_swap_buffers_with_damage;
+      vtable.onscreen_direct_scanout = meta_onscreen_native_direct_scanout;
 
       vtable.context_get_clock_time = meta_renderer_native_get_clock_time;
 
@@ -3412,12 +3846,46 @@ meta_renderer_native_finish_frame (MetaRendererNative *renderer_native)
     }
 }
 
+MetaGpuKms *
+meta_renderer_native_get_primary_gpu (MetaRendererNative *renderer_native)
+{
+  return renderer_native->primary_gpu_kms;
+}
+
+gboolean
+meta_renderer_native_use_modifiers (MetaRendererNative *renderer_native)
+{
+  return renderer_native->use_modifiers;
+}
+
 int64_t
 meta_renderer_native_get_frame_counter (MetaRendererNative *renderer_native)
 {
   return renderer_native->frame_counter;
 }
 
+gboolean
+meta_renderer_native_get_shared_framebuffer_copy_stats (MetaRendererNative             *renderer_native,
+                                                        MetaRendererView               *view,
+                                                        MetaGpuKms                     *gpu_kms,
+                                                        MetaSharedFramebufferCopyStats *stats)
+{
+  ClutterStageView *stage_view = CLUTTER_STAGE_VIEW (view);
+  CoglFramebuffer *onscreen = clutter_stage_view_get_onscreen (stage_view);
+  CoglOnscreenEGL *onscreen_egl = COGL_ONSCREEN (onscreen)->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state;
+
+  secondary_gpu_state =
+    meta_onscreen_native_get_secondary_gpu_state (onscreen_native, gpu_kms);
+  if (!secondary_gpu_state)
+    return FALSE;
+
+  *stats = secondary_gpu_state->stats;
+
+  return TRUE;
+}
+
 static void
 meta_renderer_native_get_property (GObject    *object,
                                    guint       prop_id,
@@ -30,6 +30,7 @@
 #include <xf86drmMode.h>
 
 #include "backends/meta-renderer.h"
+#include "backends/meta-renderer-view.h"
 #include "backends/native/meta-gpu-kms.h"
 #include "backends/native/meta-monitor-manager-kms.h"
 
@@ -46,6 +47,19 @@ typedef enum _MetaRendererNativeMode
 #endif
 } MetaRendererNativeMode;
 
+/*
+ * Frames presented on a secondary GPU output, by the path that got them
+ * there, and the pixels the copying paths moved in total.
+ */
+typedef struct _MetaSharedFramebufferCopyStats
+{
+  uint64_t n_zero_copy_frames;
+  uint64_t n_secondary_gpu_copy_frames;
+  uint64_t n_primary_gpu_copy_frames;
+  uint64_t n_cpu_copy_frames;
+  uint64_t n_copied_pixels;
+} MetaSharedFramebufferCopyStats;
+
 MetaRendererNative * meta_renderer_native_new (MetaBackendNative  *backend_native,
                                                GError            **error);
 
@@ -55,6 +69,15 @@ gboolean meta_renderer_native_supports_mirroring (MetaRendererNative *renderer_n
 
 void meta_renderer_native_finish_frame (MetaRendererNative *renderer_native);
 
+MetaGpuKms * meta_renderer_native_get_primary_gpu (MetaRendererNative *renderer_native);
+
+gboolean meta_renderer_native_use_modifiers (MetaRendererNative *renderer_native);
+
 int64_t meta_renderer_native_get_frame_counter (MetaRendererNative *renderer_native);
 
+gboolean meta_renderer_native_get_shared_framebuffer_copy_stats (MetaRendererNative             *renderer_native,
+                                                                 MetaRendererView               *view,
+                                                                 MetaGpuKms                     *gpu_kms,
+                                                                 MetaSharedFramebufferCopyStats *stats);
+
 #endif /* META_RENDERER_NATIVE_H */
@@ -22,6 +22,14 @@
 
 #include "compositor/meta-compositor-server.h"
 
+#include "backends/meta-backend-private.h"
+#include "backends/meta-cursor-renderer.h"
+#include "backends/meta-renderer.h"
+#include "compositor/meta-surface-actor-wayland.h"
+#include "compositor/meta-window-actor-private.h"
+#include "core/window-private.h"
+#include "wayland/meta-wayland-surface.h"
+
 struct _MetaCompositorServer
 {
   MetaCompositor parent;
@@ -39,6 +47,200 @@ meta_compositor_server_unmanage (MetaCompositor *compositor)
 {
 }
 
+static gboolean
+is_scanout_candidate_window (MetaCompositor  *compositor,
+                             MetaWindowActor *window_actor)
+{
+  MetaWindow *window;
+
+  if (meta_compositor_is_unredirect_inhibited (compositor))
+    return FALSE;
+
+  if (meta_window_actor_is_destroyed (window_actor) ||
+      meta_window_actor_effect_in_progress (window_actor))
+    return FALSE;
+
+  if (clutter_actor_has_effects (CLUTTER_ACTOR (window_actor)) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (window_actor)) != 0xff)
+    return FALSE;
+
+  window = meta_window_actor_get_meta_window (window_actor);
+
+  /*
+   * Only Xwayland clients are considered, using the same heuristics as
+   * unredirection does on X11.
+   */
+  if (window->client_type != META_WINDOW_CLIENT_TYPE_X11)
+    return FALSE;
+
+  if (meta_window_requested_dont_bypass_compositor (window))
+    return FALSE;
+
+  if (!meta_window_requested_bypass_compositor (window) &&
+      !meta_window_is_fullscreen (window))
+    return FALSE;
+
+  if (window->opacity != 0xff || window->shape_region)
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+box_equals_rect (const ClutterActorBox       *box,
+                 const cairo_rectangle_int_t *rect)
+{
+  return (box->x1 == rect->x &&
+          box->y1 == rect->y &&
+          box->x2 == rect->x + rect->width &&
+          box->y2 == rect->y + rect->height);
+}
+
+static gboolean
+box_intersects_rect (const ClutterActorBox       *box,
+                     const cairo_rectangle_int_t *rect)
+{
+  return (box->x1 < rect->x + rect->width &&
+          box->x2 > rect->x &&
+          box->y1 < rect->y + rect->height &&
+          box->y2 > rect->y);
+}
+
+static gboolean
+is_actor_topmost_in_rect (ClutterActor                *actor,
+                          const cairo_rectangle_int_t *rect)
+{
+  ClutterActor *parent;
+
+  for (parent = clutter_actor_get_parent (actor);
+       parent;
+       actor = parent, parent = clutter_actor_get_parent (actor))
+    {
+      ClutterActor *sibling;
+
+      for (sibling = clutter_actor_get_next_sibling (actor);
+           sibling;
+           sibling = clutter_actor_get_next_sibling (sibling))
+        {
+          ClutterActorBox box;
+
+          if (!clutter_actor_is_visible (sibling))
+            continue;
+
+          if (!clutter_actor_get_paint_box (sibling, &box) ||
+              box_intersects_rect (&box, rect))
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+is_cursor_overlay_in_rect (MetaBackend                 *backend,
+                           const cairo_rectangle_int_t *rect)
+{
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  graphene_rect_t cursor_rect;
+  ClutterActorBox box;
+
+  if (!meta_cursor_renderer_get_overlay_rect (cursor_renderer, &cursor_rect))
+    return FALSE;
+
+  box = (ClutterActorBox) {
+    .x1 = cursor_rect.origin.x,
+    .y1 = cursor_rect.origin.y,
+    .x2 = cursor_rect.origin.x + cursor_rect.size.width,
+    .y2 = cursor_rect.origin.y + cursor_rect.size.height,
+  };
+  return box_intersects_rect (&box, rect);
+}
+
+/*
+ * Lets the top window bypass compositing by handing its buffer directly to
+ * the views it exactly covers, when nothing else would be painted there.
+ * Any view left without a scanout is painted as usual.
+ */
+static void
+maybe_assign_scanouts (MetaCompositor *compositor)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MetaSurfaceActorWayland *surface_actor_wayland;
+  MetaWaylandSurface *surface;
+  ClutterActorBox box;
+  gboolean assigned = FALSE;
+  GList *l;
+
+  window_actor = meta_compositor_get_top_window_actor (compositor);
+  if (!window_actor ||
+      !is_scanout_candidate_window (compositor, window_actor))
+    return;
+
+  surface_actor = meta_window_actor_get_surface (window_actor);
+  if (!surface_actor ||
+      !META_IS_SURFACE_ACTOR_WAYLAND (surface_actor) ||
+      !meta_surface_actor_is_opaque (surface_actor))
+    return;
+
+  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
+  surface = meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+  if (!surface)
+    return;
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor), &box))
+    return;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      CoglFramebuffer *onscreen;
+      cairo_rectangle_int_t view_layout;
+      g_autoptr (CoglScanout) scanout = NULL;
+
+      clutter_stage_view_get_layout (view, &view_layout);
+      if (!box_equals_rect (&box, &view_layout))
+        continue;
+
+      /* Scaled, rotated or shadow-buffered views can't show the buffer as is */
+      onscreen = clutter_stage_view_get_onscreen (view);
+      if (clutter_stage_view_get_scale (view) != 1.0 ||
+          clutter_stage_view_get_framebuffer (view) != onscreen ||
+          !cogl_is_onscreen (onscreen))
+        continue;
+
+      if (!is_actor_topmost_in_rect (CLUTTER_ACTOR (surface_actor),
+                                     &view_layout) ||
+          is_cursor_overlay_in_rect (backend, &view_layout))
+        continue;
+
+      scanout = meta_wayland_surface_try_acquire_scanout (surface,
+                                                          COGL_ONSCREEN (onscreen));
+      if (!scanout)
+        continue;
+
+      clutter_stage_view_assign_next_scanout (view, scanout);
+      assigned = TRUE;
+    }
+
+  if (assigned)
+    meta_surface_actor_wayland_queue_frame_callbacks (surface_actor_wayland);
+}
+
+static void
+meta_compositor_server_pre_paint (MetaCompositor *compositor)
+{
+  MetaCompositorClass *parent_class;
+
+  parent_class = META_COMPOSITOR_CLASS (meta_compositor_server_parent_class);
+  parent_class->pre_paint (compositor);
+
+  maybe_assign_scanouts (compositor);
+}
+
 MetaCompositorServer *
 meta_compositor_server_new (MetaDisplay *display)
 {
@@ -59,4 +261,5 @@ meta_compositor_server_class_init (MetaCompositorServerClass *klass)
 
   compositor_class->manage = meta_compositor_server_manage;
   compositor_class->unmanage = meta_compositor_server_unmanage;
+  compositor_class->pre_paint = meta_compositor_server_pre_paint;
 }
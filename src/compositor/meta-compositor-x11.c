@@ -43,21 +43,107 @@ struct _MetaCompositorX11
   gboolean have_x11_sync_object;
 
   MetaWindow *unredirected_window;
+
+  GHashTable *pending_damage;
+  guint pending_damage_idle_id;
 };
 
 G_DEFINE_TYPE (MetaCompositorX11, meta_compositor_x11, META_TYPE_COMPOSITOR)
 
+/*
+ * Past this many rectangles, the damage of a window is reduced to its
+ * bounding box before being processed.
+ */
+#define MAX_PENDING_DAMAGE_RECTS 16
+
 static void
-process_damage (MetaCompositorX11  *compositor_x11,
-                XDamageNotifyEvent *damage_xevent,
-                MetaWindow         *window)
+flush_pending_damage (MetaCompositorX11 *compositor_x11)
 {
-  MetaWindowActor *window_actor = meta_window_actor_from_window (window);
-  MetaWindowActorX11 *window_actor_x11 = META_WINDOW_ACTOR_X11 (window_actor);
+  GHashTableIter iter;
+  MetaWindow *window;
+  cairo_region_t *region;
+
+  g_clear_handle_id (&compositor_x11->pending_damage_idle_id, g_source_remove);
+
+  g_hash_table_iter_init (&iter, compositor_x11->pending_damage);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &window,
+                                 (gpointer *) &region))
+    {
+      MetaWindowActor *window_actor;
+
+      g_hash_table_iter_steal (&iter);
+
+      window_actor = meta_window_actor_from_window (window);
+      if (window_actor)
+        {
+          MetaWindowActorX11 *window_actor_x11 =
+            META_WINDOW_ACTOR_X11 (window_actor);
+
+          if (cairo_region_num_rectangles (region) > MAX_PENDING_DAMAGE_RECTS)
+            {
+              cairo_rectangle_int_t extents;
 
-  meta_window_actor_x11_process_damage (window_actor_x11, damage_xevent);
+              cairo_region_get_extents (region, &extents);
+              cairo_region_destroy (region);
+              region = cairo_region_create_rectangle (&extents);
+            }
+
+          meta_window_actor_x11_process_damage (window_actor_x11, region);
+          compositor_x11->frame_has_updated_xsurfaces = TRUE;
+        }
 
-  compositor_x11->frame_has_updated_xsurfaces = TRUE;
+      cairo_region_destroy (region);
+    }
+}
+
+static gboolean
+flush_pending_damage_idle (gpointer user_data)
+{
+  MetaCompositorX11 *compositor_x11 = user_data;
+
+  compositor_x11->pending_damage_idle_id = 0;
+  flush_pending_damage (compositor_x11);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Damage events arrive in bursts, often many per window between two frames.
+ * They are accumulated into one region per window and processed in one go,
+ * either once the current batch of X events has been dispatched or right
+ * before painting, whichever comes first.
+ */
+static void
+queue_damage (MetaCompositorX11  *compositor_x11,
+              XDamageNotifyEvent *damage_xevent,
+              MetaWindow         *window)
+{
+  cairo_rectangle_int_t rect;
+  cairo_region_t *region;
+
+  rect = (cairo_rectangle_int_t) {
+    .x = damage_xevent->area.x,
+    .y = damage_xevent->area.y,
+    .width = damage_xevent->area.width,
+    .height = damage_xevent->area.height,
+  };
+
+  region = g_hash_table_lookup (compositor_x11->pending_damage, window);
+  if (region)
+    cairo_region_union_rectangle (region, &rect);
+  else
+    g_hash_table_insert (compositor_x11->pending_damage, window,
+                         cairo_region_create_rectangle (&rect));
+
+  if (!compositor_x11->pending_damage_idle_id)
+    {
+      compositor_x11->pending_damage_idle_id =
+        g_idle_add_full (G_PRIORITY_DEFAULT,
+                         flush_pending_damage_idle,
+                         compositor_x11, NULL);
+      g_source_set_name_by_id (compositor_x11->pending_damage_idle_id,
+                               "[mutter] flush_pending_damage_idle");
+    }
 }
 
 void
@@ -86,7 +172,23 @@ meta_compositor_x11_process_xevent (MetaCompositorX11 *compositor_x11,
         }
 
       if (window)
-        process_damage (compositor_x11, (XDamageNotifyEvent *) xevent, window);
+        queue_damage (compositor_x11, (XDamageNotifyEvent *) xevent, window);
+    }
+  else
+    {
+      /* Keep damage ordered with respect to changes of the drawable */
+      switch (xevent->type)
+        {
+        case ConfigureNotify:
+        case MapNotify:
+        case UnmapNotify:
+        case DestroyNotify:
+          if (g_hash_table_size (compositor_x11->pending_damage) > 0)
+            flush_pending_damage (compositor_x11);
+          break;
+        default:
+          break;
+        }
     }
 
   if (compositor_x11->have_x11_sync_object)
@@ -268,6 +370,8 @@ meta_compositor_x11_pre_paint (MetaCompositor *compositor)
 
   maybe_unredirect_top_window (compositor_x11);
 
+  flush_pending_damage (compositor_x11);
+
   parent_class = META_COMPOSITOR_CLASS (meta_compositor_x11_parent_class);
   parent_class->pre_paint (compositor);
 
@@ -330,6 +434,8 @@ meta_compositor_x11_remove_window (MetaCompositor *compositor,
   if (compositor_x11->unredirected_window == window)
     set_unredirected_window (compositor_x11, NULL);
 
+  g_hash_table_remove (compositor_x11->pending_damage, window);
+
   parent_class = META_COMPOSITOR_CLASS (meta_compositor_x11_parent_class);
   parent_class->remove_window (compositor, window);
 }
@@ -359,12 +465,18 @@ meta_compositor_x11_dispose (GObject *object)
       compositor_x11->have_x11_sync_object = FALSE;
     }
 
+  g_clear_handle_id (&compositor_x11->pending_damage_idle_id, g_source_remove);
+  g_clear_pointer (&compositor_x11->pending_damage, g_hash_table_unref);
+
   G_OBJECT_CLASS (meta_compositor_x11_parent_class)->dispose (object);
 }
 
 static void
 meta_compositor_x11_init (MetaCompositorX11 *compositor_x11)
 {
+  compositor_x11->pending_damage =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) cairo_region_destroy);
 }
 
 static void
@@ -63,4 +63,8 @@ gboolean meta_shaped_texture_update_area (MetaShapedTexture     *stex,
                                           int                    height,
                                           cairo_rectangle_int_t *clip);
 
+gboolean meta_shaped_texture_blit_to_framebuffer (MetaShapedTexture *stex,
+                                                  CoglFramebuffer   *framebuffer,
+                                                  MetaRectangle     *clip);
+
 #endif
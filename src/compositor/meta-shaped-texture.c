@@ -1176,13 +1176,61 @@ should_get_via_offscreen (MetaShapedTexture *stex)
   return FALSE;
 }
 
+static void
+paint_to_framebuffer (MetaShapedTexture *stex,
+                      CoglFramebuffer   *framebuffer,
+                      int                x,
+                      int                y,
+                      int                image_width,
+                      int                image_height)
+{
+  g_autoptr (ClutterPaintNode) root_node = NULL;
+  int framebuffer_width = cogl_framebuffer_get_width (framebuffer);
+  int framebuffer_height = cogl_framebuffer_get_height (framebuffer);
+  CoglMatrix projection_matrix;
+  ClutterColor clear_color;
+  ClutterPaintContext *paint_context;
+
+  cogl_framebuffer_push_matrix (framebuffer);
+  cogl_matrix_init_identity (&projection_matrix);
+  cogl_matrix_scale (&projection_matrix,
+                     1.0 / (framebuffer_width / 2.0),
+                     -1.0 / (framebuffer_height / 2.0), 0);
+  cogl_matrix_translate (&projection_matrix,
+                         -(framebuffer_width / 2.0),
+                         -(framebuffer_height / 2.0), 0);
+
+  cogl_framebuffer_set_projection_matrix (framebuffer, &projection_matrix);
+
+  clear_color = (ClutterColor) { 0, 0, 0, 0 };
+
+  root_node = clutter_root_node_new (framebuffer, &clear_color,
+                                     COGL_BUFFER_BIT_COLOR);
+  clutter_paint_node_set_name (root_node, "MetaShapedTexture.offscreen");
+
+  paint_context = clutter_paint_context_new_for_framebuffer (framebuffer);
+
+  do_paint_content (stex, root_node, paint_context,
+                    stex->texture,
+                    &(ClutterActorBox) {
+                      x, y,
+                      x + image_width,
+                      y + image_height,
+                    },
+                    255);
+
+  clutter_paint_node_paint (root_node, paint_context);
+  clutter_paint_context_destroy (paint_context);
+
+  cogl_framebuffer_pop_matrix (framebuffer);
+}
+
 static cairo_surface_t *
 get_image_via_offscreen (MetaShapedTexture     *stex,
                          cairo_rectangle_int_t *clip,
                          int                    image_width,
                          int                    image_height)
 {
-  g_autoptr (ClutterPaintNode) root_node = NULL;
   ClutterBackend *clutter_backend = clutter_get_default_backend ();
   CoglContext *cogl_context =
     clutter_backend_get_cogl_context (clutter_backend);
@@ -1190,10 +1238,7 @@ get_image_via_offscreen (MetaShapedTexture     *stex,
   GError *error = NULL;
   CoglOffscreen *offscreen;
   CoglFramebuffer *fb;
-  CoglMatrix projection_matrix;
   cairo_rectangle_int_t fallback_clip;
-  ClutterColor clear_color;
-  ClutterPaintContext *paint_context;
   cairo_surface_t *surface;
 
   if (!clip)
@@ -1228,35 +1273,7 @@ get_image_via_offscreen (MetaShapedTexture     *stex,
       return FALSE;
     }
 
-  cogl_framebuffer_push_matrix (fb);
-  cogl_matrix_init_identity (&projection_matrix);
-  cogl_matrix_scale (&projection_matrix,
-                     1.0 / (image_width / 2.0),
-                     -1.0 / (image_height / 2.0), 0);
-  cogl_matrix_translate (&projection_matrix,
-                         -(image_width / 2.0),
-                         -(image_height / 2.0), 0);
-
-  cogl_framebuffer_set_projection_matrix (fb, &projection_matrix);
-
-  clear_color = (ClutterColor) { 0, 0, 0, 0 };
-
-  root_node = clutter_root_node_new (fb, &clear_color, COGL_BUFFER_BIT_COLOR);
-  clutter_paint_node_set_name (root_node, "MetaShapedTexture.offscreen");
-
-  paint_context = clutter_paint_context_new_for_framebuffer (fb);
-
-  do_paint_content (stex, root_node, paint_context,
-                    stex->texture,
-                    &(ClutterActorBox) {
-                      0, 0,
-                      image_width,
-                      image_height,
-                    },
-                    255);
-
-  clutter_paint_node_paint (root_node, paint_context);
-  clutter_paint_context_destroy (paint_context);
+  paint_to_framebuffer (stex, fb, 0, 0, image_width, image_height);
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                         clip->width, clip->height);
@@ -1272,6 +1289,42 @@ get_image_via_offscreen (MetaShapedTexture     *stex,
   return surface;
 }
 
+/*
+ * Paints @stex into @framebuffer at buffer scale, with the logical area @clip
+ * placed at its origin. Unlike meta_shaped_texture_get_image(), the result
+ * never leaves the GPU.
+ */
+gboolean
+meta_shaped_texture_blit_to_framebuffer (MetaShapedTexture *stex,
+                                         CoglFramebuffer   *framebuffer,
+                                         MetaRectangle     *clip)
+{
+  int image_width, image_height;
+  int x = 0, y = 0;
+
+  g_return_val_if_fail (META_IS_SHAPED_TEXTURE (stex), FALSE);
+
+  if (!stex->texture)
+    return FALSE;
+
+  ensure_size_valid (stex);
+
+  if (stex->dst_width == 0 || stex->dst_height == 0)
+    return FALSE;
+
+  if (clip)
+    {
+      x = -clip->x * stex->buffer_scale;
+      y = -clip->y * stex->buffer_scale;
+    }
+
+  image_width = stex->dst_width * stex->buffer_scale;
+  image_height = stex->dst_height * stex->buffer_scale;
+  paint_to_framebuffer (stex, framebuffer, x, y, image_width, image_height);
+
+  return TRUE;
+}
+
 /**
  * meta_shaped_texture_get_image:
  * @stex: A #MetaShapedTexture
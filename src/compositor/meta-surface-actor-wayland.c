@@ -86,6 +86,49 @@ meta_surface_actor_wayland_add_frame_callbacks (MetaSurfaceActorWayland *self,
   wl_list_insert_list (&self->frame_callback_list, frame_callbacks);
 }
 
+/*
+ * Frame callbacks are normally queued when the surface is painted; surfaces
+ * that are presented without being painted, e.g. when scanned out directly,
+ * need to queue them explicitly.
+ */
+void
+meta_surface_actor_wayland_queue_frame_callbacks (MetaSurfaceActorWayland *self)
+{
+  MetaWaylandCompositor *compositor;
+
+  if (!self->surface)
+    return;
+
+  compositor = self->surface->compositor;
+  wl_list_insert_list (&compositor->frame_callbacks, &self->frame_callback_list);
+  wl_list_init (&self->frame_callback_list);
+}
+
+gboolean
+meta_surface_actor_wayland_has_frame_callbacks (MetaSurfaceActorWayland *self)
+{
+  return !wl_list_empty (&self->frame_callback_list);
+}
+
+/*
+ * Surfaces that are not painted, e.g. because they are hidden, never get
+ * their frame callbacks queued; this sends them directly, for when the
+ * contents are consumed some other way, such as by a screen cast.
+ */
+void
+meta_surface_actor_wayland_send_frame_callbacks (MetaSurfaceActorWayland *self,
+                                                 int64_t                  time_us)
+{
+  while (!wl_list_empty (&self->frame_callback_list))
+    {
+      MetaWaylandFrameCallback *callback =
+        wl_container_of (self->frame_callback_list.next, callback, link);
+
+      wl_callback_send_done (callback->resource, time_us / 1000);
+      wl_resource_destroy (callback->resource);
+    }
+}
+
 static MetaWindow *
 meta_surface_actor_wayland_get_window (MetaSurfaceActor *actor)
 {
@@ -104,14 +147,8 @@ meta_surface_actor_wayland_paint (ClutterActor        *actor,
 {
   MetaSurfaceActorWayland *self = META_SURFACE_ACTOR_WAYLAND (actor);
 
-  if (self->surface &&
-      !meta_surface_actor_is_obscured (META_SURFACE_ACTOR (actor)))
-    {
-      MetaWaylandCompositor *compositor = self->surface->compositor;
-
-      wl_list_insert_list (&compositor->frame_callbacks, &self->frame_callback_list);
-      wl_list_init (&self->frame_callback_list);
-    }
+  if (!meta_surface_actor_is_obscured (META_SURFACE_ACTOR (actor)))
+    meta_surface_actor_wayland_queue_frame_callbacks (self);
 
   CLUTTER_ACTOR_CLASS (meta_surface_actor_wayland_parent_class)->paint (actor,
                                                                         paint_context);
@@ -52,6 +52,13 @@ void meta_surface_actor_wayland_get_subsurface_rect (MetaSurfaceActorWayland *se
 void meta_surface_actor_wayland_add_frame_callbacks (MetaSurfaceActorWayland *self,
                                                      struct wl_list *frame_callbacks);
 
+void meta_surface_actor_wayland_queue_frame_callbacks (MetaSurfaceActorWayland *self);
+
+gboolean meta_surface_actor_wayland_has_frame_callbacks (MetaSurfaceActorWayland *self);
+
+void meta_surface_actor_wayland_send_frame_callbacks (MetaSurfaceActorWayland *self,
+                                                      int64_t                  time_us);
+
 G_END_DECLS
 
 #endif /* __META_SURFACE_ACTOR_WAYLAND_H__ */
@@ -24,6 +24,8 @@
 
 #include "compositor/meta-window-actor-x11.h"
 
+#include <math.h>
+
 #include "backends/meta-logical-monitor.h"
 #include "compositor/compositor-private.h"
 #include "compositor/meta-cullable.h"
@@ -47,6 +49,40 @@ enum
   PROP_SHADOW_CLASS
 };
 
+#define FRAME_MASK_VERTEX_SHADER_DECLARATIONS                               \
+"varying vec2 frame_mask_position;\n"                                      \
+
+#define FRAME_MASK_VERTEX_SHADER_CODE                                       \
+"frame_mask_position = cogl_position_in.xy;\n"                             \
+
+#define FRAME_MASK_FRAGMENT_SHADER_DECLARATIONS                             \
+"uniform vec4 visible_rect;\n"                                             \
+"uniform vec4 corner_radii;\n"                                             \
+"varying vec2 frame_mask_position;\n"                                      \
+"float corner_coverage (vec2 p, vec2 center, float radius)\n"              \
+"{\n"                                                                      \
+"  return clamp (radius - distance (p, center) + 0.5, 0.0, 1.0);\n"        \
+"}\n"                                                                      \
+
+#define FRAME_MASK_FRAGMENT_SHADER_CODE                                     \
+"vec2 p = frame_mask_position;\n"                                          \
+"vec2 tl = visible_rect.xy + corner_radii.xx;\n"                           \
+"vec2 tr = vec2 (visible_rect.z - corner_radii.y,\n"                       \
+"                visible_rect.y + corner_radii.y);\n"                      \
+"vec2 bl = vec2 (visible_rect.x + corner_radii.z,\n"                       \
+"                visible_rect.w - corner_radii.z);\n"                      \
+"vec2 br = visible_rect.zw - corner_radii.ww;\n"                           \
+"float coverage = 1.0;\n"                                                  \
+"if (p.x < tl.x && p.y < tl.y)\n"                                          \
+"  coverage = corner_coverage (p, tl, corner_radii.x);\n"                  \
+"else if (p.x > tr.x && p.y < tr.y)\n"                                     \
+"  coverage = corner_coverage (p, tr, corner_radii.y);\n"                  \
+"else if (p.x < bl.x && p.y > bl.y)\n"                                     \
+"  coverage = corner_coverage (p, bl, corner_radii.z);\n"                  \
+"else if (p.x > br.x && p.y > br.y)\n"                                     \
+"  coverage = corner_coverage (p, br, corner_radii.w);\n"                  \
+"cogl_color_out *= coverage;\n"                                            \
+
 struct _MetaWindowActorX11
 {
   MetaWindowActor parent;
@@ -782,18 +818,27 @@ check_needs_shadow (MetaWindowActorX11 *actor_x11)
 }
 
 void
-meta_window_actor_x11_process_damage (MetaWindowActorX11 *actor_x11,
-                                      XDamageNotifyEvent *event)
+meta_window_actor_x11_process_damage (MetaWindowActorX11   *actor_x11,
+                                      const cairo_region_t *region)
 {
   MetaSurfaceActor *surface;
 
   surface = meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
   if (surface)
-    meta_surface_actor_process_damage (surface,
-                                       event->area.x,
-                                       event->area.y,
-                                       event->area.width,
-                                       event->area.height);
+    {
+      int i, n_rectangles;
+
+      n_rectangles = cairo_region_num_rectangles (region);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          cairo_rectangle_int_t rect;
+          cairo_region_get_rectangle (region, i, &rect);
+
+          meta_surface_actor_process_damage (surface,
+                                             rect.x, rect.y,
+                                             rect.width, rect.height);
+        }
+    }
 
   meta_window_actor_notify_damaged (META_WINDOW_ACTOR (actor_x11));
 }
@@ -930,6 +975,239 @@ build_and_scan_frame_mask (MetaWindowActorX11    *actor_x11,
   g_free (mask_data);
 }
 
+static CoglPipeline *
+create_frame_mask_pipeline (CoglContext                 *ctx,
+                            const cairo_rectangle_int_t *visible_rect,
+                            const int                    corner_radii[4])
+{
+  static CoglPipeline *template = NULL;
+  CoglPipeline *pipeline;
+  float rect[4], radii[4];
+  int i;
+
+  if (G_UNLIKELY (template == NULL))
+    {
+      CoglSnippet *snippet;
+
+      template = cogl_pipeline_new (ctx);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                                  FRAME_MASK_VERTEX_SHADER_DECLARATIONS,
+                                  FRAME_MASK_VERTEX_SHADER_CODE);
+      cogl_pipeline_add_snippet (template, snippet);
+      cogl_object_unref (snippet);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                  FRAME_MASK_FRAGMENT_SHADER_DECLARATIONS,
+                                  FRAME_MASK_FRAGMENT_SHADER_CODE);
+      cogl_pipeline_add_snippet (template, snippet);
+      cogl_object_unref (snippet);
+    }
+
+  rect[0] = visible_rect->x;
+  rect[1] = visible_rect->y;
+  rect[2] = visible_rect->x + visible_rect->width;
+  rect[3] = visible_rect->y + visible_rect->height;
+
+  for (i = 0; i < 4; i++)
+    radii[i] = corner_radii[i];
+
+  pipeline = cogl_pipeline_copy (template);
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
+                                                                       "visible_rect"),
+                                   4, 1, rect);
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
+                                                                       "corner_radii"),
+                                   4, 1, radii);
+
+  return pipeline;
+}
+
+static void
+draw_region (CoglFramebuffer *framebuffer,
+             CoglPipeline    *pipeline,
+             cairo_region_t  *region)
+{
+  int i, n_rects = cairo_region_num_rectangles (region);
+  float *coords;
+
+  if (n_rects == 0)
+    return;
+
+  coords = g_new (float, n_rects * 4);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      coords[i * 4 + 0] = rect.x;
+      coords[i * 4 + 1] = rect.y;
+      coords[i * 4 + 2] = rect.x + rect.width;
+      coords[i * 4 + 3] = rect.y + rect.height;
+    }
+
+  cogl_framebuffer_draw_rectangles (framebuffer, pipeline, coords, n_rects);
+
+  g_free (coords);
+}
+
+/* Returns the part of @visible_rect that the rounded corners leave fully
+ * opaque; a pixel row of a corner is only kept from where the circle
+ * covers the whole row, so that antialiased pixels are never included.
+ */
+static cairo_region_t *
+get_opaque_frame_region (const cairo_rectangle_int_t *visible_rect,
+                         const int                    corner_radii[4])
+{
+  cairo_region_t *region;
+  int corner;
+
+  region = cairo_region_create_rectangle (visible_rect);
+
+  for (corner = 0; corner < 4; corner++)
+    {
+      const int radius = corner_radii[corner];
+      int i;
+
+      for (i = 0; i < radius; i++)
+        {
+          const double dy = radius - i;
+          cairo_rectangle_int_t rect;
+
+          rect.width = ceil (radius - sqrt (radius * radius - dy * dy));
+          rect.height = 1;
+
+          if (corner == 0 || corner == 2)
+            rect.x = visible_rect->x;
+          else
+            rect.x = visible_rect->x + visible_rect->width - rect.width;
+
+          if (corner == 0 || corner == 1)
+            rect.y = visible_rect->y + i;
+          else
+            rect.y = visible_rect->y + visible_rect->height - i - 1;
+
+          cairo_region_subtract_rectangle (region, &rect);
+        }
+    }
+
+  return region;
+}
+
+/* Renders the mask on the GPU instead of drawing it with cairo, and
+ * derives the opaque part of the frame from its geometry instead of
+ * scanning the mask. Returns %FALSE if the frame can't be masked this
+ * way, in which case build_and_scan_frame_mask() has to be used.
+ */
+static gboolean
+build_frame_mask_on_gpu (MetaWindowActorX11    *actor_x11,
+                         cairo_rectangle_int_t *client_area,
+                         cairo_region_t        *shape_region)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  MetaWindow *window =
+    meta_window_actor_get_meta_window (META_WINDOW_ACTOR (actor_x11));
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  MetaSurfaceActor *surface =
+    meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
+  cairo_rectangle_int_t visible_rect = { 0, };
+  int corner_radii[4] = { 0, };
+  unsigned int tex_width, tex_height;
+  MetaShapedTexture *stex;
+  CoglTexture *paint_tex;
+  CoglTexture *mask_texture;
+  CoglOffscreen *offscreen;
+  CoglFramebuffer *framebuffer;
+  CoglPipeline *pipeline;
+  GError *error = NULL;
+
+  if (window->frame &&
+      !meta_frame_get_mask_shape (window->frame, &visible_rect, corner_radii))
+    return FALSE;
+
+  stex = meta_surface_actor_get_texture (surface);
+  g_return_val_if_fail (stex, TRUE);
+
+  meta_shaped_texture_set_mask_texture (stex, NULL);
+
+  paint_tex = meta_shaped_texture_get_texture (stex);
+  if (paint_tex == NULL)
+    return TRUE;
+
+  tex_width = cogl_texture_get_width (paint_tex);
+  tex_height = cogl_texture_get_height (paint_tex);
+
+  mask_texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
+                                                              tex_width,
+                                                              tex_height));
+  /* The mask only needs coverage, like the A8 mask of the cairo path;
+   * the pipelines below write the same value to every channel, so this
+   * also works when alpha textures are stored in the red component
+   */
+  cogl_texture_set_components (mask_texture, COGL_TEXTURE_COMPONENTS_A);
+  cogl_primitive_texture_set_auto_mipmap (COGL_PRIMITIVE_TEXTURE (mask_texture),
+                                          FALSE);
+
+  offscreen = cogl_offscreen_new_with_texture (mask_texture);
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    {
+      g_error_free (error);
+      cogl_object_unref (framebuffer);
+      cogl_object_unref (mask_texture);
+      return FALSE;
+    }
+
+  cogl_framebuffer_orthographic (framebuffer, 0, 0,
+                                 tex_width, tex_height, -1., 1.);
+  cogl_framebuffer_clear4f (framebuffer, COGL_BUFFER_BIT_COLOR,
+                            0.0, 0.0, 0.0, 0.0);
+
+  pipeline = cogl_pipeline_new (ctx);
+  draw_region (framebuffer, pipeline, shape_region);
+  cogl_object_unref (pipeline);
+
+  if (window->frame)
+    {
+      cairo_region_t *frame_paint_region, *opaque_region;
+
+      /* Make sure we don't paint the frame over the client window. */
+      frame_paint_region = cairo_region_create_rectangle (&visible_rect);
+      cairo_region_subtract_rectangle (frame_paint_region, client_area);
+
+      pipeline = create_frame_mask_pipeline (ctx, &visible_rect, corner_radii);
+      draw_region (framebuffer, pipeline, frame_paint_region);
+      cogl_object_unref (pipeline);
+
+      opaque_region = get_opaque_frame_region (&visible_rect, corner_radii);
+      cairo_region_intersect (opaque_region, frame_paint_region);
+      cairo_region_union (shape_region, opaque_region);
+      cairo_region_destroy (opaque_region);
+      cairo_region_destroy (frame_paint_region);
+    }
+
+  meta_shaped_texture_set_mask_texture (stex, mask_texture);
+
+  cogl_object_unref (framebuffer);
+  cogl_object_unref (mask_texture);
+
+  return TRUE;
+}
+
+static void
+build_frame_mask (MetaWindowActorX11    *actor_x11,
+                  cairo_rectangle_int_t *client_area,
+                  cairo_region_t        *shape_region)
+{
+  if (!build_frame_mask_on_gpu (actor_x11, client_area, shape_region))
+    build_and_scan_frame_mask (actor_x11, client_area, shape_region);
+}
+
 static void
 invalidate_shadow (MetaWindowActorX11 *actor_x11)
 {
@@ -970,7 +1248,7 @@ update_shape_region (MetaWindowActorX11 *actor_x11)
     }
 
   if (window->shape_region || window->frame)
-    build_and_scan_frame_mask (actor_x11, &client_area, region);
+    build_frame_mask (actor_x11, &client_area, region);
 
   g_clear_pointer (&actor_x11->shape_region, cairo_region_destroy);
   actor_x11->shape_region = region;
@@ -41,7 +41,7 @@ void meta_window_actor_x11_set_unredirected (MetaWindowActorX11 *actor_x11,
 
 void meta_window_actor_x11_update_shape (MetaWindowActorX11 *actor_x11);
 
-void meta_window_actor_x11_process_damage (MetaWindowActorX11 *actor_x11,
-                                           XDamageNotifyEvent *event);
+void meta_window_actor_x11_process_damage (MetaWindowActorX11   *actor_x11,
+                                           const cairo_region_t *region);
 
 #endif /* META_WINDOW_ACTOR_X11_H */
@@ -1272,6 +1272,115 @@ meta_window_actor_has_damage (MetaScreenCastWindow *screen_cast_window)
   return clutter_actor_has_damage (CLUTTER_ACTOR (screen_cast_window));
 }
 
+static gboolean
+meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
+                                       MetaRectangle        *bounds,
+                                       CoglFramebuffer      *framebuffer)
+{
+  MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+  ClutterActor *actor = CLUTTER_ACTOR (window_actor);
+  ClutterPaintContext *paint_context;
+  CoglColor clear_color;
+  float resource_scale;
+  float x, y;
+
+  if (meta_window_actor_is_destroyed (window_actor) || !priv->surface)
+    return FALSE;
+
+  /*
+   * Without subsurfaces the window is just its shaped texture, which can be
+   * painted regardless of whether the actor is mapped or obscured.
+   */
+  if (clutter_actor_get_n_children (actor) == 1)
+    {
+      MetaShapedTexture *stex;
+      MetaRectangle surface_clip;
+      int geometry_scale;
+
+      geometry_scale = meta_window_actor_get_geometry_scale (window_actor);
+      surface_clip = (MetaRectangle) {
+        .x = bounds->x / geometry_scale,
+        .y = bounds->y / geometry_scale,
+        .width = bounds->width / geometry_scale,
+        .height = bounds->height / geometry_scale,
+      };
+
+      stex = meta_surface_actor_get_texture (priv->surface);
+      return meta_shaped_texture_blit_to_framebuffer (stex, framebuffer,
+                                                      &surface_clip);
+    }
+
+  if (!clutter_actor_is_mapped (actor))
+    return FALSE;
+
+  if (!clutter_actor_get_resource_scale (actor, &resource_scale))
+    return FALSE;
+
+  cogl_color_init_from_4ub (&clear_color, 0, 0, 0, 0);
+  clutter_actor_get_position (actor, &x, &y);
+
+  cogl_framebuffer_push_matrix (framebuffer);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+  cogl_framebuffer_orthographic (framebuffer, 0, 0,
+                                 cogl_framebuffer_get_width (framebuffer),
+                                 cogl_framebuffer_get_height (framebuffer),
+                                 0, 1.0);
+  cogl_framebuffer_scale (framebuffer, resource_scale, resource_scale, 1);
+  cogl_framebuffer_translate (framebuffer,
+                              -x - bounds->x,
+                              -y - bounds->y,
+                              0);
+
+  paint_context = clutter_paint_context_new_for_framebuffer (framebuffer);
+  clutter_actor_paint (actor, paint_context);
+  clutter_paint_context_destroy (paint_context);
+
+  cogl_framebuffer_pop_matrix (framebuffer);
+
+  return TRUE;
+}
+
+static gboolean
+meta_window_actor_send_hidden_frame_callbacks (MetaScreenCastWindow *screen_cast_window)
+{
+#ifdef HAVE_WAYLAND
+  MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
+  ClutterActorIter iter;
+  ClutterActor *child;
+  gboolean has_pending_callbacks = FALSE;
+
+  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (window_actor));
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MetaSurfaceActorWayland *surface_actor_wayland;
+
+      if (!META_IS_SURFACE_ACTOR_WAYLAND (child))
+        continue;
+
+      surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (child);
+      if (!meta_surface_actor_wayland_has_frame_callbacks (surface_actor_wayland))
+        continue;
+
+      /* Visible surfaces get their callbacks when painted. */
+      if (clutter_actor_is_mapped (child) &&
+          !meta_surface_actor_is_obscured (META_SURFACE_ACTOR (child)))
+        {
+          has_pending_callbacks = TRUE;
+          continue;
+        }
+
+      meta_surface_actor_wayland_send_frame_callbacks (surface_actor_wayland,
+                                                       g_get_monotonic_time ());
+    }
+
+  return has_pending_callbacks;
+#else
+  return FALSE;
+#endif
+}
+
 static void
 screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface)
 {
@@ -1280,6 +1389,8 @@ screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface)
   iface->transform_cursor_position = meta_window_actor_transform_cursor_position;
   iface->capture_into = meta_window_actor_capture_into;
   iface->has_damage = meta_window_actor_has_damage;
+  iface->blit_to_framebuffer = meta_window_actor_blit_to_framebuffer;
+  iface->send_hidden_frame_callbacks = meta_window_actor_send_hidden_frame_callbacks;
 }
 
 MetaWindowActor *
@@ -2452,25 +2452,27 @@ meta_resize_gravity_from_grab_op (MetaGrabOp op)
 void
 meta_display_manage_all_xwindows (MetaDisplay *display)
 {
-  guint64 *_children;
   guint64 *children;
-  int n_children, i;
+  Window *xwindows;
+  int n_children, n_xwindows, i;
 
   meta_stack_freeze (display->stack);
-  meta_stack_tracker_get_stack (display->stack_tracker, &_children, &n_children);
+  meta_stack_tracker_get_stack (display->stack_tracker, &children, &n_children);
 
-  /* Copy the stack as it will be modified as part of the loop */
-  children = g_memdup (_children, sizeof (guint64) * n_children);
+  /* Copy the stack as it will be modified while adopting the windows */
+  xwindows = g_new (Window, n_children);
+  n_xwindows = 0;
 
   for (i = 0; i < n_children; ++i)
     {
       if (!META_STACK_ID_IS_X11 (children[i]))
         continue;
-      meta_window_x11_new (display, children[i], TRUE,
-                           META_COMP_EFFECT_NONE);
+      xwindows[n_xwindows++] = (Window) children[i];
     }
 
-  g_free (children);
+  meta_window_x11_adopt_xwindows (display, xwindows, n_xwindows);
+
+  g_free (xwindows);
   meta_stack_thaw (display->stack);
 }
 
@@ -377,6 +377,16 @@ meta_frame_get_mask (MetaFrame                    *frame,
   meta_ui_frame_get_mask (frame->ui_frame, cr);
 }
 
+gboolean
+meta_frame_get_mask_shape (MetaFrame             *frame,
+                           cairo_rectangle_int_t *visible_rect,
+                           int                    corner_radii[4])
+{
+  return meta_ui_frame_get_mask_shape (frame->ui_frame,
+                                       visible_rect,
+                                       corner_radii);
+}
+
 void
 meta_frame_queue_draw (MetaFrame *frame)
 {
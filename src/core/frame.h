@@ -75,6 +75,10 @@ cairo_region_t *meta_frame_get_frame_bounds (MetaFrame *frame);
 void meta_frame_get_mask (MetaFrame *frame,
                           cairo_t   *cr);
 
+gboolean meta_frame_get_mask_shape (MetaFrame             *frame,
+                                    cairo_rectangle_int_t *visible_rect,
+                                    int                    corner_radii[4]);
+
 void meta_frame_set_screen_cursor (MetaFrame	*frame,
 				   MetaCursor	cursor);
 
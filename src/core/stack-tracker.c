@@ -72,6 +72,12 @@
  * no longer pending b) if necessary, drop the predicted stacking
  * order to recompute it at the next opportunity.
  *
+ * The only synchronous query is the XQueryTree() made when the X11 display
+ * is set up; from then on the stack is derived purely from the requests we
+ * make and the events we get back. The stats below count how well that
+ * works and are printed along with the rest of the state in
+ * meta_stack_tracker_dump().
+ *
  * Possible optimizations:
  *  Keep the stacks as an array + reverse-mapping hash table to avoid
  *    linear lookups.
@@ -169,6 +175,21 @@ struct _MetaStackTracker
    * stack up with our best guess before a frame is drawn.
    */
   guint sync_stack_later;
+
+  struct {
+    /* Round trips to query the stack from the server */
+    guint n_queries;
+    /* Restacking requests we made and predicted the outcome of */
+    guint n_predictions;
+    /* Predictions matched by the event they caused */
+    guint n_confirmed;
+    /* Predictions the server turned out to ignore */
+    guint n_discarded;
+    /* Stacking events caused by other clients */
+    guint n_spontaneous;
+    /* Times predicted_stack was recomputed from scratch */
+    guint n_rebuilds;
+  } stats;
 };
 
 static void
@@ -251,6 +272,15 @@ meta_stack_tracker_dump (MetaStackTracker *tracker)
   meta_topic (META_DEBUG_STACK, "MetaStackTracker state\n");
   meta_push_no_msg_prefix ();
   meta_topic (META_DEBUG_STACK, "  xserver_serial: %ld\n", tracker->xserver_serial);
+  meta_topic (META_DEBUG_STACK,
+              "  stats: %u queries, %u predictions (%u confirmed, %u discarded), "
+              "%u spontaneous events, %u predicted stack rebuilds\n",
+              tracker->stats.n_queries,
+              tracker->stats.n_predictions,
+              tracker->stats.n_confirmed,
+              tracker->stats.n_discarded,
+              tracker->stats.n_spontaneous,
+              tracker->stats.n_rebuilds);
   meta_topic (META_DEBUG_STACK, "  verified_stack: ");
   stack_dump (tracker, tracker->verified_stack);
   meta_topic (META_DEBUG_STACK, "  unverified_predictions: [");
@@ -493,6 +523,7 @@ query_xserver_stack (MetaDisplay      *display,
   guint i, old_len;
 
   tracker->xserver_serial = XNextRequest (x11_display->xdisplay);
+  tracker->stats.n_queries++;
 
   XQueryTree (x11_display->xdisplay,
               x11_display->xroot,
@@ -617,6 +648,9 @@ stack_tracker_apply_prediction (MetaStackTracker *tracker,
       g_queue_push_tail (tracker->unverified_predictions, op);
     }
 
+  if (op->any.serial != 0)
+    tracker->stats.n_predictions++;
+
   if (!tracker->predicted_stack ||
       meta_stack_op_apply (tracker, op, tracker->predicted_stack, APPLY_DEFAULT))
     meta_stack_tracker_queue_sync_stack (tracker);
@@ -692,6 +726,7 @@ stack_tracker_event_received (MetaStackTracker *tracker,
 			      MetaStackOp      *op)
 {
   gboolean need_sync = FALSE;
+  gboolean predicted = FALSE;
 
   /* If the event is older than our initial query, then it's
    * already included in our tree. Just ignore it. */
@@ -712,6 +747,9 @@ stack_tracker_event_received (MetaStackTracker *tracker,
       if (queued_op->any.serial >= op->any.serial)
 	break;
 
+      if (queued_op->any.serial != 0)
+        tracker->stats.n_discarded++;
+
       meta_stack_op_apply (tracker, queued_op, tracker->verified_stack,
                            NO_RESTACK_X_WINDOWS);
 
@@ -740,6 +778,9 @@ stack_tracker_event_received (MetaStackTracker *tracker,
       if (queued_op->any.serial > op->any.serial)
 	break;
 
+      if (queued_op->any.serial == op->any.serial)
+        predicted = TRUE;
+
       meta_stack_op_apply (tracker, queued_op, tracker->verified_stack,
                            NO_RESTACK_X_WINDOWS);
 
@@ -748,6 +789,11 @@ stack_tracker_event_received (MetaStackTracker *tracker,
       need_sync = TRUE;
     }
 
+  if (predicted)
+    tracker->stats.n_confirmed++;
+  else
+    tracker->stats.n_spontaneous++;
+
   if (need_sync)
     {
       if (tracker->predicted_stack)
@@ -875,6 +921,7 @@ meta_stack_tracker_get_stack (MetaStackTracker *tracker,
           GList *l;
 
           tracker->predicted_stack = copy_stack (tracker->verified_stack);
+          tracker->stats.n_rebuilds++;
           for (l = tracker->unverified_predictions->head; l; l = l->next)
             {
               MetaStackOp *op = l->data;
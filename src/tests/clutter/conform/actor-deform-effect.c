@@ -0,0 +1,151 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+#define CLUTTER_DISABLE_DEPRECATION_WARNINGS
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct _FooShiftEffectClass
+{
+  ClutterDeformEffectClass parent_class;
+} FooShiftEffectClass;
+
+typedef struct _FooShiftEffect
+{
+  ClutterDeformEffect parent;
+
+  float offset;
+  int n_deformed_vertices;
+} FooShiftEffect;
+
+GType foo_shift_effect_get_type (void);
+
+G_DEFINE_TYPE (FooShiftEffect,
+               foo_shift_effect,
+               CLUTTER_TYPE_DEFORM_EFFECT);
+
+static void
+foo_shift_effect_deform_vertex (ClutterDeformEffect *effect,
+                                gfloat               width,
+                                gfloat               height,
+                                CoglTextureVertex   *vertex)
+{
+  FooShiftEffect *self = (FooShiftEffect *) effect;
+
+  vertex->x += self->offset;
+  self->n_deformed_vertices++;
+}
+
+static gchar *
+foo_shift_effect_get_deform_source (ClutterDeformEffect *effect)
+{
+  return g_strdup ("uniform float offset;\n"
+                   "\n"
+                   "vec4\n"
+                   "clutter_deform_vertex (vec4 position)\n"
+                   "{\n"
+                   "  return position + vec4 (offset, 0.0, 0.0, 0.0);\n"
+                   "}\n");
+}
+
+static void
+foo_shift_effect_update_uniforms (ClutterDeformEffect *effect,
+                                  CoglPipeline        *pipeline,
+                                  gfloat               width,
+                                  gfloat               height)
+{
+  FooShiftEffect *self = (FooShiftEffect *) effect;
+  int location;
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "offset");
+  cogl_pipeline_set_uniform_1f (pipeline, location, self->offset);
+}
+
+static void
+foo_shift_effect_class_init (FooShiftEffectClass *klass)
+{
+  ClutterDeformEffectClass *deform_class = CLUTTER_DEFORM_EFFECT_CLASS (klass);
+
+  deform_class->deform_vertex = foo_shift_effect_deform_vertex;
+  deform_class->get_deform_source = foo_shift_effect_get_deform_source;
+  deform_class->update_uniforms = foo_shift_effect_update_uniforms;
+}
+
+static void
+foo_shift_effect_init (FooShiftEffect *self)
+{
+  self->offset = 100.0f;
+}
+
+static guint32
+get_pixel (CoglFramebuffer *fb,
+           int              x,
+           int              y)
+{
+  guint8 data[4];
+
+  cogl_framebuffer_read_pixels (fb,
+                                x, y, 1, 1,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                data);
+
+  return (((guint32) data[0] << 16) |
+          ((guint32) data[1] << 8) |
+          data[2]);
+}
+
+static void
+view_painted_cb (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 gpointer          data)
+{
+  CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+  gboolean *was_painted = data;
+
+  /* the actor is moved by the vertex shader */
+  g_assert_cmpint (get_pixel (fb, 25, 25), ==, 0x000000);
+  g_assert_cmpint (get_pixel (fb, 125, 25), ==, 0xffffff);
+
+  *was_painted = TRUE;
+}
+
+static void
+actor_deform_effect_glsl (void)
+{
+  const ClutterColor white = { 0xff, 0xff, 0xff, 0xff };
+  FooShiftEffect *effect;
+  ClutterActor *stage;
+  ClutterActor *rect;
+  gboolean was_painted;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return;
+
+  stage = clutter_stage_new ();
+
+  rect = clutter_rectangle_new ();
+  clutter_rectangle_set_color (CLUTTER_RECTANGLE (rect), &white);
+  clutter_actor_set_size (rect, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), rect);
+
+  effect = g_object_new (foo_shift_effect_get_type (), NULL);
+  clutter_actor_add_effect (rect, CLUTTER_EFFECT (effect));
+
+  clutter_actor_show (stage);
+
+  was_painted = FALSE;
+  g_signal_connect_after (stage, "paint-view",
+                          G_CALLBACK (view_painted_cb),
+                          &was_painted);
+
+  while (!was_painted)
+    g_main_context_iteration (NULL, FALSE);
+
+  /* the CPU fallback is not used */
+  g_assert_cmpint (effect->n_deformed_vertices, ==, 0);
+
+  clutter_actor_destroy (stage);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/deform-effect/glsl", actor_deform_effect_glsl)
+)
@@ -16,6 +16,8 @@ struct _TestActor
 
   guint preferred_width_called  : 1;
   guint preferred_height_called : 1;
+
+  guint n_width_requests;
 };
 
 GType test_actor_get_type (void);
@@ -31,6 +33,7 @@ test_actor_get_preferred_width (ClutterActor *self,
   TestActor *test = (TestActor *) self;
 
   test->preferred_width_called = TRUE;
+  test->n_width_requests += 1;
 
   if (for_height == 10)
     {
@@ -212,7 +215,95 @@ actor_fixed_size (void)
   g_object_unref (rect);
 }
 
+static void
+actor_relayout_boundary (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *outer, *boundary, *leaf;
+  ClutterActorBox box;
+
+  outer = g_object_new (TEST_TYPE_ACTOR, NULL);
+  clutter_actor_add_child (stage, outer);
+
+  boundary = clutter_actor_new ();
+  clutter_actor_set_size (boundary, 50, 50);
+  clutter_actor_add_child (outer, boundary);
+
+  leaf = g_object_new (TEST_TYPE_ACTOR, NULL);
+  clutter_actor_add_child (boundary, leaf);
+
+  clutter_actor_show (stage);
+
+  /* allocate everything once */
+  clutter_actor_get_allocation_box (leaf, &box);
+
+  ((TestActor *) outer)->preferred_width_called = FALSE;
+  ((TestActor *) outer)->preferred_height_called = FALSE;
+  ((TestActor *) leaf)->preferred_width_called = FALSE;
+  ((TestActor *) leaf)->preferred_height_called = FALSE;
+
+  /* a relayout of the leaf stops at the fixed size boundary */
+  clutter_actor_queue_relayout (leaf);
+  clutter_actor_get_allocation_box (leaf, &box);
+
+  g_assert (((TestActor *) leaf)->preferred_width_called);
+  g_assert (!((TestActor *) outer)->preferred_width_called);
+  g_assert (!((TestActor *) outer)->preferred_height_called);
+  g_assert_cmpfloat (clutter_actor_get_width (boundary), ==, 50);
+
+  /* changing the size of the boundary itself reaches the parent */
+  clutter_actor_set_size (boundary, 60, 60);
+  clutter_actor_get_allocation_box (boundary, &box);
+
+  g_assert (((TestActor *) outer)->preferred_width_called);
+  g_assert_cmpfloat (box.x2 - box.x1, ==, 60);
+
+  clutter_actor_destroy (outer);
+}
+
+static void
+actor_size_request_cache (void)
+{
+  ClutterActor *test;
+  TestActor *self;
+  gfloat min_width, nat_width;
+  int i;
+
+  test = g_object_new (TEST_TYPE_ACTOR, NULL);
+  self = (TestActor *) test;
+
+  /* more sizes than the old fixed cache could hold */
+  for (i = 0; i < 8; i++)
+    clutter_actor_get_preferred_width (test, 10 * i, &min_width, &nat_width);
+
+  g_assert_cmpuint (self->n_width_requests, ==, 8);
+
+  /* asking again must be answered by the cache */
+  for (i = 7; i >= 0; i--)
+    {
+      clutter_actor_get_preferred_width (test, 10 * i, &min_width, &nat_width);
+
+      if (i == 1)
+        g_assert_cmpfloat (min_width, ==, 10);
+      else
+        g_assert_cmpfloat (min_width, ==, 100);
+    }
+
+  g_assert_cmpuint (self->n_width_requests, ==, 8);
+
+  /* a relayout invalidates the cache */
+  clutter_actor_queue_relayout (test);
+  clutter_actor_get_preferred_width (test, 10, &min_width, &nat_width);
+
+  g_assert_cmpuint (self->n_width_requests, ==, 9);
+  g_assert_cmpfloat (min_width, ==, 10);
+
+  clutter_actor_destroy (test);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/size/preferred", actor_preferred_size)
   CLUTTER_TEST_UNIT ("/actor/size/fixed", actor_fixed_size)
+  CLUTTER_TEST_UNIT ("/actor/size/relayout-boundary", actor_relayout_boundary)
+  CLUTTER_TEST_UNIT ("/actor/size/request-cache", actor_size_request_cache)
 )
@@ -0,0 +1,94 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLUTTER_DISABLE_DEPRECATION_WARNINGS
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+static void
+assert_stage_point (ClutterActor *actor,
+                    float         expected_x,
+                    float         expected_y)
+{
+  graphene_point3d_t point = GRAPHENE_POINT3D_INIT (0, 0, 0);
+  graphene_point3d_t vertex;
+  ClutterActorBox box;
+
+  /* make sure the allocation is up to date */
+  clutter_actor_get_allocation_box (actor, &box);
+
+  clutter_actor_apply_relative_transform_to_point (actor, NULL,
+                                                   &point, &vertex);
+
+  if (g_test_verbose ())
+    g_print ("%s: (%.2f, %.2f), expected (%.2f, %.2f)\n",
+             clutter_actor_get_name (actor),
+             vertex.x, vertex.y,
+             expected_x, expected_y);
+
+  g_assert_cmpfloat (fabsf (vertex.x - expected_x), <, 0.01f);
+  g_assert_cmpfloat (fabsf (vertex.y - expected_y), <, 0.01f);
+}
+
+static void
+actor_transform_cache_invalidation (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *parent, *child, *other;
+  ClutterMatrix child_transform;
+
+  parent = clutter_actor_new ();
+  clutter_actor_set_name (parent, "parent");
+  clutter_actor_set_position (parent, 10, 20);
+  clutter_actor_set_size (parent, 100, 100);
+  clutter_actor_add_child (stage, parent);
+
+  child = clutter_actor_new ();
+  clutter_actor_set_name (child, "child");
+  clutter_actor_set_position (child, 5, 5);
+  clutter_actor_set_size (child, 10, 10);
+  clutter_actor_add_child (parent, child);
+
+  other = clutter_actor_new ();
+  clutter_actor_set_name (other, "other");
+  clutter_actor_set_position (other, 200, 200);
+  clutter_actor_add_child (stage, other);
+
+  clutter_actor_show (stage);
+
+  /* populate the caches */
+  assert_stage_point (child, 15, 25);
+
+  /* moving an ancestor must be picked up by its children */
+  clutter_actor_set_position (parent, 30, 40);
+  assert_stage_point (child, 35, 45);
+
+  /* changing a transformation property of an ancestor */
+  clutter_actor_set_translation (parent, 1, 2, 0);
+  assert_stage_point (child, 36, 47);
+  clutter_actor_set_translation (parent, 0, 0, 0);
+
+  /* changing the :child-transform of the parent */
+  clutter_matrix_init_identity (&child_transform);
+  cogl_matrix_translate (&child_transform, 3, 4, 0);
+  clutter_actor_set_child_transform (parent, &child_transform);
+  assert_stage_point (child, 38, 49);
+  clutter_actor_set_child_transform (parent, NULL);
+  assert_stage_point (child, 35, 45);
+
+  /* reparenting */
+  g_object_ref (child);
+  clutter_actor_remove_child (parent, child);
+  clutter_actor_add_child (other, child);
+  g_object_unref (child);
+  assert_stage_point (child, 205, 205);
+
+  clutter_actor_destroy (parent);
+  clutter_actor_destroy (other);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/transform/cache-invalidation", actor_transform_cache_invalidation)
+)
@@ -0,0 +1,171 @@
+#include <math.h>
+
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define TEST_TYPE_FINAL_STATE_ACTOR     (test_final_state_actor_get_type ())
+#define TEST_FINAL_STATE_ACTOR(obj)     (G_TYPE_CHECK_INSTANCE_CAST ((obj), TEST_TYPE_FINAL_STATE_ACTOR, TestFinalStateActor))
+
+typedef struct _TestFinalStateActor      TestFinalStateActor;
+typedef struct _TestFinalStateActorClass TestFinalStateActorClass;
+
+struct _TestFinalStateActor
+{
+  ClutterActor parent_instance;
+
+  int n_final_states;
+};
+
+struct _TestFinalStateActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+static ClutterAnimatableInterface *parent_animatable_iface = NULL;
+
+static void animatable_iface_init (ClutterAnimatableInterface *iface);
+
+GType test_final_state_actor_get_type (void);
+
+G_DEFINE_TYPE_WITH_CODE (TestFinalStateActor, test_final_state_actor,
+                         CLUTTER_TYPE_ACTOR,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_ANIMATABLE,
+                                                animatable_iface_init));
+
+static void
+test_final_state_actor_set_final_state (ClutterAnimatable *animatable,
+                                        const char        *property_name,
+                                        const GValue      *value)
+{
+  TEST_FINAL_STATE_ACTOR (animatable)->n_final_states += 1;
+
+  parent_animatable_iface->set_final_state (animatable, property_name, value);
+}
+
+static void
+animatable_iface_init (ClutterAnimatableInterface *iface)
+{
+  parent_animatable_iface = g_type_interface_peek_parent (iface);
+
+  iface->set_final_state = test_final_state_actor_set_final_state;
+}
+
+static void
+test_final_state_actor_class_init (TestFinalStateActorClass *klass)
+{
+}
+
+static void
+test_final_state_actor_init (TestFinalStateActor *self)
+{
+}
+
+static void
+advance_transition (ClutterActor *actor,
+                    const char   *name,
+                    guint         msecs)
+{
+  ClutterTransition *transition;
+
+  transition = clutter_actor_get_transition (actor, name);
+  g_assert_nonnull (transition);
+  g_assert_true (CLUTTER_IS_PROPERTY_TRANSITION (transition));
+
+  clutter_timeline_advance (CLUTTER_TIMELINE (transition), msecs);
+  g_signal_emit_by_name (transition, "new-frame", msecs);
+}
+
+static void
+actor_transitions_typed (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *actor;
+  ClutterMatrix transform, result;
+  ClutterColor color;
+  gdouble scale_x;
+
+  actor = clutter_actor_new ();
+  clutter_actor_add_child (stage, actor);
+  clutter_actor_show (stage);
+
+  g_assert_true (clutter_actor_is_mapped (actor));
+
+  clutter_matrix_init_identity (&transform);
+  cogl_matrix_translate (&transform, 100, 0, 0);
+
+  clutter_actor_save_easing_state (actor);
+  clutter_actor_set_easing_mode (actor, CLUTTER_LINEAR);
+  clutter_actor_set_easing_duration (actor, 1000);
+  clutter_actor_set_x (actor, 100);
+  clutter_actor_set_opacity (actor, 0);
+  clutter_actor_set_scale (actor, 3.0, 3.0);
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_White);
+  clutter_actor_set_transform (actor, &transform);
+  clutter_actor_restore_easing_state (actor);
+
+  /* the values are set immediately only at the end of the transitions */
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 0);
+
+  advance_transition (actor, "x", 500);
+  advance_transition (actor, "opacity", 500);
+  advance_transition (actor, "scale-x", 500);
+  advance_transition (actor, "background-color", 500);
+  advance_transition (actor, "transform", 500);
+
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 50);
+  g_assert_cmpuint (clutter_actor_get_opacity (actor), ==, 127);
+
+  clutter_actor_get_scale (actor, &scale_x, NULL);
+  g_assert_cmpfloat (scale_x, ==, 2.0);
+
+  clutter_actor_get_background_color (actor, &color);
+  g_assert_cmpuint (color.red, ==, 127);
+  g_assert_cmpuint (color.alpha, ==, 127);
+
+  clutter_actor_get_transform (actor, &result);
+  g_assert_cmpfloat (fabsf (result.xw - 50.f), <, 0.001f);
+
+  /* retargeting a running transition uses the new interval */
+  clutter_actor_save_easing_state (actor);
+  clutter_actor_set_easing_mode (actor, CLUTTER_LINEAR);
+  clutter_actor_set_easing_duration (actor, 1000);
+  clutter_actor_set_x (actor, 0);
+  clutter_actor_restore_easing_state (actor);
+
+  advance_transition (actor, "x", 500);
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 25);
+
+  clutter_actor_remove_all_transitions (actor);
+  clutter_actor_destroy (actor);
+}
+
+static void
+actor_transitions_final_state_override (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *actor;
+
+  actor = g_object_new (TEST_TYPE_FINAL_STATE_ACTOR, NULL);
+  clutter_actor_add_child (stage, actor);
+  clutter_actor_show (stage);
+
+  clutter_actor_save_easing_state (actor);
+  clutter_actor_set_easing_mode (actor, CLUTTER_LINEAR);
+  clutter_actor_set_easing_duration (actor, 1000);
+  clutter_actor_set_x (actor, 100);
+  clutter_actor_restore_easing_state (actor);
+
+  /* the overridden ClutterAnimatable.set_final_state() sees every frame */
+  advance_transition (actor, "x", 500);
+  g_assert_cmpint (TEST_FINAL_STATE_ACTOR (actor)->n_final_states, ==, 1);
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 50);
+
+  clutter_actor_remove_all_transitions (actor);
+  clutter_actor_destroy (actor);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/transitions/typed", actor_transitions_typed)
+  CLUTTER_TEST_UNIT ("/actor/transitions/final-state-override", actor_transitions_final_state_override)
+)
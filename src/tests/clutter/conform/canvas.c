@@ -0,0 +1,110 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct
+{
+  int n_draws;
+  double clip_x1, clip_y1, clip_x2, clip_y2;
+  GThread *draw_thread;
+} DrawData;
+
+static gboolean
+on_draw (ClutterCanvas *canvas,
+         cairo_t       *cr,
+         int            width,
+         int            height,
+         DrawData      *data)
+{
+  data->n_draws += 1;
+  data->draw_thread = g_thread_self ();
+
+  cairo_clip_extents (cr,
+                      &data->clip_x1, &data->clip_y1,
+                      &data->clip_x2, &data->clip_y2);
+
+  cairo_set_source_rgb (cr, 1.0, 0.0, 0.0);
+  cairo_paint (cr);
+
+  return TRUE;
+}
+
+static void
+canvas_invalidate_rect (void)
+{
+  ClutterContent *canvas;
+  DrawData data = { 0, };
+
+  canvas = clutter_canvas_new ();
+  g_signal_connect (canvas, "draw", G_CALLBACK (on_draw), &data);
+
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas), 100, 100);
+  g_assert_cmpint (data.n_draws, ==, 1);
+  g_assert_cmpfloat (data.clip_x1, ==, 0.0);
+  g_assert_cmpfloat (data.clip_y1, ==, 0.0);
+  g_assert_cmpfloat (data.clip_x2, ==, 100.0);
+  g_assert_cmpfloat (data.clip_y2, ==, 100.0);
+
+  clutter_canvas_invalidate_rect (CLUTTER_CANVAS (canvas),
+                                  &(cairo_rectangle_int_t) {
+                                    .x = 10, .y = 20,
+                                    .width = 30, .height = 40,
+                                  });
+  g_assert_cmpint (data.n_draws, ==, 2);
+  g_assert_cmpfloat (data.clip_x1, ==, 10.0);
+  g_assert_cmpfloat (data.clip_y1, ==, 20.0);
+  g_assert_cmpfloat (data.clip_x2, ==, 40.0);
+  g_assert_cmpfloat (data.clip_y2, ==, 60.0);
+
+  /* areas outside of the canvas are ignored */
+  clutter_canvas_invalidate_rect (CLUTTER_CANVAS (canvas),
+                                  &(cairo_rectangle_int_t) {
+                                    .x = 200, .y = 200,
+                                    .width = 10, .height = 10,
+                                  });
+  g_assert_cmpint (data.n_draws, ==, 2);
+
+  g_object_unref (canvas);
+}
+
+static void
+on_canvas_finalized (gpointer  user_data,
+                     GObject  *where_the_object_was)
+{
+  GMainLoop *main_loop = user_data;
+
+  g_main_loop_quit (main_loop);
+}
+
+static void
+canvas_threaded_draw (void)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  ClutterContent *canvas;
+  DrawData data = { 0, };
+
+  canvas = clutter_canvas_new ();
+  clutter_canvas_set_threaded_draw (CLUTTER_CANVAS (canvas), TRUE);
+  g_assert_true (clutter_canvas_get_threaded_draw (CLUTTER_CANVAS (canvas)));
+
+  g_signal_connect (canvas, "draw", G_CALLBACK (on_draw), &data);
+
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas), 100, 100);
+
+  /* the canvas keeps a reference on itself until the drawn contents are
+   * uploaded, so it goes away once the threaded draw is done
+   */
+  g_object_weak_ref (G_OBJECT (canvas), on_canvas_finalized, main_loop);
+  g_object_unref (canvas);
+  g_main_loop_run (main_loop);
+
+  g_assert_cmpint (data.n_draws, ==, 1);
+  g_assert_true (data.draw_thread != g_thread_self ());
+
+  g_main_loop_unref (main_loop);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/canvas/invalidate-rect", canvas_invalidate_rect)
+  CLUTTER_TEST_UNIT ("/canvas/threaded-draw", canvas_threaded_draw)
+)
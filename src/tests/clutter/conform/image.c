@@ -0,0 +1,137 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct
+{
+  gboolean done;
+  gboolean res;
+  GError *error;
+} LoadResult;
+
+static void
+on_load_done (GObject      *source_object,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  LoadResult *load_result = user_data;
+
+  load_result->res = clutter_image_load_bytes_finish (CLUTTER_IMAGE (source_object),
+                                                      result,
+                                                      &load_result->error);
+  load_result->done = TRUE;
+}
+
+static GBytes *
+create_pixels (int width,
+               int height)
+{
+  return g_bytes_new_take (g_malloc0 (width * height * 4), width * height * 4);
+}
+
+static void
+image_load_bytes_async (void)
+{
+  ClutterContent *image;
+  LoadResult load_result = { 0, };
+  GBytes *bytes;
+  float width, height;
+
+  image = clutter_image_new ();
+  bytes = create_pixels (16, 8);
+
+  clutter_image_load_bytes_async (CLUTTER_IMAGE (image), bytes,
+                                  COGL_PIXEL_FORMAT_RGBA_8888,
+                                  16, 8, 16 * 4,
+                                  NULL,
+                                  on_load_done, &load_result);
+  g_bytes_unref (bytes);
+
+  while (!load_result.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_no_error (load_result.error);
+  g_assert_true (load_result.res);
+  g_assert_nonnull (clutter_image_get_texture (CLUTTER_IMAGE (image)));
+
+  g_assert_true (clutter_content_get_preferred_size (image, &width, &height));
+  g_assert_cmpfloat (width, ==, 16);
+  g_assert_cmpfloat (height, ==, 8);
+
+  g_object_unref (image);
+}
+
+static void
+image_load_bytes_superseded (void)
+{
+  ClutterContent *image;
+  LoadResult load_result = { 0, };
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GBytes) other_bytes = NULL;
+  float width, height;
+
+  image = clutter_image_new ();
+  bytes = create_pixels (16, 8);
+  other_bytes = create_pixels (4, 4);
+
+  clutter_image_load_bytes_async (CLUTTER_IMAGE (image), bytes,
+                                  COGL_PIXEL_FORMAT_RGBA_8888,
+                                  16, 8, 16 * 4,
+                                  NULL,
+                                  on_load_done, &load_result);
+
+  /* replacing the contents synchronously wins over the pending load */
+  g_assert_true (clutter_image_set_bytes (CLUTTER_IMAGE (image), other_bytes,
+                                          COGL_PIXEL_FORMAT_RGBA_8888,
+                                          4, 4, 4 * 4,
+                                          NULL));
+
+  while (!load_result.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_error (load_result.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_false (load_result.res);
+  g_clear_error (&load_result.error);
+
+  g_assert_true (clutter_content_get_preferred_size (image, &width, &height));
+  g_assert_cmpfloat (width, ==, 4);
+  g_assert_cmpfloat (height, ==, 4);
+
+  g_object_unref (image);
+}
+
+static void
+image_load_bytes_invalid_stride (void)
+{
+  ClutterContent *image;
+  LoadResult load_result = { 0, };
+  g_autoptr (GBytes) bytes = NULL;
+
+  image = clutter_image_new ();
+  bytes = create_pixels (16, 8);
+
+  /* rows shorter than the width of the image are rejected */
+  clutter_image_load_bytes_async (CLUTTER_IMAGE (image), bytes,
+                                  COGL_PIXEL_FORMAT_RGBA_8888,
+                                  16, 8, 16,
+                                  NULL,
+                                  on_load_done, &load_result);
+
+  while (!load_result.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_error (load_result.error,
+                  CLUTTER_IMAGE_ERROR, CLUTTER_IMAGE_ERROR_INVALID_DATA);
+  g_assert_false (load_result.res);
+  g_clear_error (&load_result.error);
+
+  g_assert_null (clutter_image_get_texture (CLUTTER_IMAGE (image)));
+
+  g_object_unref (image);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/image/load-bytes-async", image_load_bytes_async)
+  CLUTTER_TEST_UNIT ("/image/load-bytes-async/superseded", image_load_bytes_superseded)
+  CLUTTER_TEST_UNIT ("/image/load-bytes-async/invalid-stride", image_load_bytes_invalid_stride)
+)
@@ -0,0 +1,74 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+static void
+marker_reached_cb (ClutterTimeline *timeline,
+                   const char      *marker_name,
+                   int              msecs,
+                   GPtrArray       *reached)
+{
+  if (g_test_verbose ())
+    g_print ("Marker '%s' reached at %d msecs\n", marker_name, msecs);
+
+  g_ptr_array_add (reached, g_strdup (marker_name));
+
+  /* removing markers from a handler must be safe, even when they
+   * have been reached during the same frame
+   */
+  if (g_str_equal (marker_name, "remove-me"))
+    clutter_timeline_remove_marker (timeline, "middle");
+}
+
+static void
+completed_cb (ClutterTimeline *timeline,
+              gboolean        *completed)
+{
+  *completed = TRUE;
+}
+
+static void
+timeline_markers_order (void)
+{
+  ClutterTimeline *timeline;
+  GPtrArray *reached;
+  gboolean completed = FALSE;
+
+  reached = g_ptr_array_new_with_free_func (g_free);
+
+  timeline = clutter_timeline_new (200);
+
+  /* added out of order on purpose */
+  clutter_timeline_add_marker_at_time (timeline, "end", 200);
+  clutter_timeline_add_marker_at_time (timeline, "middle", 100);
+  clutter_timeline_add_marker (timeline, "quarter", 0.25);
+  clutter_timeline_add_marker_at_time (timeline, "start", 0);
+  clutter_timeline_add_marker_at_time (timeline, "remove-me", 120);
+
+  g_signal_connect (timeline, "marker-reached",
+                    G_CALLBACK (marker_reached_cb),
+                    reached);
+  g_signal_connect (timeline, "completed",
+                    G_CALLBACK (completed_cb),
+                    &completed);
+
+  clutter_timeline_start (timeline);
+
+  while (!completed)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (reached->len, ==, 5);
+  g_assert_cmpstr (g_ptr_array_index (reached, 0), ==, "start");
+  g_assert_cmpstr (g_ptr_array_index (reached, 1), ==, "quarter");
+  g_assert_cmpstr (g_ptr_array_index (reached, 2), ==, "middle");
+  g_assert_cmpstr (g_ptr_array_index (reached, 3), ==, "remove-me");
+  g_assert_cmpstr (g_ptr_array_index (reached, 4), ==, "end");
+  g_assert_false (clutter_timeline_has_marker (timeline, "middle"));
+
+  g_ptr_array_free (reached, TRUE);
+  g_object_unref (timeline);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/timeline/markers/order", timeline_markers_order)
+)
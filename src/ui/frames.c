@@ -1453,6 +1453,106 @@ meta_ui_frame_get_mask (MetaUIFrame *frame,
   cairo_surface_set_device_scale (surface, xscale, yscale);
 }
 
+/* GTK+ does not allow looking up the radii of the individual corners,
+ * "border-radius" is the radius of the top-left one; like the
+ * background, the radius is clamped to the size of the box
+ */
+static int
+get_background_radius (GtkStyleContext *style,
+                       int              scale,
+                       int              width,
+                       int              height)
+{
+  int border_radius;
+
+  gtk_style_context_get (style, gtk_style_context_get_state (style),
+                         "border-radius", &border_radius,
+                         NULL);
+
+  return MIN (border_radius * scale, MIN (width, height) / 2);
+}
+
+/*
+ * Retrieve the shape of the mask drawn by meta_ui_frame_get_mask(),
+ * so that it can be built without drawing the frame.
+ *
+ * The mask covers @visible_rect, in the same coordinates as the mask,
+ * with the corners rounded by the radii stored in @corner_radii, in the
+ * top-left, top-right, bottom-left and bottom-right order.
+ *
+ * This only works if the backgrounds of the frame are opaque; otherwise
+ * %FALSE is returned, and the mask must be drawn.
+ *
+ * @frame: This frame
+ * @visible_rect: (out): Return location for the visible frame rectangle
+ * @corner_radii: (out): Return location for the four corner radii
+ */
+gboolean
+meta_ui_frame_get_mask_shape (MetaUIFrame           *frame,
+                              cairo_rectangle_int_t *visible_rect,
+                              int                    corner_radii[4])
+{
+  const MetaStyleElement elements[] = {
+    META_STYLE_ELEMENT_FRAME,
+    META_STYLE_ELEMENT_TITLEBAR,
+  };
+  MetaFrameGeometry fgeom;
+  MetaFrameFlags flags;
+  int frame_radius, titlebar_radius;
+  int titlebar_height;
+  int scale;
+  unsigned int i;
+
+  flags = meta_frame_get_flags (frame->meta_window->frame);
+  meta_style_info_set_flags (frame->style_info, flags);
+
+  /* gtk_render_background() paints the background color below any
+   * background image, so an opaque color is enough for the result to
+   * be opaque within the rounded corners
+   */
+  for (i = 0; i < G_N_ELEMENTS (elements); i++)
+    {
+      GtkStyleContext *style = frame->style_info->styles[elements[i]];
+      GdkRGBA *color;
+      gboolean is_opaque;
+
+      gtk_style_context_get (style, gtk_style_context_get_state (style),
+                             GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &color,
+                             NULL);
+      is_opaque = color->alpha >= 1.0;
+      gdk_rgba_free (color);
+
+      if (!is_opaque)
+        return FALSE;
+    }
+
+  meta_ui_frame_calc_geometry (frame, &fgeom);
+  get_visible_frame_rect (&fgeom, visible_rect);
+
+  /* The frame background covers the whole visible rectangle and the
+   * titlebar background its top, so the top corners of the mask are
+   * rounded by the smaller of both radii; see meta_ui_frame_get_mask()
+   */
+  scale = meta_theme_get_window_scaling_factor ();
+  titlebar_height = fgeom.borders.total.top - fgeom.borders.invisible.top;
+
+  frame_radius = get_background_radius (frame->style_info->styles[META_STYLE_ELEMENT_FRAME],
+                                        scale,
+                                        visible_rect->width,
+                                        visible_rect->height);
+  titlebar_radius = get_background_radius (frame->style_info->styles[META_STYLE_ELEMENT_TITLEBAR],
+                                           scale,
+                                           visible_rect->width,
+                                           titlebar_height);
+
+  corner_radii[0] = MIN (frame_radius, titlebar_radius);
+  corner_radii[1] = MIN (frame_radius, titlebar_radius);
+  corner_radii[2] = frame_radius;
+  corner_radii[3] = frame_radius;
+
+  return TRUE;
+}
+
 /* XXX -- this is disgusting. Find a better approach here.
  * Use multiple widgets? */
 static MetaUIFrame *
@@ -136,6 +136,10 @@ cairo_region_t * meta_ui_frame_get_bounds (MetaUIFrame *frame);
 void meta_ui_frame_get_mask (MetaUIFrame *frame,
                              cairo_t     *cr);
 
+gboolean meta_ui_frame_get_mask_shape (MetaUIFrame           *frame,
+                                       cairo_rectangle_int_t *visible_rect,
+                                       int                    corner_radii[4]);
+
 void meta_ui_frame_move_resize (MetaUIFrame *frame,
                                 int x, int y, int width, int height);
 
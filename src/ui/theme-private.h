@@ -182,6 +182,9 @@ struct _MetaStyleInfo
   int refcount;
 
   GtkStyleContext *styles[META_STYLE_ELEMENT_LAST];
+
+  /* rendered frame parts, see meta_frame_layout_draw_with_style() */
+  GHashTable *part_cache;
 };
 
 /* Kinds of frame...
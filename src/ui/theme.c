@@ -704,6 +704,427 @@ get_class_from_button_type (MetaButtonType type)
     }
 }
 
+/* Rendered parts of frames are cached per style info, keyed by
+ * everything that affects their rendering; the frame background is
+ * cached as a nine-slice template, so that resizing a frame only needs
+ * to stretch its edges.
+ */
+typedef enum
+{
+  META_FRAME_PART_BACKGROUND,
+  META_FRAME_PART_BUTTON,
+} MetaFramePart;
+
+typedef struct
+{
+  int part;
+  int frame_flags;
+  int scale;
+  int width;
+  int height;
+
+  /* META_FRAME_PART_BACKGROUND */
+  int titlebar_height;
+  int slice_left;
+  int slice_right;
+  int slice_top;
+  int slice_bottom;
+
+  /* META_FRAME_PART_BUTTON */
+  int button_type;
+  int button_state;
+  int icon_size;
+} MetaFramePartKey;
+
+/* Extra room around the corners of the nine-slice template, to stay
+ * clear of antialiasing and of borders drawn next to the corners
+ */
+#define FRAME_SLICE_MARGIN 2
+
+#define MAX_CACHED_FRAME_PARTS 64
+
+static guint
+meta_frame_part_key_hash (gconstpointer data)
+{
+  const int *values = data;
+  guint hash = 0;
+  unsigned int i;
+
+  for (i = 0; i < sizeof (MetaFramePartKey) / sizeof (int); i++)
+    hash = hash * 31 + values[i];
+
+  return hash;
+}
+
+static gboolean
+meta_frame_part_key_equal (gconstpointer a,
+                           gconstpointer b)
+{
+  return memcmp (a, b, sizeof (MetaFramePartKey)) == 0;
+}
+
+static cairo_surface_t *
+lookup_frame_part (MetaStyleInfo          *style_info,
+                   const MetaFramePartKey *key)
+{
+  if (style_info->part_cache == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (style_info->part_cache, key);
+}
+
+static void
+insert_frame_part (MetaStyleInfo          *style_info,
+                   const MetaFramePartKey *key,
+                   cairo_surface_t        *surface)
+{
+  if (style_info->part_cache == NULL)
+    {
+      style_info->part_cache =
+        g_hash_table_new_full (meta_frame_part_key_hash,
+                               meta_frame_part_key_equal,
+                               g_free,
+                               (GDestroyNotify) cairo_surface_destroy);
+    }
+
+  /* Titlebar font changes and the like leave stale entries behind */
+  if (g_hash_table_size (style_info->part_cache) >= MAX_CACHED_FRAME_PARTS)
+    g_hash_table_remove_all (style_info->part_cache);
+
+  g_hash_table_insert (style_info->part_cache,
+                       g_memdup (key, sizeof (MetaFramePartKey)),
+                       cairo_surface_reference (surface));
+}
+
+static cairo_surface_t *
+create_frame_part_surface (cairo_t *cr,
+                           int      width,
+                           int      height,
+                           int      scale)
+{
+  cairo_surface_t *surface;
+
+  surface = cairo_surface_create_similar_image (cairo_get_target (cr),
+                                                CAIRO_FORMAT_ARGB32,
+                                                width * scale,
+                                                height * scale);
+  cairo_surface_set_device_scale (surface, scale, scale);
+
+  return surface;
+}
+
+static void
+render_frame_background (MetaStyleInfo      *style_info,
+                         cairo_t            *cr,
+                         const GdkRectangle *visible_rect,
+                         int                 titlebar_height)
+{
+  GtkStyleContext *style;
+
+  style = style_info->styles[META_STYLE_ELEMENT_FRAME];
+  gtk_render_background (style, cr,
+                         visible_rect->x, visible_rect->y,
+                         visible_rect->width, visible_rect->height);
+  gtk_render_frame (style, cr,
+                    visible_rect->x, visible_rect->y,
+                    visible_rect->width, visible_rect->height);
+
+  style = style_info->styles[META_STYLE_ELEMENT_TITLEBAR];
+  gtk_render_background (style, cr,
+                         visible_rect->x, visible_rect->y,
+                         visible_rect->width, titlebar_height);
+  gtk_render_frame (style, cr,
+                    visible_rect->x, visible_rect->y,
+                    visible_rect->width, titlebar_height);
+}
+
+/* Paints @surface, @src_width by @src_height logical pixels, into @dest;
+ * the corners given by @slice are copied, and the edges and the center
+ * are stretched.
+ */
+static void
+draw_nine_slice (cairo_t            *cr,
+                 cairo_surface_t    *surface,
+                 int                 src_width,
+                 int                 src_height,
+                 const GtkBorder    *slice,
+                 const GdkRectangle *dest)
+{
+  const int src_x[4] = {
+    0, slice->left, src_width - slice->right, src_width
+  };
+  const int src_y[4] = {
+    0, slice->top, src_height - slice->bottom, src_height
+  };
+  const int dest_x[4] = {
+    dest->x,
+    dest->x + slice->left,
+    dest->x + dest->width - slice->right,
+    dest->x + dest->width
+  };
+  const int dest_y[4] = {
+    dest->y,
+    dest->y + slice->top,
+    dest->y + dest->height - slice->bottom,
+    dest->y + dest->height
+  };
+  int i, j;
+
+  for (j = 0; j < 3; j++)
+    {
+      for (i = 0; i < 3; i++)
+        {
+          int src_w = src_x[i + 1] - src_x[i];
+          int src_h = src_y[j + 1] - src_y[j];
+          int dest_w = dest_x[i + 1] - dest_x[i];
+          int dest_h = dest_y[j + 1] - dest_y[j];
+          cairo_pattern_t *pattern;
+
+          if (src_w <= 0 || src_h <= 0 || dest_w <= 0 || dest_h <= 0)
+            continue;
+
+          cairo_save (cr);
+
+          cairo_rectangle (cr, dest_x[i], dest_y[j], dest_w, dest_h);
+          cairo_clip (cr);
+
+          cairo_translate (cr, dest_x[i], dest_y[j]);
+          cairo_scale (cr, (double) dest_w / src_w, (double) dest_h / src_h);
+          cairo_set_source_surface (cr, surface, -src_x[i], -src_y[j]);
+
+          pattern = cairo_get_source (cr);
+          cairo_pattern_set_filter (pattern, CAIRO_FILTER_NEAREST);
+          cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+
+          cairo_paint (cr);
+
+          cairo_restore (cr);
+        }
+    }
+}
+
+static void
+draw_frame_background (MetaStyleInfo           *style_info,
+                       cairo_t                 *cr,
+                       const MetaFrameGeometry *fgeom,
+                       MetaFrameFlags           flags,
+                       const GdkRectangle      *visible_rect,
+                       int                      titlebar_height,
+                       int                      scale)
+{
+  MetaFramePartKey key;
+  GtkBorder slice;
+  cairo_surface_t *surface;
+  GdkRectangle template_rect;
+  const MetaFrameBorders *borders = &fgeom->borders;
+
+  slice.left = MAX (borders->visible.left,
+                    MAX (fgeom->top_left_corner_rounded_radius,
+                         fgeom->bottom_left_corner_rounded_radius));
+  slice.right = MAX (borders->visible.right,
+                     MAX (fgeom->top_right_corner_rounded_radius,
+                          fgeom->bottom_right_corner_rounded_radius));
+  slice.top = MAX (borders->visible.top,
+                   MAX (fgeom->top_left_corner_rounded_radius,
+                        fgeom->top_right_corner_rounded_radius));
+  slice.bottom = MAX (borders->visible.bottom,
+                      MAX (fgeom->bottom_left_corner_rounded_radius,
+                           fgeom->bottom_right_corner_rounded_radius));
+
+  slice.left = slice.left / scale + FRAME_SLICE_MARGIN;
+  slice.right = slice.right / scale + FRAME_SLICE_MARGIN;
+  slice.top = slice.top / scale + FRAME_SLICE_MARGIN;
+  slice.bottom = slice.bottom / scale + FRAME_SLICE_MARGIN;
+
+  /* The template has a single stretchable row and column; frames that
+   * are too small to be sliced are rendered directly
+   */
+  template_rect.x = 0;
+  template_rect.y = 0;
+  template_rect.width = slice.left + 1 + slice.right;
+  template_rect.height = slice.top + 1 + slice.bottom;
+
+  if (visible_rect->width < template_rect.width ||
+      visible_rect->height < template_rect.height)
+    {
+      render_frame_background (style_info, cr, visible_rect, titlebar_height);
+      return;
+    }
+
+  memset (&key, 0, sizeof (key));
+  key.part = META_FRAME_PART_BACKGROUND;
+  key.frame_flags = flags;
+  key.scale = scale;
+  key.width = template_rect.width;
+  key.height = template_rect.height;
+  key.titlebar_height = titlebar_height;
+  key.slice_left = slice.left;
+  key.slice_right = slice.right;
+  key.slice_top = slice.top;
+  key.slice_bottom = slice.bottom;
+
+  surface = lookup_frame_part (style_info, &key);
+  if (surface == NULL)
+    {
+      cairo_t *template_cr;
+
+      surface = create_frame_part_surface (cr,
+                                           template_rect.width,
+                                           template_rect.height,
+                                           scale);
+
+      template_cr = cairo_create (surface);
+      render_frame_background (style_info, template_cr,
+                               &template_rect, titlebar_height);
+      cairo_destroy (template_cr);
+
+      insert_frame_part (style_info, &key, surface);
+      cairo_surface_destroy (surface);
+    }
+
+  draw_nine_slice (cr, surface,
+                   template_rect.width, template_rect.height,
+                   &slice, visible_rect);
+}
+
+static void
+render_button (MetaFrameLayout    *layout,
+               GtkStyleContext    *style,
+               cairo_t            *cr,
+               MetaButtonType      button_type,
+               MetaFrameFlags      flags,
+               const GdkRectangle *button_rect,
+               int                 scale)
+{
+  cairo_surface_t *surface = NULL;
+  const char *icon_name = NULL;
+
+  gtk_render_background (style, cr,
+                         button_rect->x, button_rect->y,
+                         button_rect->width, button_rect->height);
+  gtk_render_frame (style, cr,
+                    button_rect->x, button_rect->y,
+                    button_rect->width, button_rect->height);
+
+  switch (button_type)
+    {
+    case META_BUTTON_TYPE_CLOSE:
+       icon_name = "window-close-symbolic";
+       break;
+    case META_BUTTON_TYPE_MAXIMIZE:
+       if (flags & META_FRAME_MAXIMIZED)
+         icon_name = "window-restore-symbolic";
+       else
+         icon_name = "window-maximize-symbolic";
+       break;
+    case META_BUTTON_TYPE_MINIMIZE:
+       icon_name = "window-minimize-symbolic";
+       break;
+    case META_BUTTON_TYPE_MENU:
+       icon_name = "open-menu-symbolic";
+       break;
+    default:
+       icon_name = NULL;
+       break;
+    }
+
+  if (icon_name)
+    {
+      GtkIconTheme *theme = gtk_icon_theme_get_default ();
+      GtkIconInfo *info;
+      GdkPixbuf *pixbuf;
+
+      info = gtk_icon_theme_lookup_icon_for_scale (theme, icon_name,
+                                                   layout->icon_size, scale, 0);
+      pixbuf = gtk_icon_info_load_symbolic_for_context (info, style, NULL, NULL);
+      surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
+    }
+
+  if (surface)
+    {
+      float width, height;
+      int x, y;
+
+      width = cairo_image_surface_get_width (surface) / scale;
+      height = cairo_image_surface_get_height (surface) / scale;
+      x = button_rect->x + (button_rect->width - layout->icon_size) / 2;
+      y = button_rect->y + (button_rect->height - layout->icon_size) / 2;
+
+      cairo_save (cr);
+      cairo_translate (cr, x, y);
+      cairo_scale (cr,
+                   layout->icon_size / width,
+                   layout->icon_size / height);
+      cairo_set_source_surface (cr, surface, 0, 0);
+      cairo_paint (cr);
+      cairo_restore (cr);
+
+      cairo_surface_destroy (surface);
+    }
+}
+
+static void
+draw_button (MetaFrameLayout    *layout,
+             MetaStyleInfo      *style_info,
+             cairo_t            *cr,
+             MetaButtonType      button_type,
+             MetaButtonState     button_state,
+             MetaFrameFlags      flags,
+             const GdkRectangle *button_rect,
+             int                 scale)
+{
+  MetaFramePartKey key;
+  cairo_surface_t *surface;
+
+  memset (&key, 0, sizeof (key));
+  key.part = META_FRAME_PART_BUTTON;
+  key.frame_flags = flags;
+  key.scale = scale;
+  key.width = button_rect->width;
+  key.height = button_rect->height;
+  key.button_type = button_type;
+  key.button_state = button_state;
+  key.icon_size = layout->icon_size;
+
+  surface = lookup_frame_part (style_info, &key);
+  if (surface == NULL)
+    {
+      GtkStyleContext *style = style_info->styles[META_STYLE_ELEMENT_BUTTON];
+      GtkStateFlags state = gtk_style_context_get_state (style);
+      const char *button_class = get_class_from_button_type (button_type);
+      GdkRectangle rect = { 0, 0, button_rect->width, button_rect->height };
+      cairo_t *button_cr;
+
+      if (button_class)
+        gtk_style_context_add_class (style, button_class);
+
+      if (button_state == META_BUTTON_STATE_PRELIGHT)
+        gtk_style_context_set_state (style, state | GTK_STATE_PRELIGHT);
+      else if (button_state == META_BUTTON_STATE_PRESSED)
+        gtk_style_context_set_state (style, state | GTK_STATE_ACTIVE);
+
+      surface = create_frame_part_surface (cr,
+                                           button_rect->width,
+                                           button_rect->height,
+                                           scale);
+
+      button_cr = cairo_create (surface);
+      render_button (layout, style, button_cr, button_type, flags,
+                     &rect, scale);
+      cairo_destroy (button_cr);
+
+      if (button_class)
+        gtk_style_context_remove_class (style, button_class);
+      gtk_style_context_set_state (style, state);
+
+      insert_frame_part (style_info, &key, surface);
+      cairo_surface_destroy (surface);
+    }
+
+  cairo_set_source_surface (cr, surface, button_rect->x, button_rect->y);
+  cairo_paint (cr);
+}
+
 static void
 meta_frame_layout_draw_with_style (MetaFrameLayout         *layout,
                                    MetaStyleInfo           *style_info,
@@ -715,7 +1136,6 @@ meta_frame_layout_draw_with_style (MetaFrameLayout         *layout,
                                    cairo_surface_t         *mini_icon)
 {
   GtkStyleContext *style;
-  GtkStateFlags state;
   MetaButtonType button_type;
   GdkRectangle visible_rect;
   GdkRectangle titlebar_rect;
@@ -753,26 +1173,13 @@ meta_frame_layout_draw_with_style (MetaFrameLayout         *layout,
 
   meta_style_info_set_flags (style_info, flags);
 
-  style = style_info->styles[META_STYLE_ELEMENT_FRAME];
-  gtk_render_background (style, cr,
-                         visible_rect.x, visible_rect.y,
-                         visible_rect.width, visible_rect.height);
-  gtk_render_frame (style, cr,
-                    visible_rect.x, visible_rect.y,
-                    visible_rect.width, visible_rect.height);
-
   titlebar_rect.x = visible_rect.x;
   titlebar_rect.y = visible_rect.y;
   titlebar_rect.width = visible_rect.width;
   titlebar_rect.height = borders->visible.top / scale;
 
-  style = style_info->styles[META_STYLE_ELEMENT_TITLEBAR];
-  gtk_render_background (style, cr,
-                         titlebar_rect.x, titlebar_rect.y,
-                         titlebar_rect.width, titlebar_rect.height);
-  gtk_render_frame (style, cr,
-                    titlebar_rect.x, titlebar_rect.y,
-                    titlebar_rect.width, titlebar_rect.height);
+  draw_frame_background (style_info, cr, fgeom, flags,
+                         &visible_rect, titlebar_rect.height, scale);
 
   if (layout->has_title && title_layout)
     {
@@ -800,14 +1207,8 @@ meta_frame_layout_draw_with_style (MetaFrameLayout         *layout,
       gtk_render_layout (style, cr, x, y, title_layout);
     }
 
-  style = style_info->styles[META_STYLE_ELEMENT_BUTTON];
-  state = gtk_style_context_get_state (style);
   for (button_type = META_BUTTON_TYPE_CLOSE; button_type < META_BUTTON_TYPE_LAST; button_type++)
     {
-      const char *button_class = get_class_from_button_type (button_type);
-      if (button_class)
-        gtk_style_context_add_class (style, button_class);
-
       get_button_rect (button_type, fgeom, &button_rect);
 
       button_rect.x /= scale;
@@ -815,85 +1216,10 @@ meta_frame_layout_draw_with_style (MetaFrameLayout         *layout,
       button_rect.width /= scale;
       button_rect.height /= scale;
 
-      if (button_states[button_type] == META_BUTTON_STATE_PRELIGHT)
-        gtk_style_context_set_state (style, state | GTK_STATE_PRELIGHT);
-      else if (button_states[button_type] == META_BUTTON_STATE_PRESSED)
-        gtk_style_context_set_state (style, state | GTK_STATE_ACTIVE);
-      else
-        gtk_style_context_set_state (style, state);
-
-      cairo_save (cr);
-
       if (button_rect.width > 0 && button_rect.height > 0)
-        {
-          cairo_surface_t *surface = NULL;
-          const char *icon_name = NULL;
-
-          gtk_render_background (style, cr,
-                                 button_rect.x, button_rect.y,
-                                 button_rect.width, button_rect.height);
-          gtk_render_frame (style, cr,
-                            button_rect.x, button_rect.y,
-                            button_rect.width, button_rect.height);
-
-          switch (button_type)
-            {
-            case META_BUTTON_TYPE_CLOSE:
-               icon_name = "window-close-symbolic";
-               break;
-            case META_BUTTON_TYPE_MAXIMIZE:
-               if (flags & META_FRAME_MAXIMIZED)
-                 icon_name = "window-restore-symbolic";
-               else
-                 icon_name = "window-maximize-symbolic";
-               break;
-            case META_BUTTON_TYPE_MINIMIZE:
-               icon_name = "window-minimize-symbolic";
-               break;
-            case META_BUTTON_TYPE_MENU:
-               icon_name = "open-menu-symbolic";
-               break;
-            default:
-               icon_name = NULL;
-               break;
-            }
-
-          if (icon_name)
-            {
-              GtkIconTheme *theme = gtk_icon_theme_get_default ();
-              GtkIconInfo *info;
-              GdkPixbuf *pixbuf;
-
-              info = gtk_icon_theme_lookup_icon_for_scale (theme, icon_name,
-                                                           layout->icon_size, scale, 0);
-              pixbuf = gtk_icon_info_load_symbolic_for_context (info, style, NULL, NULL);
-              surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
-            }
-
-          if (surface)
-            {
-              float width, height;
-              int x, y;
-
-              width = cairo_image_surface_get_width (surface) / scale;
-              height = cairo_image_surface_get_height (surface) / scale;
-              x = button_rect.x + (button_rect.width - layout->icon_size) / 2;
-              y = button_rect.y + (button_rect.height - layout->icon_size) / 2;
-
-              cairo_translate (cr, x, y);
-              cairo_scale (cr,
-                           layout->icon_size / width,
-                           layout->icon_size / height);
-              cairo_set_source_surface (cr, surface, 0, 0);
-              cairo_paint (cr);
-
-              cairo_surface_destroy (surface);
-            }
-        }
-      cairo_restore (cr);
-      if (button_class)
-        gtk_style_context_remove_class (style, button_class);
-      gtk_style_context_set_state (style, state);
+        draw_button (layout, style_info, cr,
+                     button_type, button_states[button_type], flags,
+                     &button_rect, scale);
     }
 
   cairo_surface_set_device_scale (frame_surface, xscale, yscale);
@@ -1133,6 +1459,7 @@ meta_style_info_unref (MetaStyleInfo *style_info)
       int i;
       for (i = 0; i < META_STYLE_ELEMENT_LAST; i++)
         g_object_unref (style_info->styles[i]);
+      g_clear_pointer (&style_info->part_cache, g_hash_table_destroy);
       g_free (style_info);
     }
 }
@@ -58,6 +58,11 @@
 #include "meta/util.h"
 #include "wayland/meta-wayland-dma-buf.h"
 
+#ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-drm-buffer-gbm.h"
+#include "backends/native/meta-renderer-native.h"
+#endif
+
 #ifndef DRM_FORMAT_MOD_INVALID
 #define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
 #endif
@@ -587,6 +592,157 @@ meta_wayland_buffer_process_damage (MetaWaylandBuffer *buffer,
     }
 }
 
+void
+meta_wayland_buffer_send_release (MetaWaylandBuffer *buffer)
+{
+  if (!buffer->resource)
+    return;
+
+  if (buffer->scanout.is_held)
+    {
+      buffer->scanout.n_pending_releases++;
+      return;
+    }
+
+  wl_buffer_send_release (buffer->resource);
+}
+
+/* The buffer owns a toggle reference on its scanout, so this is called
+ * whenever the scanout gets used for a frame, and once it is not anymore.
+ */
+static void
+scanout_toggle_notify (gpointer  data,
+                       GObject  *object,
+                       gboolean  is_last_ref)
+{
+  MetaWaylandBuffer *buffer = data;
+
+  buffer->scanout.is_held = !is_last_ref;
+  if (buffer->scanout.is_held)
+    return;
+
+  while (buffer->scanout.n_pending_releases > 0)
+    {
+      buffer->scanout.n_pending_releases--;
+      if (buffer->resource)
+        wl_buffer_send_release (buffer->resource);
+    }
+}
+
+#ifdef HAVE_NATIVE_BACKEND
+static CoglScanout *
+try_acquire_egl_image_scanout (MetaWaylandBuffer *buffer,
+                               CoglOnscreen      *onscreen)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaRendererNative *renderer_native;
+  MetaGpuKms *gpu_kms;
+  struct gbm_device *gbm_device;
+  struct gbm_bo *gbm_bo;
+  MetaDrmBufferGbm *fb;
+  g_autoptr (GError) error = NULL;
+
+  if (!META_IS_RENDERER_NATIVE (renderer))
+    return NULL;
+
+  renderer_native = META_RENDERER_NATIVE (renderer);
+  gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
+  gbm_device = meta_gbm_device_from_gpu (gpu_kms);
+  if (!gbm_device)
+    return NULL;
+
+  gbm_bo = gbm_bo_import (gbm_device,
+                          GBM_BO_IMPORT_WL_BUFFER, buffer->resource,
+                          GBM_BO_USE_SCANOUT);
+  if (!gbm_bo)
+    return NULL;
+
+  if (gbm_bo_get_width (gbm_bo) !=
+      cogl_framebuffer_get_width (COGL_FRAMEBUFFER (onscreen)) ||
+      gbm_bo_get_height (gbm_bo) !=
+      cogl_framebuffer_get_height (COGL_FRAMEBUFFER (onscreen)))
+    {
+      gbm_bo_destroy (gbm_bo);
+      return NULL;
+    }
+
+  fb = meta_drm_buffer_gbm_new_take (gpu_kms, gbm_bo,
+                                     meta_renderer_native_use_modifiers (renderer_native),
+                                     &error);
+  if (!fb)
+    {
+      g_debug ("Failed to create scanout buffer: %s", error->message);
+      gbm_bo_destroy (gbm_bo);
+      return NULL;
+    }
+
+  return COGL_SCANOUT (fb);
+}
+#endif /* HAVE_NATIVE_BACKEND */
+
+/**
+ * meta_wayland_buffer_try_acquire_scanout:
+ * @buffer: a #MetaWaylandBuffer
+ * @onscreen: the #CoglOnscreen the buffer would be presented on
+ *
+ * Tries to wrap @buffer into something that can be put on screen as is. As
+ * long as the returned scanout is referenced, wl_buffer.release is not sent
+ * for @buffer. The buffer is imported once and the scanout is reused for
+ * as long as @buffer lives.
+ *
+ * Returns: (transfer full) (nullable): A #CoglScanout, or %NULL.
+ */
+CoglScanout *
+meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer *buffer,
+                                         CoglOnscreen      *onscreen)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  CoglScanout *scanout = NULL;
+
+  if (!buffer->resource)
+    return NULL;
+
+  if (buffer->scanout.scanout)
+    {
+      if (buffer->scanout.width != cogl_framebuffer_get_width (framebuffer) ||
+          buffer->scanout.height != cogl_framebuffer_get_height (framebuffer))
+        return NULL;
+
+      return g_object_ref (buffer->scanout.scanout);
+    }
+
+  switch (buffer->type)
+    {
+    case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+#ifdef HAVE_NATIVE_BACKEND
+      scanout = try_acquire_egl_image_scanout (buffer, onscreen);
+#endif
+      break;
+    case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
+      scanout = meta_wayland_dma_buf_try_acquire_scanout (buffer->dma_buf.dma_buf,
+                                                          onscreen);
+      break;
+    case META_WAYLAND_BUFFER_TYPE_SHM:
+#ifdef HAVE_WAYLAND_EGLSTREAM
+    case META_WAYLAND_BUFFER_TYPE_EGL_STREAM:
+#endif
+    case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
+      break;
+    }
+
+  if (!scanout)
+    return NULL;
+
+  buffer->scanout.scanout = scanout;
+  buffer->scanout.width = cogl_framebuffer_get_width (framebuffer);
+  buffer->scanout.height = cogl_framebuffer_get_height (framebuffer);
+  g_object_add_toggle_ref (G_OBJECT (scanout), scanout_toggle_notify, buffer);
+  buffer->scanout.is_held = TRUE;
+
+  return scanout;
+}
+
 static void
 meta_wayland_buffer_finalize (GObject *object)
 {
@@ -600,6 +756,13 @@ meta_wayland_buffer_finalize (GObject *object)
   g_clear_pointer (&buffer->dma_buf.texture, cogl_object_unref);
   g_clear_object (&buffer->dma_buf.dma_buf);
 
+  if (buffer->scanout.scanout)
+    {
+      g_object_remove_toggle_ref (G_OBJECT (buffer->scanout.scanout),
+                                  scanout_toggle_notify, buffer);
+      buffer->scanout.scanout = NULL;
+    }
+
   G_OBJECT_CLASS (meta_wayland_buffer_parent_class)->finalize (object);
 }
 
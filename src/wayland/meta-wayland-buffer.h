@@ -70,6 +70,16 @@ struct _MetaWaylandBuffer
     MetaWaylandDmaBufBuffer *dma_buf;
     CoglTexture *texture;
   } dma_buf;
+
+  /* The imported scanout is kept for as long as the buffer lives, and
+   * wl_buffer.release is held back while anyone else references it */
+  struct {
+    CoglScanout *scanout;
+    int width;
+    int height;
+    gboolean is_held;
+    unsigned int n_pending_releases;
+  } scanout;
 };
 
 #define META_TYPE_WAYLAND_BUFFER (meta_wayland_buffer_get_type ())
@@ -89,5 +99,8 @@ gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuff
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  CoglTexture           *texture,
                                                                  cairo_region_t        *region);
+void                    meta_wayland_buffer_send_release        (MetaWaylandBuffer     *buffer);
+CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
+                                                                 CoglOnscreen          *onscreen);
 
 #endif /* META_WAYLAND_BUFFER_H */
@@ -51,6 +51,11 @@
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-versions.h"
 
+#ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-drm-buffer-gbm.h"
+#include "backends/native/meta-renderer-native.h"
+#endif
+
 #include "linux-dmabuf-unstable-v1-server-protocol.h"
 
 #ifndef DRM_FORMAT_MOD_INVALID
@@ -180,6 +185,91 @@ meta_wayland_dma_buf_buffer_attach (MetaWaylandBuffer  *buffer,
   return TRUE;
 }
 
+/**
+ * meta_wayland_dma_buf_try_acquire_scanout:
+ * @dma_buf: a #MetaWaylandDmaBufBuffer
+ * @onscreen: the #CoglOnscreen the buffer would be presented on
+ *
+ * Imports @dma_buf as a framebuffer that can be scanned out on @onscreen.
+ * Only buffers matching the size of @onscreen are accepted.
+ *
+ * Returns: (transfer full) (nullable): A #CoglScanout, or %NULL.
+ */
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandDmaBufBuffer *dma_buf,
+                                          CoglOnscreen            *onscreen)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaRendererNative *renderer_native;
+  MetaGpuKms *gpu_kms;
+  struct gbm_device *gbm_device;
+  struct gbm_import_fd_modifier_data import_with_modifier;
+  struct gbm_bo *gbm_bo;
+  MetaDrmBufferGbm *fb;
+  gboolean use_modifiers;
+  g_autoptr (GError) error = NULL;
+  unsigned int i;
+
+  if (!META_IS_RENDERER_NATIVE (renderer))
+    return NULL;
+
+  if (dma_buf->width != cogl_framebuffer_get_width (COGL_FRAMEBUFFER (onscreen)) ||
+      dma_buf->height != cogl_framebuffer_get_height (COGL_FRAMEBUFFER (onscreen)))
+    return NULL;
+
+  renderer_native = META_RENDERER_NATIVE (renderer);
+  use_modifiers = meta_renderer_native_use_modifiers (renderer_native);
+  if (dma_buf->drm_modifier != DRM_FORMAT_MOD_INVALID && !use_modifiers)
+    return NULL;
+
+  gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
+  gbm_device = meta_gbm_device_from_gpu (gpu_kms);
+  if (!gbm_device)
+    return NULL;
+
+  import_with_modifier = (struct gbm_import_fd_modifier_data) {
+    .width = dma_buf->width,
+    .height = dma_buf->height,
+    .format = dma_buf->drm_format,
+    .modifier = dma_buf->drm_modifier,
+  };
+
+  for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
+    {
+      if (dma_buf->fds[i] < 0)
+        break;
+
+      import_with_modifier.fds[i] = dma_buf->fds[i];
+      import_with_modifier.strides[i] = dma_buf->strides[i];
+      import_with_modifier.offsets[i] = dma_buf->offsets[i];
+    }
+  import_with_modifier.num_fds = i;
+
+  gbm_bo = gbm_bo_import (gbm_device,
+                          GBM_BO_IMPORT_FD_MODIFIER,
+                          &import_with_modifier,
+                          GBM_BO_USE_SCANOUT);
+  if (!gbm_bo)
+    return NULL;
+
+  fb = meta_drm_buffer_gbm_new_take (gpu_kms, gbm_bo,
+                                     dma_buf->drm_modifier != DRM_FORMAT_MOD_INVALID,
+                                     &error);
+  if (!fb)
+    {
+      g_debug ("Failed to create scanout buffer: %s", error->message);
+      gbm_bo_destroy (gbm_bo);
+      return NULL;
+    }
+
+  return COGL_SCANOUT (fb);
+#else
+  return NULL;
+#endif
+}
+
 static void
 buffer_params_add (struct wl_client   *client,
                    struct wl_resource *resource,
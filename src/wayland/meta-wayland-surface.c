@@ -394,8 +394,32 @@ meta_wayland_surface_unref_buffer_use_count (MetaWaylandSurface *surface)
 
   g_return_if_fail (buffer);
 
-  if (surface->buffer_ref.use_count == 0 && buffer->resource)
-    wl_buffer_send_release (buffer->resource);
+  if (surface->buffer_ref.use_count == 0)
+    meta_wayland_buffer_send_release (buffer);
+}
+
+/*
+ * meta_wayland_surface_try_acquire_scanout:
+ *
+ * Returns a #CoglScanout that presents the current buffer of @surface
+ * directly on @onscreen, or %NULL if the buffer can not be used for that.
+ */
+CoglScanout *
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
+                                          CoglOnscreen       *onscreen)
+{
+  if (!surface->buffer_ref.buffer ||
+      surface->buffer_ref.use_count == 0)
+    return NULL;
+
+  if (surface->scale != 1 ||
+      surface->buffer_transform != META_MONITOR_TRANSFORM_NORMAL ||
+      surface->viewport.has_src_rect ||
+      surface->viewport.has_dst_size)
+    return NULL;
+
+  return meta_wayland_buffer_try_acquire_scanout (surface->buffer_ref.buffer,
+                                                  onscreen);
 }
 
 static void
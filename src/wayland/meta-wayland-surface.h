@@ -249,6 +249,9 @@ void                meta_wayland_surface_ref_buffer_use_count (MetaWaylandSurfac
 
 void                meta_wayland_surface_unref_buffer_use_count (MetaWaylandSurface *surface);
 
+CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
+                                                              CoglOnscreen       *onscreen);
+
 void                meta_wayland_surface_set_window (MetaWaylandSurface *surface,
                                                      MetaWindow         *window);
 
@@ -27,6 +27,7 @@
 #include <X11/Xatom.h>
 #include <X11/XKBlib.h>
 #include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
 #include <X11/extensions/shape.h>
 
 #include "backends/meta-cursor-tracker-private.h"
@@ -45,6 +46,7 @@
 #include "x11/meta-x11-selection-private.h"
 #include "x11/meta-x11-selection-input-stream-private.h"
 #include "x11/meta-x11-selection-output-stream-private.h"
+#include "x11/window-props.h"
 #include "x11/window-x11.h"
 #include "x11/xprops.h"
 
@@ -1753,6 +1755,43 @@ process_selection_event (MetaX11Display *x11_display,
   return handled;
 }
 
+/* Property reloads are deferred to coalesce bursts of changes, but
+ * requests and focus or selection changes must be handled with the
+ * properties the client set before sending them.
+ */
+static gboolean
+event_needs_property_reloads (MetaX11Display *x11_display,
+                              XEvent         *event)
+{
+  XIEvent *input_event;
+
+  switch (event->type)
+    {
+    case ClientMessage:
+    case ConfigureRequest:
+    case MapRequest:
+    case FocusIn:
+    case FocusOut:
+    case SelectionClear:
+    case SelectionRequest:
+    case SelectionNotify:
+      return TRUE;
+    default:
+      break;
+    }
+
+  if (event->type - x11_display->xfixes_event_base == XFixesSelectionNotify)
+    return TRUE;
+
+  input_event = get_input_event (x11_display, event);
+  if (input_event &&
+      (input_event->evtype == XI_FocusIn ||
+       input_event->evtype == XI_FocusOut))
+    return TRUE;
+
+  return FALSE;
+}
+
 /**
  * meta_display_handle_xevent:
  * @display: The MetaDisplay that events are coming from
@@ -1784,6 +1823,9 @@ meta_x11_display_handle_xevent (MetaX11Display *x11_display,
   meta_spew_event_print (x11_display, event);
 #endif
 
+  if (event_needs_property_reloads (x11_display, event))
+    meta_x11_display_flush_property_reloads (x11_display);
+
   if (meta_x11_startup_notification_handle_xevent (x11_display, event))
     {
       bypass_gtk = bypass_compositor = TRUE;
@@ -32,85 +32,297 @@
 #include "meta/meta-x11-errors.h"
 #include "x11/meta-x11-display-private.h"
 
+/* How much of _NET_WM_ICON is fetched up front, in 32-bit items. Icon lists
+ * that fit are read in a single request; for larger ones, only the headers
+ * and the pixels of the sizes we pick are transferred.
+ */
+#define NET_WM_ICON_PREFIX_ITEMS 4096
+
+typedef struct
+{
+  gulong offset; /* of the pixel data, in items */
+  int width;
+  int height;
+} NetWmIconEntry;
+
+typedef struct
+{
+  int width;
+  int height;
+  guint hash;
+} SharedIconKey;
+
+/* Decoded _NET_WM_ICON images, shared between all windows using the same
+ * image; entries are removed when the last user drops the surface. */
+static GHashTable *shared_icons = NULL;
+static cairo_user_data_key_t shared_icon_key;
+
+static guint
+shared_icon_key_hash (gconstpointer key)
+{
+  const SharedIconKey *icon_key = key;
+
+  return icon_key->hash ^ (icon_key->width << 16) ^ icon_key->height;
+}
+
 static gboolean
-find_largest_sizes (gulong *data,
-                    gulong  nitems,
-                    int    *width,
-                    int    *height)
+shared_icon_key_equal (gconstpointer a,
+                       gconstpointer b)
 {
-  *width = 0;
-  *height = 0;
+  const SharedIconKey *key_a = a;
+  const SharedIconKey *key_b = b;
 
-  while (nitems > 0)
-    {
-      int w, h;
+  return (key_a->width == key_b->width &&
+          key_a->height == key_b->height &&
+          key_a->hash == key_b->hash);
+}
 
-      if (nitems < 3)
-        return FALSE; /* no space for w, h */
+static void
+shared_icon_destroyed (gpointer data)
+{
+  SharedIconKey *key = data;
+
+  g_hash_table_remove (shared_icons, key);
+  g_free (key);
+}
 
-      w = data[0];
-      h = data[1];
+static guint
+hash_argb_data (const gulong *argb_data,
+                int           n_pixels)
+{
+  guint hash = 5381;
+  int i;
 
-      if (nitems < ((gulong)(w * h) + 2))
-        return FALSE; /* not enough data */
+  for (i = 0; i < n_pixels; i++)
+    hash = (hash << 5) + hash + (uint32_t) argb_data[i];
+
+  return hash;
+}
+
+static gboolean
+surface_matches_argb_data (cairo_surface_t *surface,
+                           const gulong    *argb_data)
+{
+  int w = cairo_image_surface_get_width (surface);
+  int h = cairo_image_surface_get_height (surface);
+  int stride = cairo_image_surface_get_stride (surface) / sizeof (uint32_t);
+  const uint32_t *data;
+  int y, x;
 
-      *width = MAX (w, *width);
-      *height = MAX (h, *height);
+  cairo_surface_flush (surface);
+  data = (const uint32_t *) cairo_image_surface_get_data (surface);
 
-      data += (w * h) + 2;
-      nitems -= (w * h) + 2;
+  for (y = 0; y < h; y++)
+    {
+      for (x = 0; x < w; x++)
+        {
+          if (data[y * stride + x] != (uint32_t) argb_data[y * w + x])
+            return FALSE;
+        }
     }
 
   return TRUE;
 }
 
+static cairo_surface_t *
+argbdata_to_surface (gulong *argb_data, int w, int h)
+{
+  cairo_surface_t *surface;
+  int y, x, stride;
+  uint32_t *data;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, w, h);
+  stride = cairo_image_surface_get_stride (surface) / sizeof (uint32_t);
+  data = (uint32_t *) cairo_image_surface_get_data (surface);
+
+  /* One could speed this up a lot. */
+  for (y = 0; y < h; y++)
+    {
+      for (x = 0; x < w; x++)
+        {
+          uint32_t *p = &data[y * stride + x];
+          gulong *d = &argb_data[y * w + x];
+          *p = *d;
+        }
+    }
+
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
+static cairo_surface_t *
+get_shared_icon_surface (gulong *argb_data,
+                         int     w,
+                         int     h)
+{
+  SharedIconKey key;
+  SharedIconKey *new_key;
+  cairo_surface_t *surface;
+
+  if (!shared_icons)
+    shared_icons = g_hash_table_new (shared_icon_key_hash,
+                                     shared_icon_key_equal);
+
+  key.width = w;
+  key.height = h;
+  key.hash = hash_argb_data (argb_data, w * h);
+
+  surface = g_hash_table_lookup (shared_icons, &key);
+  if (surface)
+    {
+      /* On a hash collision, just don't share */
+      if (surface_matches_argb_data (surface, argb_data))
+        return cairo_surface_reference (surface);
+      else
+        return argbdata_to_surface (argb_data, w, h);
+    }
+
+  surface = argbdata_to_surface (argb_data, w, h);
+
+  new_key = g_memdup (&key, sizeof (SharedIconKey));
+  if (cairo_surface_set_user_data (surface, &shared_icon_key, new_key,
+                                   shared_icon_destroyed) != CAIRO_STATUS_SUCCESS)
+    {
+      g_free (new_key);
+      return surface;
+    }
+
+  g_hash_table_insert (shared_icons, new_key, surface);
+
+  return surface;
+}
+
 static gboolean
-find_best_size (gulong  *data,
-                gulong   nitems,
-                int      ideal_width,
-                int      ideal_height,
-                int     *width,
-                int     *height,
-                gulong **start)
+get_net_wm_icon_range (MetaX11Display  *x11_display,
+                       Window           xwindow,
+                       long             offset,
+                       long             length,
+                       gulong         **data,
+                       gulong          *nitems,
+                       gulong          *bytes_after)
 {
-  int best_w;
-  int best_h;
-  gulong *best_start;
-  int max_width, max_height;
+  Atom type;
+  int format;
+  int result, err;
+  guchar *raw_data;
 
-  *width = 0;
-  *height = 0;
-  *start = NULL;
+  meta_x11_error_trap_push (x11_display);
+  type = None;
+  raw_data = NULL;
+  result = XGetWindowProperty (x11_display->xdisplay,
+                               xwindow,
+                               x11_display->atom__NET_WM_ICON,
+                               offset, length,
+                               False, XA_CARDINAL, &type, &format, nitems,
+                               bytes_after, &raw_data);
+  err = meta_x11_error_trap_pop_with_return (x11_display);
 
-  if (!find_largest_sizes (data, nitems, &max_width, &max_height))
+  if (err != Success ||
+      result != Success)
     return FALSE;
 
-  if (ideal_width < 0)
-    ideal_width = max_width;
-  if (ideal_height < 0)
-    ideal_height = max_height;
+  if (type != XA_CARDINAL || format != 32)
+    {
+      XFree (raw_data);
+      return FALSE;
+    }
 
-  best_w = 0;
-  best_h = 0;
-  best_start = NULL;
+  *data = (gulong *) raw_data;
 
-  while (nitems > 0)
-    {
-      int w, h;
-      gboolean replace;
+  return TRUE;
+}
 
-      replace = FALSE;
+/* Walks the list of images in _NET_WM_ICON, reading the headers that are
+ * not in @prefix one by one, without transferring any pixel data. */
+static gboolean
+collect_icon_entries (MetaX11Display *x11_display,
+                      Window          xwindow,
+                      gulong         *prefix,
+                      gulong          prefix_items,
+                      gulong          total_items,
+                      GArray         *entries)
+{
+  gulong offset = 0;
 
-      if (nitems < 3)
+  while (offset < total_items)
+    {
+      NetWmIconEntry entry;
+      gulong w, h;
+
+      if (total_items - offset < 3)
         return FALSE; /* no space for w, h */
 
-      w = data[0];
-      h = data[1];
+      if (offset + 2 <= prefix_items)
+        {
+          w = prefix[offset];
+          h = prefix[offset + 1];
+        }
+      else
+        {
+          gulong *header;
+          gulong nitems, bytes_after;
+
+          if (!get_net_wm_icon_range (x11_display, xwindow, offset, 2,
+                                      &header, &nitems, &bytes_after))
+            return FALSE;
+
+          if (nitems < 2)
+            {
+              XFree (header);
+              return FALSE;
+            }
+
+          w = header[0];
+          h = header[1];
+          XFree (header);
+        }
+
+      if (w > G_MAXUINT16 || h > G_MAXUINT16)
+        return FALSE;
+
+      if (total_items - offset - 2 < w * h)
+        return FALSE; /* not enough data */
+
+      entry.offset = offset + 2;
+      entry.width = w;
+      entry.height = h;
+      g_array_append_val (entries, entry);
 
-      if (nitems < ((gulong)(w * h) + 2))
-        break; /* not enough data */
+      offset += (w * h) + 2;
+    }
+
+  return entries->len > 0;
+}
+
+static NetWmIconEntry *
+find_best_size (GArray *entries,
+                int     ideal_width,
+                int     ideal_height)
+{
+  NetWmIconEntry *best = NULL;
+  int max_width = 0, max_height = 0;
+  guint i;
+
+  for (i = 0; i < entries->len; i++)
+    {
+      NetWmIconEntry *entry = &g_array_index (entries, NetWmIconEntry, i);
+
+      max_width = MAX (max_width, entry->width);
+      max_height = MAX (max_height, entry->height);
+    }
+
+  if (ideal_width < 0)
+    ideal_width = max_width;
+  if (ideal_height < 0)
+    ideal_height = max_height;
 
-      if (best_start == NULL)
+  for (i = 0; i < entries->len; i++)
+    {
+      NetWmIconEntry *entry = &g_array_index (entries, NetWmIconEntry, i);
+      gboolean replace = FALSE;
+
+      if (best == NULL)
         {
           replace = TRUE;
         }
@@ -118,8 +330,8 @@ find_best_size (gulong  *data,
         {
           /* work with averages */
           const int ideal_size = (ideal_width + ideal_height) / 2;
-          int best_size = (best_w + best_h) / 2;
-          int this_size = (w + h) / 2;
+          int best_size = (best->width + best->height) / 2;
+          int this_size = (entry->width + entry->height) / 2;
 
           /* larger than desired is always better than smaller */
           if (best_size < ideal_size &&
@@ -139,50 +351,42 @@ find_best_size (gulong  *data,
         }
 
       if (replace)
-        {
-          best_start = data + 2;
-          best_w = w;
-          best_h = h;
-        }
-
-      data += (w * h) + 2;
-      nitems -= (w * h) + 2;
+        best = entry;
     }
 
-  if (best_start)
-    {
-      *start = best_start;
-      *width = best_w;
-      *height = best_h;
-      return TRUE;
-    }
-  else
-    return FALSE;
+  return best;
 }
 
 static cairo_surface_t *
-argbdata_to_surface (gulong *argb_data, int w, int h)
+load_icon_entry (MetaX11Display *x11_display,
+                 Window          xwindow,
+                 NetWmIconEntry *entry,
+                 gulong         *prefix,
+                 gulong          prefix_items)
 {
+  gulong n_pixels = (gulong) entry->width * entry->height;
   cairo_surface_t *surface;
-  int y, x, stride;
-  uint32_t *data;
+  gulong *pixels;
+  gulong nitems, bytes_after;
 
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, w, h);
-  stride = cairo_image_surface_get_stride (surface) / sizeof (uint32_t);
-  data = (uint32_t *) cairo_image_surface_get_data (surface);
+  if (entry->offset + n_pixels <= prefix_items)
+    return get_shared_icon_surface (prefix + entry->offset,
+                                    entry->width, entry->height);
 
-  /* One could speed this up a lot. */
-  for (y = 0; y < h; y++)
+  if (!get_net_wm_icon_range (x11_display, xwindow,
+                              entry->offset, n_pixels,
+                              &pixels, &nitems, &bytes_after))
+    return NULL;
+
+  /* The property may have changed under us; a PropertyNotify will follow */
+  if (nitems < n_pixels)
     {
-      for (x = 0; x < w; x++)
-        {
-          uint32_t *p = &data[y * stride + x];
-          gulong *d = &argb_data[y * w + x];
-          *p = *d;
-        }
+      XFree (pixels);
+      return NULL;
     }
 
-  cairo_surface_mark_dirty (surface);
+  surface = get_shared_icon_surface (pixels, entry->width, entry->height);
+  XFree (pixels);
 
   return surface;
 }
@@ -197,63 +401,54 @@ read_rgb_icon (MetaX11Display   *x11_display,
                cairo_surface_t **icon,
                cairo_surface_t **mini_icon)
 {
-  Atom type;
-  int format;
-  gulong nitems;
+  gulong *prefix;
+  gulong prefix_items;
   gulong bytes_after;
-  int result, err;
-  guchar *data;
-  gulong *best;
-  int w, h;
-  gulong *best_mini;
-  int mini_w, mini_h;
-  gulong *data_as_long;
+  GArray *entries;
+  NetWmIconEntry *best;
+  NetWmIconEntry *best_mini;
+  gboolean ret = FALSE;
+
+  if (!get_net_wm_icon_range (x11_display, xwindow,
+                              0, NET_WM_ICON_PREFIX_ITEMS,
+                              &prefix, &prefix_items, &bytes_after))
+    return FALSE;
 
-  meta_x11_error_trap_push (x11_display);
-  type = None;
-  data = NULL;
-  result = XGetWindowProperty (x11_display->xdisplay,
-			       xwindow,
-                               x11_display->atom__NET_WM_ICON,
-			       0, G_MAXLONG,
-			       False, XA_CARDINAL, &type, &format, &nitems,
-			       &bytes_after, &data);
-  err = meta_x11_error_trap_pop_with_return (x11_display);
+  entries = g_array_new (FALSE, FALSE, sizeof (NetWmIconEntry));
 
-  if (err != Success ||
-      result != Success)
-    return FALSE;
+  if (!collect_icon_entries (x11_display, xwindow,
+                             prefix, prefix_items,
+                             prefix_items + bytes_after / 4,
+                             entries))
+    goto out;
 
-  if (type != XA_CARDINAL)
-    {
-      XFree (data);
-      return FALSE;
-    }
+  best = find_best_size (entries, ideal_width, ideal_height);
+  best_mini = find_best_size (entries, ideal_mini_width, ideal_mini_height);
 
-  data_as_long = (gulong *)data;
+  *icon = load_icon_entry (x11_display, xwindow, best,
+                           prefix, prefix_items);
+  if (!*icon)
+    goto out;
 
-  if (!find_best_size (data_as_long, nitems,
-                       ideal_width, ideal_height,
-                       &w, &h, &best))
-    {
-      XFree (data);
-      return FALSE;
-    }
+  if (best_mini == best)
+    *mini_icon = cairo_surface_reference (*icon);
+  else
+    *mini_icon = load_icon_entry (x11_display, xwindow, best_mini,
+                                  prefix, prefix_items);
 
-  if (!find_best_size (data_as_long, nitems,
-                       ideal_mini_width, ideal_mini_height,
-                       &mini_w, &mini_h, &best_mini))
+  if (!*mini_icon)
     {
-      XFree (data);
-      return FALSE;
+      g_clear_pointer (icon, cairo_surface_destroy);
+      goto out;
     }
 
-  *icon = argbdata_to_surface (best, w, h);
-  *mini_icon = argbdata_to_surface (best_mini, mini_w, mini_h);
+  ret = TRUE;
 
-  XFree (data);
+out:
+  g_array_free (entries, TRUE);
+  XFree (prefix);
 
-  return TRUE;
+  return ret;
 }
 
 static void
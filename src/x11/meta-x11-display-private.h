@@ -113,6 +113,9 @@ struct _MetaX11Display
   MetaWindowPropHooks *prop_hooks_table;
   GHashTable *prop_hooks;
   int n_prop_hooks;
+  GHashTable *initial_props_prefetch;
+  GArray *pending_prop_reloads;
+  guint pending_prop_reloads_id;
 
   /* Managed by group-props.c */
   MetaGroupPropHooks *group_prop_hooks;
@@ -70,8 +70,21 @@ typedef enum
   INCLUDE_OR = (1 << 1),
   INIT_ONLY  = (1 << 2),
   FORCE_INIT = (1 << 3),
+  THROTTLE   = (1 << 4),
 } MetaPropHookFlags;
 
+/* Minimum interval between two reloads of a THROTTLE property */
+#define THROTTLED_RELOAD_INTERVAL_MS 250
+
+typedef struct
+{
+  MetaWindow *window;
+  Window xwindow;
+  Atom property;
+  MetaPropValue value;
+  MetaPropRequest *request;
+} MetaPendingPropReload;
+
 struct _MetaWindowPropHooks
 {
   Atom property;
@@ -83,6 +96,9 @@ struct _MetaWindowPropHooks
 static void init_prop_value            (MetaWindow          *window,
                                         MetaWindowPropHooks *hooks,
                                         MetaPropValue       *value);
+static void init_prop_value_full       (MetaWindowPropHooks *hooks,
+                                        gboolean             override_redirect,
+                                        MetaPropValue       *value);
 static void reload_prop_value          (MetaWindow          *window,
                                         MetaWindowPropHooks *hooks,
                                         MetaPropValue       *value,
@@ -129,13 +145,249 @@ meta_window_reload_property (MetaWindow      *window,
                                             initial);
 }
 
+static gboolean
+is_reload_throttled (MetaWindow          *window,
+                     MetaWindowPropHooks *hooks,
+                     gint64               now_us,
+                     gint64              *delay_us)
+{
+  MetaWindowX11 *window_x11 = META_WINDOW_X11 (window);
+  MetaWindowX11Private *priv = meta_window_x11_get_instance_private (window_x11);
+  gint64 *last_reload_time;
+  gint64 elapsed_us;
+
+  if (!(hooks->flags & THROTTLE))
+    return FALSE;
+
+  if (!priv->throttled_reload_times)
+    return FALSE;
+
+  last_reload_time = g_hash_table_lookup (priv->throttled_reload_times,
+                                          GUINT_TO_POINTER (hooks->property));
+  if (!last_reload_time)
+    return FALSE;
+
+  elapsed_us = now_us - *last_reload_time;
+  if (elapsed_us >= THROTTLED_RELOAD_INTERVAL_MS * G_TIME_SPAN_MILLISECOND)
+    return FALSE;
+
+  *delay_us = THROTTLED_RELOAD_INTERVAL_MS * G_TIME_SPAN_MILLISECOND -
+              elapsed_us;
+  return TRUE;
+}
+
+static void
+note_throttled_reload (MetaWindow *window,
+                       Atom        property,
+                       gint64      now_us)
+{
+  MetaWindowX11 *window_x11 = META_WINDOW_X11 (window);
+  MetaWindowX11Private *priv = meta_window_x11_get_instance_private (window_x11);
+  gint64 *last_reload_time;
+
+  if (!priv->throttled_reload_times)
+    {
+      priv->throttled_reload_times =
+        g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    }
+
+  last_reload_time = g_hash_table_lookup (priv->throttled_reload_times,
+                                          GUINT_TO_POINTER (property));
+  if (!last_reload_time)
+    {
+      last_reload_time = g_new (gint64, 1);
+      g_hash_table_insert (priv->throttled_reload_times,
+                           GUINT_TO_POINTER (property), last_reload_time);
+    }
+
+  *last_reload_time = now_us;
+}
+
+static void
+pending_prop_reload_clear (MetaPendingPropReload *reload)
+{
+  if (reload->request)
+    meta_prop_cancel_get_values (reload->request);
+  g_object_unref (reload->window);
+}
+
+static gboolean
+flush_property_reloads_cb (gpointer user_data)
+{
+  MetaX11Display *x11_display = user_data;
+
+  x11_display->pending_prop_reloads_id = 0;
+  meta_x11_display_flush_property_reloads (x11_display);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_property_reloads (MetaX11Display *x11_display,
+                           gint64          delay_us)
+{
+  g_clear_handle_id (&x11_display->pending_prop_reloads_id, g_source_remove);
+
+  if (delay_us > 0)
+    {
+      x11_display->pending_prop_reloads_id =
+        g_timeout_add (MAX (1, delay_us / G_TIME_SPAN_MILLISECOND),
+                       flush_property_reloads_cb, x11_display);
+    }
+  else
+    {
+      x11_display->pending_prop_reloads_id =
+        g_idle_add_full (G_PRIORITY_DEFAULT,
+                         flush_property_reloads_cb, x11_display, NULL);
+    }
+  g_source_set_name_by_id (x11_display->pending_prop_reloads_id,
+                           "[mutter] flush_property_reloads_cb");
+}
+
 void
-meta_window_load_initial_properties (MetaWindow *window)
+meta_window_queue_property_reload (MetaWindow *window,
+                                   Window      xwindow,
+                                   Atom        property)
 {
-  int i, j;
-  MetaPropValue *values;
-  int n_properties = 0;
   MetaX11Display *x11_display = window->display->x11_display;
+  GArray *pending = x11_display->pending_prop_reloads;
+  MetaPendingPropReload reload = { 0, };
+  MetaWindowPropHooks *hooks;
+  guint i;
+
+  hooks = find_hooks (x11_display, property);
+  if (!hooks || (hooks->flags & INIT_ONLY))
+    return;
+
+  for (i = 0; i < pending->len; i++)
+    {
+      MetaPendingPropReload *queued =
+        &g_array_index (pending, MetaPendingPropReload, i);
+
+      if (queued->window == window &&
+          queued->xwindow == xwindow &&
+          queued->property == property)
+        return;
+    }
+
+  reload.window = g_object_ref (window);
+  reload.xwindow = xwindow;
+  reload.property = property;
+  g_array_append_val (pending, reload);
+
+  if (!x11_display->pending_prop_reloads_id)
+    schedule_property_reloads (x11_display, 0);
+}
+
+void
+meta_x11_display_flush_property_reloads (MetaX11Display *x11_display)
+{
+  GArray *reloads = x11_display->pending_prop_reloads;
+  gint64 now_us, min_delay_us = G_MAXINT64;
+  guint i;
+
+  if (reloads->len == 0)
+    return;
+
+  /* Reload handlers can queue new reloads, which then go to a fresh array
+   * and are picked up by the next flush.
+   */
+  x11_display->pending_prop_reloads =
+    g_array_new (FALSE, FALSE, sizeof (MetaPendingPropReload));
+  g_clear_handle_id (&x11_display->pending_prop_reloads_id, g_source_remove);
+
+  now_us = g_get_monotonic_time ();
+
+  meta_verbose ("Reloading %u queued properties\n", reloads->len);
+
+  /* Put all the requests on the wire before waiting for any reply */
+  for (i = 0; i < reloads->len; i++)
+    {
+      MetaPendingPropReload *reload =
+        &g_array_index (reloads, MetaPendingPropReload, i);
+      MetaWindowPropHooks *hooks;
+      gint64 delay_us;
+
+      if (reload->window->unmanaging)
+        continue;
+
+      hooks = find_hooks (x11_display, reload->property);
+
+      if (is_reload_throttled (reload->window, hooks, now_us, &delay_us))
+        {
+          min_delay_us = MIN (min_delay_us, delay_us);
+          continue;
+        }
+
+      init_prop_value (reload->window, hooks, &reload->value);
+      reload->request = meta_prop_begin_get_values (x11_display,
+                                                    reload->xwindow,
+                                                    &reload->value, 1);
+    }
+
+  for (i = 0; i < reloads->len; i++)
+    {
+      MetaPendingPropReload *reload =
+        &g_array_index (reloads, MetaPendingPropReload, i);
+
+      if (!reload->request)
+        {
+          if (!reload->window->unmanaging)
+            {
+              /* Throttled; keep it around for a later flush */
+              g_array_append_val (x11_display->pending_prop_reloads, *reload);
+              continue;
+            }
+        }
+      else
+        {
+          MetaWindowPropHooks *hooks;
+
+          meta_prop_finish_get_values (g_steal_pointer (&reload->request));
+
+          /* A previous reload handler may have unmanaged the window */
+          if (!reload->window->unmanaging)
+            {
+              hooks = find_hooks (x11_display, reload->property);
+
+              if (hooks->flags & THROTTLE)
+                note_throttled_reload (reload->window, reload->property, now_us);
+
+              reload_prop_value (reload->window, hooks, &reload->value, FALSE);
+            }
+
+          meta_prop_free_values (&reload->value, 1);
+        }
+
+      pending_prop_reload_clear (reload);
+    }
+
+  g_array_free (reloads, TRUE);
+
+  if (x11_display->pending_prop_reloads->len > 0 &&
+      !x11_display->pending_prop_reloads_id)
+    {
+      schedule_property_reloads (x11_display,
+                                 min_delay_us == G_MAXINT64 ? 0 : min_delay_us);
+    }
+}
+
+typedef struct
+{
+  Window xwindow;
+  gboolean override_redirect;
+  MetaPropValue *values;
+  int n_values;
+  MetaPropRequest *request;
+} MetaInitialPropsPrefetch;
+
+static MetaPropValue *
+init_initial_prop_values (MetaX11Display *x11_display,
+                          gboolean        override_redirect,
+                          int            *n_values)
+{
+  MetaPropValue *values;
+  int i, j;
 
   values = g_new0 (MetaPropValue, x11_display->n_prop_hooks);
 
@@ -145,14 +397,120 @@ meta_window_load_initial_properties (MetaWindow *window)
       MetaWindowPropHooks *hooks = &x11_display->prop_hooks_table[i];
       if (hooks->flags & LOAD_INIT)
         {
-          init_prop_value (window, hooks, &values[j]);
+          init_prop_value_full (hooks, override_redirect, &values[j]);
           ++j;
         }
     }
-  n_properties = j;
 
-  meta_prop_get_values (window->display->x11_display, window->xwindow,
-                        values, n_properties);
+  *n_values = j;
+  return values;
+}
+
+static void
+initial_props_prefetch_free (MetaInitialPropsPrefetch *prefetch)
+{
+  if (prefetch->request)
+    meta_prop_cancel_get_values (prefetch->request);
+
+  g_free (prefetch->values);
+  g_free (prefetch);
+}
+
+void
+meta_x11_display_prefetch_initial_properties (MetaX11Display *x11_display,
+                                              Window          xwindow,
+                                              gboolean        override_redirect)
+{
+  MetaInitialPropsPrefetch *prefetch;
+
+  if (!x11_display->initial_props_prefetch)
+    {
+      x11_display->initial_props_prefetch =
+        g_hash_table_new_full (meta_unsigned_long_hash,
+                               meta_unsigned_long_equal,
+                               NULL,
+                               (GDestroyNotify) initial_props_prefetch_free);
+    }
+
+  prefetch = g_new0 (MetaInitialPropsPrefetch, 1);
+  prefetch->xwindow = xwindow;
+  prefetch->override_redirect = override_redirect;
+  prefetch->values = init_initial_prop_values (x11_display,
+                                               override_redirect,
+                                               &prefetch->n_values);
+  prefetch->request = meta_prop_begin_get_values (x11_display, xwindow,
+                                                  prefetch->values,
+                                                  prefetch->n_values);
+
+  g_hash_table_replace (x11_display->initial_props_prefetch,
+                        &prefetch->xwindow, prefetch);
+}
+
+void
+meta_x11_display_discard_prefetched_properties (MetaX11Display *x11_display)
+{
+  g_clear_pointer (&x11_display->initial_props_prefetch,
+                   g_hash_table_destroy);
+}
+
+static MetaInitialPropsPrefetch *
+steal_initial_props_prefetch (MetaWindow *window)
+{
+  MetaX11Display *x11_display = window->display->x11_display;
+  MetaInitialPropsPrefetch *prefetch;
+
+  if (!x11_display->initial_props_prefetch)
+    return NULL;
+
+  prefetch = g_hash_table_lookup (x11_display->initial_props_prefetch,
+                                  &window->xwindow);
+  if (!prefetch)
+    return NULL;
+
+  g_hash_table_steal (x11_display->initial_props_prefetch,
+                      &window->xwindow);
+
+  /* The request list depends on whether the window is override redirect,
+   * which could in theory have changed since the prefetch was sent.
+   */
+  if (prefetch->override_redirect != window->override_redirect)
+    {
+      initial_props_prefetch_free (prefetch);
+      return NULL;
+    }
+
+  return prefetch;
+}
+
+void
+meta_window_load_initial_properties (MetaWindow *window)
+{
+  int i, j;
+  MetaInitialPropsPrefetch *prefetch;
+  MetaPropValue *values;
+  int n_properties = 0;
+  MetaX11Display *x11_display = window->display->x11_display;
+
+  prefetch = steal_initial_props_prefetch (window);
+  if (prefetch)
+    {
+      meta_verbose ("Using %d prefetched properties of 0x%lx\n",
+                    prefetch->n_values, window->xwindow);
+
+      values = g_steal_pointer (&prefetch->values);
+      n_properties = prefetch->n_values;
+      meta_prop_finish_get_values (g_steal_pointer (&prefetch->request));
+      initial_props_prefetch_free (prefetch);
+    }
+  else
+    {
+      values = init_initial_prop_values (x11_display,
+                                         window->override_redirect,
+                                         &n_properties);
+
+      meta_prop_get_values (window->display->x11_display, window->xwindow,
+                            values, n_properties);
+    }
 
   j = 0;
   for (i = 0; i < x11_display->n_prop_hooks; i++)
@@ -178,12 +536,12 @@ meta_window_load_initial_properties (MetaWindow *window)
 
 /* Fill in the MetaPropValue used to get the value of "property" */
 static void
-init_prop_value (MetaWindow          *window,
-                 MetaWindowPropHooks *hooks,
-                 MetaPropValue       *value)
+init_prop_value_full (MetaWindowPropHooks *hooks,
+                      gboolean             override_redirect,
+                      MetaPropValue       *value)
 {
   if (!hooks || hooks->type == META_PROP_VALUE_INVALID ||
-      (window->override_redirect && !(hooks->flags & INCLUDE_OR)))
+      (override_redirect && !(hooks->flags & INCLUDE_OR)))
     {
       value->type = META_PROP_VALUE_INVALID;
       value->atom = None;
@@ -195,6 +553,14 @@ init_prop_value (MetaWindow          *window,
     }
 }
 
+static void
+init_prop_value (MetaWindow          *window,
+                 MetaWindowPropHooks *hooks,
+                 MetaPropValue       *value)
+{
+  init_prop_value_full (hooks, window->override_redirect, value);
+}
+
 static void
 reload_prop_value (MetaWindow          *window,
                    MetaWindowPropHooks *hooks,
@@ -1873,8 +2239,8 @@ meta_x11_display_init_window_prop_hooks (MetaX11Display *x11_display)
     { x11_display->atom__GTK_MENUBAR_OBJECT_PATH,          META_PROP_VALUE_UTF8,         reload_gtk_menubar_object_path,          LOAD_INIT },
     { x11_display->atom__GTK_FRAME_EXTENTS,                META_PROP_VALUE_CARDINAL_LIST,reload_gtk_frame_extents,                LOAD_INIT },
     { x11_display->atom__NET_WM_USER_TIME_WINDOW, META_PROP_VALUE_WINDOW, reload_net_wm_user_time_window, LOAD_INIT },
-    { x11_display->atom__NET_WM_ICON,      META_PROP_VALUE_INVALID,  reload_net_wm_icon,  NONE },
-    { x11_display->atom__KWM_WIN_ICON,     META_PROP_VALUE_INVALID,  reload_kwm_win_icon, NONE },
+    { x11_display->atom__NET_WM_ICON,      META_PROP_VALUE_INVALID,  reload_net_wm_icon,  THROTTLE },
+    { x11_display->atom__KWM_WIN_ICON,     META_PROP_VALUE_INVALID,  reload_kwm_win_icon, THROTTLE },
     { x11_display->atom__NET_WM_ICON_GEOMETRY, META_PROP_VALUE_CARDINAL_LIST, reload_icon_geometry, LOAD_INIT },
     { x11_display->atom_WM_CLIENT_LEADER,  META_PROP_VALUE_INVALID, complain_about_broken_client, NONE },
     { x11_display->atom_SM_CLIENT_ID,      META_PROP_VALUE_INVALID, complain_about_broken_client, NONE },
@@ -1913,11 +2279,24 @@ meta_x11_display_init_window_prop_hooks (MetaX11Display *x11_display)
       cursor++;
     }
   x11_display->n_prop_hooks = cursor - table;
+
+  x11_display->pending_prop_reloads =
+    g_array_new (FALSE, FALSE, sizeof (MetaPendingPropReload));
 }
 
 void
 meta_x11_display_free_window_prop_hooks (MetaX11Display *x11_display)
 {
+  guint i;
+
+  g_clear_handle_id (&x11_display->pending_prop_reloads_id, g_source_remove);
+  for (i = 0; i < x11_display->pending_prop_reloads->len; i++)
+    {
+      pending_prop_reload_clear (&g_array_index (x11_display->pending_prop_reloads,
+                                                 MetaPendingPropReload, i));
+    }
+  g_clear_pointer (&x11_display->pending_prop_reloads, g_array_unref);
+
   g_hash_table_unref (x11_display->prop_hooks);
   x11_display->prop_hooks = NULL;
 
@@ -49,6 +49,30 @@ void meta_window_reload_property_from_xwindow (MetaWindow      *window,
                                                Atom             property,
                                                gboolean         initial);
 
+/**
+ * meta_window_queue_property_reload:
+ * @window:     The window the property belongs to.
+ * @xwindow:    The X handle the property is set on.
+ * @property:   A single X atom.
+ *
+ * Like meta_window_reload_property_from_xwindow(), but defers the reload
+ * until meta_x11_display_flush_property_reloads() runs, which happens
+ * from an idle or before handling an X request, focus or selection event.
+ * Repeated changes to the same property in between cost one reload.
+ */
+void meta_window_queue_property_reload (MetaWindow *window,
+                                        Window      xwindow,
+                                        Atom        property);
+
+/**
+ * meta_x11_display_flush_property_reloads:
+ * @x11_display:  The X11 display.
+ *
+ * Reloads all queued properties that are not being throttled, with the
+ * requests for all of them sent before waiting for any reply.
+ */
+void meta_x11_display_flush_property_reloads (MetaX11Display *x11_display);
+
 /**
  * meta_window_load_initial_properties:
  * @window:      The window.
@@ -59,6 +83,30 @@ void meta_window_reload_property_from_xwindow (MetaWindow      *window,
  */
 void meta_window_load_initial_properties (MetaWindow *window);
 
+/**
+ * meta_x11_display_prefetch_initial_properties:
+ * @x11_display:        The X11 display.
+ * @xwindow:            The X handle for a window about to be managed.
+ * @override_redirect:  Whether @xwindow is override redirect.
+ *
+ * Sends the requests meta_window_load_initial_properties() would make
+ * for @xwindow without waiting for the replies, so that adopting many
+ * windows at once does not cost a round trip per window. The replies
+ * are consumed when the window is managed.
+ */
+void meta_x11_display_prefetch_initial_properties (MetaX11Display *x11_display,
+                                                   Window          xwindow,
+                                                   gboolean        override_redirect);
+
+/**
+ * meta_x11_display_discard_prefetched_properties:
+ * @x11_display:  The X11 display.
+ *
+ * Drops the prefetched properties of windows that ended up not being
+ * managed.
+ */
+void meta_x11_display_discard_prefetched_properties (MetaX11Display *x11_display);
+
 /**
  * meta_x11_display_init_window_prop_hooks:
  * @x11_display:  The X11 display.
@@ -72,6 +72,10 @@ struct _MetaWindowX11Private
   MetaIconCache icon_cache;
   Pixmap wm_hints_pixmap;
   Pixmap wm_hints_mask;
+
+  /* Monotonic times of the last reloads of throttled properties, such as
+   * _NET_WM_ICON, keyed by atom */
+  GHashTable *throttled_reload_times;
 };
 
 G_END_DECLS
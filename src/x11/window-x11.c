@@ -663,6 +663,8 @@ meta_window_x11_unmanage (MetaWindow *window)
 
   meta_x11_error_trap_pop (x11_display);
 
+  g_clear_pointer (&priv->throttled_reload_times, g_hash_table_destroy);
+
   if (window->frame)
     {
       /* The XReparentWindow call in meta_window_destroy_frame() moves the
@@ -2716,7 +2718,7 @@ process_property_notify (MetaWindow     *window,
         xid = window->user_time_window;
     }
 
-  meta_window_reload_property_from_xwindow (window, xid, event->atom, FALSE);
+  meta_window_queue_property_reload (window, xid, event->atom);
 
   return TRUE;
 }
@@ -3453,87 +3455,87 @@ wm_state_to_string (int state)
 }
 #endif
 
-MetaWindow *
-meta_window_x11_new (MetaDisplay       *display,
-                     Window             xwindow,
-                     gboolean           must_be_viewable,
-                     MetaCompEffect     effect)
+/*
+ * Runs the checks deciding whether @xwindow gets managed and selects the
+ * events we need on it. @wm_state is the already fetched WM_STATE
+ * property, or %NULL to fetch it here if needed. Must be called inside
+ * an error trap; returns %FALSE if the window should not be managed.
+ *
+ * Whether the window still exists is only known once @select_cookie is
+ * checked with check_xwindow_prepared(), which lets callers preparing
+ * many windows wait for the server only once.
+ */
+static gboolean
+prepare_xwindow (MetaDisplay       *display,
+                 Window             xwindow,
+                 gboolean           must_be_viewable,
+                 XWindowAttributes *attrs,
+                 MetaPropValue     *wm_state,
+                 gulong            *existing_wm_state,
+                 xcb_void_cookie_t *select_cookie)
 {
   MetaX11Display *x11_display = display->x11_display;
-  XWindowAttributes attrs;
-  gulong existing_wm_state;
-  MetaWindow *window = NULL;
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  uint32_t value_mask;
+  uint32_t values[2];
+  int n_values = 0;
   gulong event_mask;
 
-  meta_verbose ("Attempting to manage 0x%lx\n", xwindow);
-
-  if (meta_x11_display_xwindow_is_a_no_focus_window (x11_display, xwindow))
-    {
-      meta_verbose ("Not managing no_focus_window 0x%lx\n",
-                    xwindow);
-      return NULL;
-    }
-
-  meta_x11_error_trap_push (x11_display); /* Push a trap over all of window
-                                       * creation, to reduce XSync() calls
-                                       */
-  /*
-   * This function executes without any server grabs held. This means that
-   * the window could have already gone away, or could go away at any point,
-   * so we must be careful with X error handling.
-   */
-
-  if (!XGetWindowAttributes (x11_display->xdisplay, xwindow, &attrs))
-    {
-      meta_verbose ("Failed to get attributes for window 0x%lx\n",
-                    xwindow);
-      goto error;
-    }
-
-  if (attrs.root != x11_display->xroot)
+  if (attrs->root != x11_display->xroot)
     {
       meta_verbose ("Not on our screen\n");
-      goto error;
+      return FALSE;
     }
 
-  if (attrs.class == InputOnly)
+  if (attrs->class == InputOnly)
     {
       meta_verbose ("Not managing InputOnly windows\n");
-      goto error;
+      return FALSE;
     }
 
-  if (is_our_xwindow (x11_display, xwindow, &attrs))
+  if (is_our_xwindow (x11_display, xwindow, attrs))
     {
       meta_verbose ("Not managing our own windows\n");
-      goto error;
+      return FALSE;
     }
 
-  if (maybe_filter_xwindow (display, xwindow, must_be_viewable, &attrs))
+  if (maybe_filter_xwindow (display, xwindow, must_be_viewable, attrs))
     {
       meta_verbose ("Not managing filtered window\n");
-      goto error;
+      return FALSE;
     }
 
-  existing_wm_state = WithdrawnState;
-  if (must_be_viewable && attrs.map_state != IsViewable)
+  *existing_wm_state = WithdrawnState;
+  if (must_be_viewable && attrs->map_state != IsViewable)
     {
       /* Only manage if WM_STATE is IconicState or NormalState */
       uint32_t state;
+      gboolean has_state;
 
       /* WM_STATE isn't a cardinal, it's type WM_STATE, but is an int */
-      if (!(meta_prop_get_cardinal_with_atom_type (x11_display, xwindow,
+      if (wm_state)
+        {
+          has_state = wm_state->type != META_PROP_VALUE_INVALID;
+          state = wm_state->v.cardinal;
+        }
+      else
+        {
+          has_state =
+            meta_prop_get_cardinal_with_atom_type (x11_display, xwindow,
                                                    x11_display->atom_WM_STATE,
                                                    x11_display->atom_WM_STATE,
-                                                   &state) &&
-            (state == IconicState || state == NormalState)))
+                                                   &state);
+        }
+
+      if (!(has_state && (state == IconicState || state == NormalState)))
         {
           meta_verbose ("Deciding not to manage unmapped or unviewable window 0x%lx\n", xwindow);
-          goto error;
+          return FALSE;
         }
 
-      existing_wm_state = state;
+      *existing_wm_state = state;
       meta_verbose ("WM_STATE of %lx = %s\n", xwindow,
-                    wm_state_to_string (existing_wm_state));
+                    wm_state_to_string (*existing_wm_state));
     }
 
   /*
@@ -3545,17 +3547,32 @@ meta_window_x11_new (MetaDisplay       *display,
    */
   XAddToSaveSet (x11_display->xdisplay, xwindow);
 
-  meta_x11_error_trap_push (x11_display);
-
   event_mask = PropertyChangeMask;
-  if (attrs.override_redirect)
+  if (attrs->override_redirect)
     event_mask |= StructureNotifyMask;
 
+  value_mask = XCB_CW_EVENT_MASK;
+
+  /* Get rid of weird gravities; the values are in the order of the
+   * value mask bits, and the gravity comes before the event mask
+   */
+  if (attrs->win_gravity != NorthWestGravity)
+    {
+      value_mask |= XCB_CW_WIN_GRAVITY;
+      values[n_values++] = XCB_GRAVITY_NORTH_WEST;
+    }
+
   /* If the window is from this client (a menu, say) we need to augment
    * the event mask, not replace it. For windows from other clients,
-   * attrs.your_event_mask will be empty at this point.
+   * attrs->your_event_mask will be empty at this point.
    */
-  XSelectInput (x11_display->xdisplay, xwindow, attrs.your_event_mask | event_mask);
+  values[n_values++] = attrs->your_event_mask | event_mask;
+
+  /* Errors of the checked request are handed back to
+   * check_xwindow_prepared() rather than to the Xlib error handler
+   */
+  *select_cookie = xcb_change_window_attributes_checked (xcb_conn, xwindow,
+                                                         value_mask, values);
 
   {
     unsigned char mask_bits[XIMaskLen (XI_LASTEVENT)] = { 0 };
@@ -3573,41 +3590,59 @@ meta_window_x11_new (MetaDisplay       *display,
     XShapeSelectInput (x11_display->xdisplay, xwindow, ShapeNotifyMask);
 
   /* Get rid of any borders */
-  if (attrs.border_width != 0)
+  if (attrs->border_width != 0)
     XSetWindowBorderWidth (x11_display->xdisplay, xwindow, 0);
 
-  /* Get rid of weird gravities */
-  if (attrs.win_gravity != NorthWestGravity)
-    {
-      XSetWindowAttributes set_attrs;
-
-      set_attrs.win_gravity = NorthWestGravity;
+  return TRUE;
+}
 
-      XChangeWindowAttributes (x11_display->xdisplay,
-                               xwindow,
-                               CWWinGravity,
-                               &set_attrs);
-    }
+/*
+ * Checks the event selection made by prepare_xwindow(); this waits for
+ * the server unless a later request was already answered.
+ */
+static gboolean
+check_xwindow_prepared (MetaX11Display    *x11_display,
+                        Window             xwindow,
+                        xcb_void_cookie_t  select_cookie)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  xcb_generic_error_t *error;
 
-  if (meta_x11_error_trap_pop_with_return (x11_display) != Success)
+  error = xcb_request_check (xcb_conn, select_cookie);
+  if (error)
     {
       meta_verbose ("Window 0x%lx disappeared just as we tried to manage it\n",
                     xwindow);
-      goto error;
+      free (error);
+      return FALSE;
     }
 
+  return TRUE;
+}
+
+static MetaWindow *
+create_window (MetaDisplay       *display,
+               Window             xwindow,
+               gulong             existing_wm_state,
+               MetaCompEffect     effect,
+               XWindowAttributes *attrs)
+{
+  MetaWindow *window;
+  MetaWindowX11 *window_x11;
+  MetaWindowX11Private *priv;
+
   window = _meta_window_shared_new (display,
                                     META_WINDOW_CLIENT_TYPE_X11,
                                     NULL,
                                     xwindow,
                                     existing_wm_state,
                                     effect,
-                                    &attrs);
+                                    attrs);
 
-  MetaWindowX11 *window_x11 = META_WINDOW_X11 (window);
-  MetaWindowX11Private *priv = meta_window_x11_get_instance_private (window_x11);
+  window_x11 = META_WINDOW_X11 (window);
+  priv = meta_window_x11_get_instance_private (window_x11);
 
-  priv->border_width = attrs.border_width;
+  priv->border_width = attrs->border_width;
 
   meta_window_grab_keys (window);
   if (window->type != META_WINDOW_DOCK && !window->override_redirect)
@@ -3616,14 +3651,303 @@ meta_window_x11_new (MetaDisplay       *display,
       meta_display_grab_focus_window_button (window->display, window);
     }
 
+  return window;
+}
+
+MetaWindow *
+meta_window_x11_new (MetaDisplay       *display,
+                     Window             xwindow,
+                     gboolean           must_be_viewable,
+                     MetaCompEffect     effect)
+{
+  MetaX11Display *x11_display = display->x11_display;
+  XWindowAttributes attrs;
+  gulong existing_wm_state;
+  xcb_void_cookie_t select_cookie;
+  MetaWindow *window = NULL;
+
+  meta_verbose ("Attempting to manage 0x%lx\n", xwindow);
+
+  if (meta_x11_display_xwindow_is_a_no_focus_window (x11_display, xwindow))
+    {
+      meta_verbose ("Not managing no_focus_window 0x%lx\n",
+                    xwindow);
+      return NULL;
+    }
+
+  meta_x11_error_trap_push (x11_display); /* Push a trap over all of window
+                                       * creation, to reduce XSync() calls
+                                       */
+  /*
+   * This function executes without any server grabs held. This means that
+   * the window could have already gone away, or could go away at any point,
+   * so we must be careful with X error handling.
+   */
+
+  if (!XGetWindowAttributes (x11_display->xdisplay, xwindow, &attrs))
+    {
+      meta_verbose ("Failed to get attributes for window 0x%lx\n",
+                    xwindow);
+      goto out;
+    }
+
+  if (!prepare_xwindow (display, xwindow, must_be_viewable, &attrs,
+                        NULL, &existing_wm_state, &select_cookie))
+    goto out;
+
+  if (!check_xwindow_prepared (x11_display, xwindow, select_cookie))
+    goto out;
+
+  window = create_window (display, xwindow, existing_wm_state, effect, &attrs);
+
+out:
   meta_x11_error_trap_pop (x11_display); /* pop the XSync()-reducing trap */
   return window;
+}
+
+typedef struct
+{
+  Window xwindow;
+  gboolean skip;
+  xcb_get_window_attributes_cookie_t attrs_cookie;
+  xcb_get_geometry_cookie_t geometry_cookie;
+  MetaPropValue wm_state;
+  MetaPropRequest *wm_state_request;
+  XWindowAttributes attrs;
+  gulong existing_wm_state;
+  xcb_void_cookie_t select_cookie;
+} MetaXWindowAdoption;
+
+static Visual *
+find_xvisual (Screen   *xscreen,
+              VisualID  visual_id)
+{
+  int i, j;
+
+  for (i = 0; i < xscreen->ndepths; i++)
+    {
+      Depth *depth = &xscreen->depths[i];
+
+      for (j = 0; j < depth->nvisuals; j++)
+        {
+          if (depth->visuals[j].visualid == visual_id)
+            return &depth->visuals[j];
+        }
+    }
 
-error:
-  meta_x11_error_trap_pop (x11_display);
   return NULL;
 }
 
+/* The xcb equivalent of XGetWindowAttributes(), which is a GetWindowAttributes
+ * and a GetGeometry request under the hood.
+ */
+static gboolean
+get_window_attributes_finish (MetaX11Display      *x11_display,
+                              MetaXWindowAdoption *adoption)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  xcb_get_window_attributes_reply_t *attrs_reply;
+  xcb_get_geometry_reply_t *geometry_reply;
+  xcb_generic_error_t *attrs_error = NULL;
+  xcb_generic_error_t *geometry_error = NULL;
+  XWindowAttributes *attrs = &adoption->attrs;
+  Screen *xscreen;
+
+  /* Errors are handed back here rather than to the Xlib error handler */
+  attrs_reply = xcb_get_window_attributes_reply (xcb_conn,
+                                                 adoption->attrs_cookie,
+                                                 &attrs_error);
+  geometry_reply = xcb_get_geometry_reply (xcb_conn,
+                                           adoption->geometry_cookie,
+                                           &geometry_error);
+
+  if (!attrs_reply || !geometry_reply)
+    {
+      free (attrs_reply);
+      free (geometry_reply);
+      free (attrs_error);
+      free (geometry_error);
+      return FALSE;
+    }
+
+  xscreen = ScreenOfDisplay (x11_display->xdisplay,
+                             meta_x11_display_get_screen_number (x11_display));
+
+  attrs->x = geometry_reply->x;
+  attrs->y = geometry_reply->y;
+  attrs->width = geometry_reply->width;
+  attrs->height = geometry_reply->height;
+  attrs->border_width = geometry_reply->border_width;
+  attrs->depth = geometry_reply->depth;
+  attrs->root = geometry_reply->root;
+  attrs->visual = find_xvisual (xscreen, attrs_reply->visual);
+  attrs->class = attrs_reply->_class;
+  attrs->bit_gravity = attrs_reply->bit_gravity;
+  attrs->win_gravity = attrs_reply->win_gravity;
+  attrs->backing_store = attrs_reply->backing_store;
+  attrs->backing_planes = attrs_reply->backing_planes;
+  attrs->backing_pixel = attrs_reply->backing_pixel;
+  attrs->save_under = attrs_reply->save_under;
+  attrs->colormap = attrs_reply->colormap;
+  attrs->map_installed = attrs_reply->map_is_installed;
+  attrs->map_state = attrs_reply->map_state;
+  attrs->all_event_masks = attrs_reply->all_event_masks;
+  attrs->your_event_mask = attrs_reply->your_event_mask;
+  attrs->do_not_propagate_mask = attrs_reply->do_not_propagate_mask;
+  attrs->override_redirect = attrs_reply->override_redirect;
+  attrs->screen = attrs->root == RootWindowOfScreen (xscreen) ? xscreen : NULL;
+
+  free (attrs_reply);
+  free (geometry_reply);
+
+  return TRUE;
+}
+
+/**
+ * meta_window_x11_adopt_xwindows:
+ * @display: a #MetaDisplay
+ * @xwindows: (array length=n_xwindows): the windows to manage
+ * @n_xwindows: number of elements in @xwindows
+ *
+ * Manages already existing, viewable windows, the same way calling
+ * meta_window_x11_new() on each of them would, but pipelines the X
+ * requests involved: the attributes, geometry and WM_STATE of every
+ * window are requested before waiting for any reply, and so are the
+ * initial properties of every window that will be managed.
+ */
+void
+meta_window_x11_adopt_xwindows (MetaDisplay  *display,
+                                const Window *xwindows,
+                                int           n_xwindows)
+{
+  MetaX11Display *x11_display = display->x11_display;
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  MetaXWindowAdoption *adoptions;
+  int i;
+
+  meta_verbose ("Adopting %d existing windows\n", n_xwindows);
+
+  adoptions = g_new0 (MetaXWindowAdoption, n_xwindows);
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      MetaXWindowAdoption *adoption = &adoptions[i];
+
+      adoption->xwindow = xwindows[i];
+
+      if (meta_x11_display_xwindow_is_a_no_focus_window (x11_display,
+                                                         adoption->xwindow))
+        {
+          meta_verbose ("Not managing no_focus_window 0x%lx\n",
+                        adoption->xwindow);
+          adoption->skip = TRUE;
+          continue;
+        }
+
+      adoption->attrs_cookie =
+        xcb_get_window_attributes (xcb_conn, adoption->xwindow);
+      adoption->geometry_cookie =
+        xcb_get_geometry (xcb_conn, adoption->xwindow);
+
+      adoption->wm_state.type = META_PROP_VALUE_CARDINAL;
+      adoption->wm_state.atom = x11_display->atom_WM_STATE;
+      adoption->wm_state.required_type = x11_display->atom_WM_STATE;
+      adoption->wm_state_request =
+        meta_prop_begin_get_values (x11_display, adoption->xwindow,
+                                    &adoption->wm_state, 1);
+    }
+
+  meta_topic (META_DEBUG_SYNC,
+              "Collecting attributes of %d windows in %s\n",
+              n_xwindows, G_STRFUNC);
+
+  /* The event selection in prepare_xwindow() is in effect on the server
+   * before the initial properties are requested, so no PropertyNotify
+   * can fall between reading a property and listening for its changes.
+   */
+  meta_x11_error_trap_push (x11_display);
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      MetaXWindowAdoption *adoption = &adoptions[i];
+      gboolean has_attrs;
+
+      if (adoption->skip)
+        continue;
+
+      meta_verbose ("Attempting to manage 0x%lx\n", adoption->xwindow);
+
+      has_attrs = get_window_attributes_finish (x11_display, adoption);
+      meta_prop_finish_get_values (adoption->wm_state_request);
+      adoption->wm_state_request = NULL;
+
+      if (!has_attrs)
+        {
+          meta_verbose ("Failed to get attributes for window 0x%lx\n",
+                        adoption->xwindow);
+          adoption->skip = TRUE;
+          continue;
+        }
+
+      if (prepare_xwindow (display, adoption->xwindow, TRUE,
+                           &adoption->attrs, &adoption->wm_state,
+                           &adoption->existing_wm_state,
+                           &adoption->select_cookie))
+        {
+          meta_x11_display_prefetch_initial_properties (x11_display,
+                                                        adoption->xwindow,
+                                                        adoption->attrs.override_redirect);
+        }
+      else
+        {
+          adoption->skip = TRUE;
+        }
+    }
+
+  meta_x11_error_trap_pop (x11_display);
+
+  /* A single round trip answers the event selection of every window;
+   * the checks below then don't need to wait for the server anymore
+   */
+  meta_topic (META_DEBUG_SYNC,
+              "Checking the event selection of %d windows in %s\n",
+              n_xwindows, G_STRFUNC);
+  free (xcb_get_input_focus_reply (xcb_conn,
+                                   xcb_get_input_focus (xcb_conn),
+                                   NULL));
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      MetaXWindowAdoption *adoption = &adoptions[i];
+
+      if (adoption->skip)
+        continue;
+
+      if (!check_xwindow_prepared (x11_display, adoption->xwindow,
+                                   adoption->select_cookie))
+        adoption->skip = TRUE;
+    }
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      MetaXWindowAdoption *adoption = &adoptions[i];
+
+      if (adoption->skip)
+        continue;
+
+      meta_x11_error_trap_push (x11_display);
+      create_window (display, adoption->xwindow,
+                     adoption->existing_wm_state,
+                     META_COMP_EFFECT_NONE,
+                     &adoption->attrs);
+      meta_x11_error_trap_pop (x11_display);
+    }
+
+  meta_x11_display_discard_prefetched_properties (x11_display);
+
+  g_free (adoptions);
+}
+
 void
 meta_window_x11_recalc_window_type (MetaWindow *window)
 {
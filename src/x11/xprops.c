@@ -827,23 +827,52 @@ latin1_to_utf8 (const char *text)
   return g_string_free (str, FALSE);
 }
 
-void
-meta_prop_get_values (MetaX11Display *x11_display,
-                      Window          xwindow,
-                      MetaPropValue  *values,
-                      int             n_values)
+struct _MetaPropRequest
 {
-  int i;
+  MetaX11Display *x11_display;
+  Window xwindow;
+  MetaPropValue *values;
+  int n_values;
+  xcb_get_property_cookie_t *tasks;
+};
+
+/**
+ * meta_prop_begin_get_values:
+ * @x11_display: a #MetaX11Display
+ * @xwindow: the window to read properties of
+ * @values: (array length=n_values): values with type and atom initialized
+ * @n_values: number of elements in @values
+ *
+ * Sends the GetProperty requests for @values without waiting for any
+ * reply, so that requests for several windows can be put on the wire
+ * before blocking. @values must stay alive until the returned request
+ * is passed to meta_prop_finish_get_values() or
+ * meta_prop_cancel_get_values().
+ *
+ * Returns: the pending request
+ */
+MetaPropRequest *
+meta_prop_begin_get_values (MetaX11Display *x11_display,
+                            Window          xwindow,
+                            MetaPropValue  *values,
+                            int             n_values)
+{
+  MetaPropRequest *request;
   xcb_get_property_cookie_t *tasks;
   xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  int i;
 
-  meta_verbose ("Requesting %d properties of 0x%lx at once\n",
-                n_values, xwindow);
+  request = g_new0 (MetaPropRequest, 1);
+  request->x11_display = x11_display;
+  request->xwindow = xwindow;
+  request->values = values;
+  request->n_values = n_values;
 
   if (n_values == 0)
-    return;
+    return request;
 
   tasks = g_new0 (xcb_get_property_cookie_t, n_values);
+  request->tasks = tasks;
 
   /* Start up tasks. The "values" array can have values
    * with atom == None, which means to ignore that element.
@@ -907,10 +936,26 @@ meta_prop_get_values (MetaX11Display *x11_display,
       ++i;
     }
 
-  /* Get replies for all our tasks */
-  meta_topic (META_DEBUG_SYNC, "Syncing to get %d GetProperty replies in %s\n",
-              n_values, G_STRFUNC);
-  XSync (x11_display->xdisplay, False);
+  return request;
+}
+
+/**
+ * meta_prop_finish_get_values:
+ * @request: (transfer full): a request from meta_prop_begin_get_values()
+ *
+ * Collects the replies of @request into the values it was started with,
+ * blocking until they arrive, and frees @request.
+ */
+void
+meta_prop_finish_get_values (MetaPropRequest *request)
+{
+  MetaX11Display *x11_display = request->x11_display;
+  Window xwindow = request->xwindow;
+  MetaPropValue *values = request->values;
+  int n_values = request->n_values;
+  xcb_get_property_cookie_t *tasks = request->tasks;
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  int i;
 
   /* Collect results, should arrive in order requested */
   i = 0;
@@ -1041,6 +1086,56 @@ meta_prop_get_values (MetaX11Display *x11_display,
     }
 
   g_free (tasks);
+  g_free (request);
+}
+
+/**
+ * meta_prop_cancel_get_values:
+ * @request: (transfer full): a request from meta_prop_begin_get_values()
+ *
+ * Discards the replies of @request without reading them and frees it.
+ * The values it was started with are left untouched.
+ */
+void
+meta_prop_cancel_get_values (MetaPropRequest *request)
+{
+  xcb_connection_t *xcb_conn =
+    XGetXCBConnection (request->x11_display->xdisplay);
+  int i;
+
+  for (i = 0; i < request->n_values; i++)
+    {
+      if (request->tasks[i].sequence != 0)
+        xcb_discard_reply (xcb_conn, request->tasks[i].sequence);
+    }
+
+  g_free (request->tasks);
+  g_free (request);
+}
+
+void
+meta_prop_get_values (MetaX11Display *x11_display,
+                      Window          xwindow,
+                      MetaPropValue  *values,
+                      int             n_values)
+{
+  MetaPropRequest *request;
+
+  meta_verbose ("Requesting %d properties of 0x%lx at once\n",
+                n_values, xwindow);
+
+  if (n_values == 0)
+    return;
+
+  request = meta_prop_begin_get_values (x11_display, xwindow,
+                                        values, n_values);
+
+  /* Get replies for all our tasks */
+  meta_topic (META_DEBUG_SYNC, "Syncing to get %d GetProperty replies in %s\n",
+              n_values, G_STRFUNC);
+  XSync (x11_display->xdisplay, False);
+
+  meta_prop_finish_get_values (request);
 }
 
 static void
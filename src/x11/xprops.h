@@ -186,6 +186,17 @@ void meta_prop_get_values (MetaX11Display *x11_display,
                            MetaPropValue  *values,
                            int             n_values);
 
+typedef struct _MetaPropRequest MetaPropRequest;
+
+MetaPropRequest * meta_prop_begin_get_values (MetaX11Display *x11_display,
+                                              Window          xwindow,
+                                              MetaPropValue  *values,
+                                              int             n_values);
+
+void meta_prop_finish_get_values (MetaPropRequest *request);
+
+void meta_prop_cancel_get_values (MetaPropRequest *request);
+
 void meta_prop_free_values (MetaPropValue *values,
                             int            n_values);
 